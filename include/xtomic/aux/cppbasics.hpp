@@ -127,6 +127,15 @@
 
 /// @brief Shortcut to declare alignment for 16-bytes CAS operation (8-byte CAS on 32 bit platform)
 #define align_4_cas16 align_by(sizeof(void*)*2)
+
+/// @brief Size of CPU cache line in bytes.
+#define XTOMIC_CACHE_LINE_SIZE 64
+
+/// @brief Shortcut to declare padding of a whole cache line, e.g. to separate data modified by different threads.
+///
+/// Data separated by the padding never share a cache line whatever the alignment of the object is,
+/// so the separation holds for objects allocated by `new` or by an allocator.
+#define pad_4_cache_line(name) char name[XTOMIC_CACHE_LINE_SIZE]
 /// @}
 
 #endif /* INCLUDE_CPPBASICS_HPP_ */
@@ -0,0 +1,352 @@
+/*
+ * blocking_queue.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: masha
+ */
+
+/// \file blocking_queue.hpp
+///
+/// @brief Queue adapter that allows consumers (producers) to wait for data (free space).
+///
+
+#ifndef INCLUDE_BLOCKING_QUEUE_HPP_
+#define INCLUDE_BLOCKING_QUEUE_HPP_
+
+/// \cond HIDDEN_SYMBOLS
+
+#include "queue.hpp"
+#include "quantum.hpp"
+#include "impl/eventcount.hpp"
+#include "aux/cppbasics.hpp"
+
+#include <ctime>
+
+/// \endcond
+
+namespace xtomic
+{
+
+///
+/// \class blocking_queue
+///
+/// \brief The adapter extends any [queue](@ref queue) with methods that wait until the operation
+/// is possible.
+///
+/// A waiting thread spins for a while and then parks itself on an event count (futex). The
+/// spin limit adapts: it grows while spinning succeeds and shrinks when threads have to park.
+///
+/// Non waiting methods stay lock-free: push(), pop() and the bulk versions call the underlying
+/// queue and then check if anybody is parked. There is no syscall unless some thread actually
+/// sleeps. So the adapter costs a full barrier and a read of a shared counter per operation.
+///
+/// push_wait() is useful for fixed sized queues only, dynamic sized queues never refuse new
+/// items.
+///
+/// @param Queue type of the underlying queue, e.g. `make_fixed_size_queue<int>::type`.
+///
+template<typename Queue>
+class blocking_queue
+{
+public:
+    typedef Queue queue_type;                                       ///< type of the underlying queue.
+    typedef typename queue_type::value_type value_type;             ///< value type.
+    typedef typename queue_type::size_type size_type;               ///< size type.
+
+public:
+    static const bool fixed_size = queue_type::fixed_size;          ///< true if the queue has fixed size.
+    static const bool many_producers = queue_type::many_producers;  ///< true if many producers may shirt data simultaneously.
+    static const bool many_consumers = queue_type::many_consumers;  ///< true if many consumers may eat data simultaneously.
+    static const bool wait_free = queue_type::wait_free;            ///< true if wait-free implementation is used.
+
+private:
+    typedef blocking_queue<Queue> this_class;
+
+    /// \cond HIDDEN_SYMBOLS
+    enum
+    {
+        MIN_SPIN = 16,
+        MAX_SPIN = 16 * 1024,
+    };
+    /// \endcond
+
+private:
+    blocking_queue(const this_class&);
+    this_class& operator=(const this_class&);
+
+public:
+    ///
+    /// \brief Constructor.
+    ///
+    /// @param capacity specifies (initial) capacity of the queue.
+    ///
+    blocking_queue(size_type capacity) :
+            m_queue(capacity),
+            m_spinLimit(MIN_SPIN * 16)
+    {
+    }
+
+    ///
+    /// \brief The method inserts new item into the queue and wakes a waiting consumer if any.
+    ///
+    /// See [queue::push()](@ref queue::push).
+    ///
+#if XTOMIC_USE_CPP11
+    template<typename ... Args>
+    bool push(Args&&... data)
+#else
+    bool push(const value_type& data)
+#endif
+    {
+        if (!m_queue.push(std_forward(Args, data)))
+        {
+            return false;
+        }
+        m_notEmpty.notify_one();
+        return true;
+    }
+
+    ///
+    /// \brief The method extracts an item from the queue and wakes a waiting producer if any.
+    ///
+    /// See [queue::pop()](@ref queue::pop).
+    ///
+    bool pop(value_type& val)
+    {
+        if (!m_queue.pop(val))
+        {
+            return false;
+        }
+        notifyNotFull();
+        return true;
+    }
+
+    ///
+    /// \brief The method inserts a range of items and wakes all waiting consumers.
+    ///
+    /// See [queue::push_bulk()](@ref queue::push_bulk).
+    ///
+    template<typename ForwardIterator>
+    size_type push_bulk(ForwardIterator first, ForwardIterator last)
+    {
+        const size_type count = m_queue.push_bulk(first, last);
+        if (count)
+        {
+            m_notEmpty.notify_all();
+        }
+        return count;
+    }
+
+    ///
+    /// \brief The method extracts up to `max` items and wakes all waiting producers.
+    ///
+    /// See [queue::pop_bulk()](@ref queue::pop_bulk).
+    ///
+    template<typename OutputIterator>
+    size_type pop_bulk(OutputIterator out, size_type max)
+    {
+        const size_type count = m_queue.pop_bulk(out, max);
+        if (count && fixed_size)
+        {
+            m_notFull.notify_all();
+        }
+        return count;
+    }
+
+    ///
+    /// \brief The method extracts an item, waits for it if the queue is empty.
+    ///
+    /// @param val specifies reference to a variable to hold extracted value.
+    ///
+    void pop_wait(value_type& val)
+    {
+        popWait(val, nullptr);
+    }
+
+    ///
+    /// \brief The method extracts an item, waits for it no longer than specified timeout.
+    ///
+    /// @param val specifies reference to a variable to hold extracted value.
+    /// @param timeout specifies timeout in milliseconds.
+    /// @return
+    /// - `false` if the timeout expired and nothing was extracted.
+    /// - `true` if value was successfully extracted.
+    ///
+    bool pop_wait(value_type& val, unsigned long timeout)
+    {
+        timespec deadline = makeDeadline(timeout);
+        return popWait(val, &deadline);
+    }
+
+    ///
+    /// \brief The method inserts new item, waits for free space if the queue is full.
+    ///
+    /// @param data specifies a value of a new item.
+    ///
+    void push_wait(const value_type& data)
+    {
+        pushWait(data, nullptr);
+    }
+
+    ///
+    /// \brief The method inserts new item, waits for free space no longer than specified timeout.
+    ///
+    /// @param data specifies a value of a new item.
+    /// @param timeout specifies timeout in milliseconds.
+    /// @return
+    /// - `false` if the timeout expired and nothing was inserted.
+    /// - `true` if the item was successfully inserted.
+    ///
+    bool push_wait(const value_type& data, unsigned long timeout)
+    {
+        timespec deadline = makeDeadline(timeout);
+        return pushWait(data, &deadline);
+    }
+
+    ///
+    /// \brief The method returns capacity of the queue. See [queue::getCapacity()](@ref queue::getCapacity).
+    ///
+    size_type getCapacity() const
+    {
+        return m_queue.getCapacity();
+    }
+
+    ///
+    /// \brief The method returns number of items in the queue. See [queue::size()](@ref queue::size).
+    ///
+    size_type size() const
+    {
+        return m_queue.size();
+    }
+
+private:
+    bool popWait(value_type& val, const timespec* deadline)
+    {
+        const size_type limit = m_spinLimit.load(barriers::relaxed);
+        for (size_type i = 0; i < limit; ++i)
+        {
+            if (pop(val))
+            {
+                adjustSpin(limit, true);
+                return true;
+            }
+            cpu_relax();
+        }
+        adjustSpin(limit, false);
+
+        for (;;)
+        {
+            eventcount::key_type key = m_notEmpty.prepare_wait();
+            if (pop(val))
+            {
+                m_notEmpty.cancel_wait();
+                return true;
+            }
+            timespec timeout;
+            if (!remaining(deadline, timeout)
+                    || !m_notEmpty.wait(key, deadline ? &timeout : nullptr))
+            {
+                // last chance
+                return pop(val);
+            }
+        }
+    }
+    bool pushWait(const value_type& data, const timespec* deadline)
+    {
+        const size_type limit = m_spinLimit.load(barriers::relaxed);
+        for (size_type i = 0; i < limit; ++i)
+        {
+            if (push(data))
+            {
+                adjustSpin(limit, true);
+                return true;
+            }
+            cpu_relax();
+        }
+        adjustSpin(limit, false);
+
+        for (;;)
+        {
+            eventcount::key_type key = m_notFull.prepare_wait();
+            if (push(data))
+            {
+                m_notFull.cancel_wait();
+                return true;
+            }
+            timespec timeout;
+            if (!remaining(deadline, timeout)
+                    || !m_notFull.wait(key, deadline ? &timeout : nullptr))
+            {
+                // last chance
+                return push(data);
+            }
+        }
+    }
+    void notifyNotFull()
+    {
+        // dynamic sized queues never refuse new items, nobody waits for free space
+        if (fixed_size)
+        {
+            m_notFull.notify_one();
+        }
+    }
+    // the limit doubles when spinning pays off and halves when it does not
+    void adjustSpin(const size_type limit, const bool success)
+    {
+        if (success)
+        {
+            if (limit < MAX_SPIN)
+            {
+                m_spinLimit.store(limit * 2, barriers::relaxed);
+            }
+        }
+        else if (limit > MIN_SPIN)
+        {
+            m_spinLimit.store(limit / 2, barriers::relaxed);
+        }
+    }
+    static timespec now()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts;
+    }
+    static timespec makeDeadline(unsigned long timeout)
+    {
+        timespec ts = now();
+        ts.tv_sec += timeout / 1000;
+        ts.tv_nsec += (timeout % 1000) * 1000000;
+        if (ts.tv_nsec >= 1000000000)
+        {
+            ts.tv_nsec -= 1000000000;
+            ++ts.tv_sec;
+        }
+        return ts;
+    }
+    // calculates time left to the deadline, returns false if the deadline has passed
+    static bool remaining(const timespec* deadline, timespec& timeout)
+    {
+        if (!deadline)
+        {
+            return true;
+        }
+        const timespec ts = now();
+        timeout.tv_sec = deadline->tv_sec - ts.tv_sec;
+        timeout.tv_nsec = deadline->tv_nsec - ts.tv_nsec;
+        if (timeout.tv_nsec < 0)
+        {
+            timeout.tv_nsec += 1000000000;
+            --timeout.tv_sec;
+        }
+        return timeout.tv_sec >= 0;
+    }
+private:
+    queue_type m_queue;
+    xtomic::quantum<size_type> m_spinLimit;
+    eventcount m_notEmpty;
+    eventcount m_notFull;
+};
+
+}
+
+#endif /* INCLUDE_BLOCKING_QUEUE_HPP_ */
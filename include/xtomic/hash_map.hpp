@@ -17,6 +17,7 @@
 /// \cond HIDDEN_SYMBOLS
 
 #include "impl/memory_model.hpp"
+#include "impl/indexing.hpp"
 #include "impl/hash_map_table.hpp"
 #include "impl/hash_map_table_integral_pair.hpp"
 #include "impl/hash_map_table_integral_value.hpp"
@@ -27,6 +28,7 @@
 #include "aux/cppbasics.hpp"
 
 #include <functional>
+#include <iterator>
 
 /// \endcond
 
@@ -71,36 +73,41 @@ struct is_integral_pair
 template<typename Key, typename Value,
         typename Hash = typename make_hash<Key>::type,
         typename Pred = std::equal_to<Key>, typename Allocator = std::allocator<
-                Value>, bool IntegralKey = is_integral<Key>::value,
+                Value>, indexing::type Indexing = default_indexing::value,
+        bool IntegralKey = is_integral<Key>::value,
         bool IntegralValue = is_integral<Value>::value, bool IntegralKeyValue =
                 is_integral_pair<Key, Value>::value>
 struct hash_table_traits
 {
-    typedef xtomic::hash_map_table<Key, Value, Hash, Pred, Allocator> type;
+    typedef xtomic::hash_map_table<Key, Value, Hash, Pred, Allocator, Indexing> type;
 };
 
 template<typename Key, typename Value, typename Hash, typename Pred,
-        typename Allocator, bool IntegralKey, bool IntegralValue>
-struct hash_table_traits<Key, Value, Hash, Pred, Allocator, IntegralKey,
-        IntegralValue, true>
+        typename Allocator, indexing::type Indexing, bool IntegralKey,
+        bool IntegralValue>
+struct hash_table_traits<Key, Value, Hash, Pred, Allocator, Indexing,
+        IntegralKey, IntegralValue, true>
 {
-    typedef xtomic::hash_map_table_integral_pair<Key, Value, Hash, Pred, Allocator> type;
+    typedef xtomic::hash_map_table_integral_pair<Key, Value, Hash, Pred,
+            Allocator, Indexing> type;
 };
 
 template<typename Key, typename Value, typename Hash, typename Pred,
-        typename Allocator, bool IntegralKey>
-struct hash_table_traits<Key, Value, Hash, Pred, Allocator, IntegralKey, true,
-        false>
+        typename Allocator, indexing::type Indexing, bool IntegralKey>
+struct hash_table_traits<Key, Value, Hash, Pred, Allocator, Indexing,
+        IntegralKey, true, false>
 {
     typedef xtomic::hash_map_table_integral_value<Key, Value, Hash, Pred,
-            Allocator> type;
+            Allocator, Indexing> type;
 };
 
 template<typename Key, typename Value, typename Hash, typename Pred,
-        typename Allocator>
-struct hash_table_traits<Key, Value, Hash, Pred, Allocator, true, false, false>
+        typename Allocator, indexing::type Indexing>
+struct hash_table_traits<Key, Value, Hash, Pred, Allocator, Indexing, true,
+        false, false>
 {
-    typedef xtomic::hash_map_table_integral_key<Key, Value, Hash, Pred, Allocator> type;
+    typedef xtomic::hash_map_table_integral_key<Key, Value, Hash, Pred,
+            Allocator, Indexing> type;
 };
 
 }
@@ -138,6 +145,8 @@ struct hash_table_traits<Key, Value, Hash, Pred, Allocator, true, false, false>
 /// @param Pred type of equal function, std::equal_to<Key> is used by default.
 /// @param Allocator type of allocator, by default std::allocator<Value>.
 /// @param MemModel memory model, by default memory_model::wise is used.
+/// @param Rehashing the way the container grows, by default rehashing::stop_the_world is used.
+/// @param Indexing the way a hash is mapped to a slot, by default indexing::modulo is used.
 ///
 /// Memory model allows to find balance between performance and memory consumption:
 ///
@@ -147,18 +156,56 @@ struct hash_table_traits<Key, Value, Hash, Pred, Allocator, true, false, false>
 /// There are useful helpers for using different memory models:
 /// * [make_wise_hash_map](@ref make_wise_hash_map)
 /// * [make_greedy_hash_map](@ref make_greedy_hash_map)
+///
+/// Rehashing specifies how items move to a bigger table:
+///
+/// * `rehashing::stop_the_world` - one thread moves all items while other writers wait.
+///   The best throughput, but an insert may take as long as the whole table takes to move.
+/// * `rehashing::incremental` - the bigger table is used at once and each writer moves
+///   a couple of small chunks of items on the way. Lookups consult both tables until
+///   all items are moved. Use it when latency of single operation matters.
+///
+/// Indexing specifies how a hash selects the first slot to probe:
+///
+/// * `indexing::modulo` - the slot is `hash % capacity`, capacity is not rounded.
+/// * `indexing::power_of_two` - capacity is rounded up to a power of two and the slot is
+///   taken from low bits of the mixed hash, so there is no division on the hot path.
+///   The hash is mixed so weak hash functions (e.g. identity for integers) do not cluster.
+///   Use it for find-heavy workloads with cheap hash functions.
+/// * `indexing::control_bytes` - power of two indexing plus a byte with 7 bits of the hash
+///   per slot. The bytes are kept apart from the items and a probe compares 16 of them
+///   at once (SSE2 if available), so the items whose hash differs are not read at all.
+///   Lookups of missing keys become much cheaper, lookups of present keys cost about the
+///   same. Integral keys are compared in place and do not use the bytes.
+///
+/// The container shrinks when erase operation leaves it mostly empty (see
+/// [setLowWatermark](@ref setLowWatermark)) or when [shrink_to_fit](@ref shrink_to_fit)
+/// is called. With greedy memory model a released table is retired and freed by a later
+/// write once no reader that could have seen it is still reading, readers never wait
+/// for it.
+///
+/// Besides the table each container keeps per processor slots, so that threads do not
+/// write to the same cache lines: the domains of readers and writers take 80 bytes per
+/// processor each (64 processors at most) and the counter of inserts in progress takes
+/// 72 bytes per processor (16 at most). So an empty container costs about 230 bytes per
+/// processor on top of the object itself, e.g. 3.7 KB on a 16 processor machine. A table
+/// of about 1500 slots or more counts its items in per processor slots as well, 144 bytes
+/// per processor (16 at most). The slots are allocated by `std::allocator`.
 template<typename Key, typename Value,
         typename Hash = typename make_hash<Key>::type,
         typename Pred = std::equal_to<Key>, typename Allocator = std::allocator<
                 Value>, memory_model::type MemModel =
-                default_memory_model::value>
+                default_memory_model::value, rehashing::type Rehashing =
+                default_rehashing::value, indexing::type Indexing =
+                default_indexing::value>
 class hash_map
 {
 public:
 
     /// \cond HIDDEN_SYMBOLS
-    typedef hash_map<Key, Value, Hash, Pred, Allocator, MemModel> this_type;
-    typedef hash_table_traits<Key, Value, Hash, Pred, Allocator> hash_table_traits_type;
+    typedef hash_map<Key, Value, Hash, Pred, Allocator, MemModel, Rehashing,
+            Indexing> this_type;
+    typedef hash_table_traits<Key, Value, Hash, Pred, Allocator, Indexing> hash_table_traits_type;
     /// \endcond
 
     typedef typename hash_table_traits_type::type hash_table_type;               ///< hash table type.
@@ -175,6 +222,8 @@ public:
     static constexpr bool INTEGRAL_VALUE = hash_table_type::INTEGRAL_VALUE;      ///< true if mapped type is treated as integral type.
     static constexpr bool INTEGRAL_KEYVALUE = hash_table_type::INTEGRAL_KEYVALUE;///< true if the whole pair key:mapped-value is treated as integral type.
     static constexpr memory_model::type MEMORY_MODEL = MemModel;                 ///< used memory model: greedy or wise.
+    static constexpr rehashing::type REHASHING = Rehashing;                      ///< used rehashing: stop the world or incremental.
+    static constexpr indexing::type INDEXING = Indexing;                         ///< used indexing: modulo, power of two or control bytes.
 private:
     hash_map(const this_type&); // = delete;
     this_type& operator=(const this_type&); // = delete;
@@ -196,6 +245,30 @@ public:
 
     }
 
+    ///
+    /// \brief Bulk load constructor.
+    ///
+    /// The container is sized for the items at once and they are inserted as by
+    /// [insert_range](@ref insert_range). Nobody else uses the container yet, so
+    /// the work may be split between several threads.
+    ///
+    /// @param first specifies the first key:mapped-value pair.
+    /// @param last specifies the end of the pairs.
+    /// @param threads specifies the number of threads to insert the items,
+    ///        the calling thread is one of them. Default value is 1.
+    ///
+    /// *Note:* if the range has several pairs with the same key, the first of them is inserted.
+    ///
+    template<typename ForwardIterator>
+    hash_map(ForwardIterator first,
+             ForwardIterator last,
+             const unsigned int threads = 1) :
+            m_hash_table(),
+            m_hash_table_base(m_hash_table, std::distance(first, last))
+    {
+        m_hash_table_base.insertRange(first, last, threads);
+    }
+
     ///
     /// \brief The method generates snapshot of the map as vector of pairs key_type - mapped_type.
     ///
@@ -237,6 +310,31 @@ public:
         m_hash_table_base.find(key, value);
         return value;
     }
+
+    ///
+    /// @brief The operation finds values associated with the specified keys.
+    ///
+    /// The keys are looked up with prefetching of their slots several keys ahead,
+    /// so a batch of lookups over a table that does not fit into cache takes less
+    /// time than the same number of calls of [find](@ref find).
+    ///
+    /// @param keys specifies the keys to find.
+    /// @param count specifies the number of keys.
+    /// @param values receives `values[i]` associated with `keys[i]` if it was found,
+    ///        otherwise `values[i]` is not changed.
+    /// @param foundMask receives bit `i % 64` of `foundMask[i / 64]` set if `keys[i]`
+    ///        was found, it must hold `(count + 63) / 64` words.
+    ///
+    /// @return
+    /// - number of the keys found.
+    ///
+    size_type find_batch(const key_type* keys,
+                         const size_type count,
+                         mapped_type* values,
+                         uint64_t* foundMask) const
+    {
+        return m_hash_table_base.findBatch(keys, count, values, foundMask);
+    }
     /// @}
 
     /// @name Insert
@@ -279,6 +377,87 @@ public:
         m_hash_table_base.insert(key, true, std_forward(Args, val));
     }
 
+    ///
+    /// The method inserts a new key-value pair or finds the value associated with the key.
+    ///
+    /// @param key specifies a key.
+    /// @param value specifies a mapped-value to insert, receives the value associated
+    ///        with the key if the container already had it.
+    /// @return
+    /// - `true` if a new association was inserted.
+    /// - `false` if the container already had a value associated with the specified key.
+    ///    The old value remains unchanged.
+    ///
+    bool find_or_insert(const key_type & key, mapped_type & value)
+    {
+        return m_hash_table_base.findOrInsert(key, value);
+    }
+
+    ///
+    /// The method inserts key-value pairs of a range. The method does nothing for
+    /// the keys that already have associated values.
+    ///
+    /// The container grows at once to the capacity for all the pairs and the pairs
+    /// are inserted in the order of their slots, so it takes less time than inserting
+    /// them one by one.
+    ///
+    /// @param first specifies the first key:mapped-value pair, the pairs must have
+    ///        `first` and `second` members, e.g. `value_type`.
+    /// @param last specifies the end of the pairs.
+    /// @return
+    /// - number of the new associations inserted.
+    ///
+    template<typename ForwardIterator>
+    size_type insert_range(ForwardIterator first, ForwardIterator last)
+    {
+        return m_hash_table_base.insertRange(first, last, 1);
+    }
+
+    /// @}
+
+    /// @name Update
+    /// @{
+
+    ///
+    /// The method modifies the value associated with the specified key in place.
+    ///
+    /// The modification is atomic: concurrent updates of the key do not lose each other
+    /// and [find](@ref find) sees either the old value or the new one.
+    ///
+    /// * Integral values (see `INTEGRAL_VALUE`) are replaced by a single CAS. The functor
+    ///   is applied to a copy of the value and is applied again if other thread has
+    ///   changed the value meanwhile, so it must not have other side effects.
+    /// * Other values are modified in the container, the functor is applied once.
+    ///   Other writers of the key wait for it and finds of the key may miss the key
+    ///   meanwhile as they do during [insertOrUpdate](@ref insertOrUpdate).
+    ///
+    /// @param key specifies a key.
+    /// @param func specifies a functor `void func(mapped_type & value)`.
+    /// @return
+    /// - `true` if the value was updated.
+    /// - `false` if the container did not have value associated with specified key.
+    ///
+    template<typename Functor>
+    bool update(const key_type & key, Functor func)
+    {
+        return m_hash_table_base.update(key, func);
+    }
+
+    ///
+    /// The method atomically adds `delta` to the value associated with the specified key,
+    /// see [update](@ref update). A missing key is inserted with the value `delta`.
+    ///
+    /// @param key specifies a key.
+    /// @param delta specifies a value to add.
+    /// @return
+    /// - the value associated with the key before the operation, `mapped_type()` if the
+    ///   key was inserted.
+    ///
+    mapped_type fetch_add(const key_type & key, const mapped_type & delta)
+    {
+        return m_hash_table_base.fetchAdd(key, delta);
+    }
+
     /// @}
 
     ///
@@ -318,9 +497,44 @@ public:
         return m_hash_table_base.getCapacity();
     }
 
+    ///
+    /// The method moves the items to a smaller table if the container is mostly empty.
+    /// The container never becomes smaller than the initial capacity.
+    ///
+    /// *Note:* the request is not binding, the method does nothing if other thread
+    /// is resizing the container at the moment.
+    ///
+    void shrink_to_fit()
+    {
+        m_hash_table_base.shrinkToFit();
+    }
+
+    ///
+    /// The method returns the low watermark, see setLowWatermark().
+    ///
+    /// @return the low watermark in percents of the capacity.
+    ///
+    unsigned int getLowWatermark() const
+    {
+        return m_hash_table_base.getLowWatermark();
+    }
+
+    ///
+    /// The method sets the low watermark. Erase operation shrinks the container when
+    /// the number of elements drops below the watermark. By default the watermark is
+    /// 15% of the capacity.
+    ///
+    /// @param percent specifies the watermark in percents of the capacity, 0 disables
+    ///        shrinking on erase.
+    ///
+    void setLowWatermark(const unsigned int percent)
+    {
+        m_hash_table_base.setLowWatermark(percent);
+    }
+
 private:
     //typedef hash_map_table_base<hash_table_type> hash_table_base_type;
-    typedef hash_map_table_base_traits<hash_table_type, MemModel> hash_map_table_base_traits_type;
+    typedef hash_map_table_base_traits<hash_table_type, MemModel, Rehashing> hash_map_table_base_traits_type;
     typedef typename hash_map_table_base_traits_type::type hash_table_base_type;
 
     hash_table_type m_hash_table;
@@ -18,6 +18,7 @@
 
 #include "hash_map.hpp"
 #include "impl/memory_model.hpp"
+#include "impl/indexing.hpp"
 #include "impl/hash_set_table.hpp"
 #include "impl/hash_set_table_base.hpp"
 #include "impl/hash_set_table_integral_key.hpp"
@@ -35,20 +36,23 @@ namespace
 {
 
 // hash_set is an adapter for hash_map
-template<typename T, typename Hash, typename Pred, typename Allocator, bool =
-        is_integral<T>::value>
+template<typename T, typename Hash, typename Pred, typename Allocator,
+        indexing::type Indexing = default_indexing::value, bool =
+                is_integral<T>::value>
 struct make_hash_set_table;
 
-template<typename T, typename Hash, typename Pred, typename Allocator>
-struct make_hash_set_table<T, Hash, Pred, Allocator, false>
+template<typename T, typename Hash, typename Pred, typename Allocator,
+        indexing::type Indexing>
+struct make_hash_set_table<T, Hash, Pred, Allocator, Indexing, false>
 {
-    typedef hash_set_table<T, Hash, Pred, Allocator> type;
+    typedef hash_set_table<T, Hash, Pred, Allocator, Indexing> type;
 };
 
-template<typename T, typename Hash, typename Pred, typename Allocator>
-struct make_hash_set_table<T, Hash, Pred, Allocator, true>
+template<typename T, typename Hash, typename Pred, typename Allocator,
+        indexing::type Indexing>
+struct make_hash_set_table<T, Hash, Pred, Allocator, Indexing, true>
 {
-    typedef hash_set_table_integral_key<T, Hash, Pred, Allocator> type;
+    typedef hash_set_table_integral_key<T, Hash, Pred, Allocator, Indexing> type;
 };
 }
 /// \endcond
@@ -64,6 +68,8 @@ struct make_hash_set_table<T, Hash, Pred, Allocator, true>
 /// @param Pred type of equal function, std::equal_to<T> is used by default.
 /// @param Allocator type of allocator, by default std::allocator<T>.
 /// @param MemModel memory model, by default memory_model::wise is used.
+/// @param Rehashing the way the container grows, by default rehashing::stop_the_world is used.
+/// @param Indexing the way a hash is mapped to a slot, by default indexing::modulo is used.
 ///
 /// Memory model allows to find balance between performance and memory consumption:
 ///
@@ -74,10 +80,14 @@ struct make_hash_set_table<T, Hash, Pred, Allocator, true>
 /// * [make_wise_hash_set](@ref make_wise_hash_set)
 /// * [make_greedy_hash_set](@ref make_greedy_hash_set)
 ///
+/// Rehashing, indexing and shrinking are described in [hash_map](@ref hash_map).
+///
 template<typename T, typename Hash = typename make_hash<T>::type,
         typename Pred = std::equal_to<T>,
         typename Allocator = std::allocator<T>, memory_model::type MemModel =
-                default_memory_model::value>
+                default_memory_model::value, rehashing::type Rehashing =
+                default_rehashing::value, indexing::type Indexing =
+                default_indexing::value>
 class hash_set
 {
 public:
@@ -86,7 +96,7 @@ public:
     typedef hash_set<T, Hash, Pred, Allocator> this_type;
     /// \endcond
 
-    typedef typename make_hash_set_table<T, Hash, Pred, Allocator>::type hash_table_type; ///< hash table type.
+    typedef typename make_hash_set_table<T, Hash, Pred, Allocator, Indexing>::type hash_table_type; ///< hash table type.
     typedef typename hash_table_type::size_type size_type;                                ///< size type.
     typedef typename hash_table_type::key_type key_type;                                  ///< key type (aka T).
     typedef typename hash_table_type::hash_func_type hash_func_type;                      ///< hash function type.
@@ -96,6 +106,8 @@ public:
 
     static constexpr bool INTEGRAL = hash_table_type::INTEGRAL;   ///< true if value is treated as integral type.
     static constexpr memory_model::type MEMORY_MODEL = MemModel;  ///< used memory model.
+    static constexpr rehashing::type REHASHING = Rehashing;       ///< used rehashing.
+    static constexpr indexing::type INDEXING = Indexing;          ///< used indexing.
 
 public:
 
@@ -134,6 +146,26 @@ public:
         return m_hash_table_base.find(key);
     }
 
+    ///
+    /// The method checks if the specified keys are present in the container.
+    ///
+    /// The keys are looked up with prefetching of their slots several keys ahead,
+    /// so a batch of lookups over a table that does not fit into cache takes less
+    /// time than the same number of calls of [find](@ref find).
+    ///
+    /// @param keys specifies the values to find.
+    /// @param count specifies the number of values.
+    /// @param foundMask receives bit `i % 64` of `foundMask[i / 64]` set if
+    ///        `keys[i]` was found, it must hold `(count + 63) / 64` words.
+    /// @return number of the values found.
+    ///
+    size_type find_batch(const key_type* keys,
+                         const size_type count,
+                         uint64_t* foundMask) const
+    {
+        return m_hash_table_base.findBatch(keys, count, foundMask);
+    }
+
     ///
     /// The method inserts a new value into the container.
     ///
@@ -180,9 +212,44 @@ public:
         return m_hash_table_base.getCapacity();
     }
 
+    ///
+    /// The method moves the items to a smaller table if the container is mostly empty.
+    /// The container never becomes smaller than the initial capacity.
+    ///
+    /// *Note:* the request is not binding, the method does nothing if other thread
+    /// is resizing the container at the moment.
+    ///
+    void shrink_to_fit()
+    {
+        m_hash_table_base.shrinkToFit();
+    }
+
+    ///
+    /// The method returns the low watermark, see setLowWatermark().
+    ///
+    /// @return the low watermark in percents of the capacity.
+    ///
+    unsigned int getLowWatermark() const
+    {
+        return m_hash_table_base.getLowWatermark();
+    }
+
+    ///
+    /// The method sets the low watermark. Erase operation shrinks the container when
+    /// the number of elements drops below the watermark. By default the watermark is
+    /// 15% of the capacity.
+    ///
+    /// @param percent specifies the watermark in percents of the capacity, 0 disables
+    ///        shrinking on erase.
+    ///
+    void setLowWatermark(const unsigned int percent)
+    {
+        m_hash_table_base.setLowWatermark(percent);
+    }
+
 private:
     //typedef hash_set_table_base<hash_table_type> hash_table_base_type;
-    typedef hash_set_table_base_traits<hash_table_type, MemModel> hash_set_table_base_traits_type;
+    typedef hash_set_table_base_traits<hash_table_type, MemModel, Rehashing> hash_set_table_base_traits_type;
     typedef typename hash_set_table_base_traits_type::type hash_table_base_type;
 
     hash_table_type m_hash_table;
@@ -20,6 +20,8 @@
 #include "impl/pool_buffer.hpp"
 #include "impl/meta_utils.hpp"
 #include "impl/ref_lock.hpp"
+#include "impl/epoch.hpp"
+#include "impl/reclamation.hpp"
 #include "aux/inttypes.hpp"
 #include "aux/xfunctional.hpp"
 #include "aux/cppbasics.hpp"
@@ -322,7 +324,7 @@ private:
 
 // branch node
 template<typename Key, typename Value, typename HashType, int BFactor>
-struct BNode: public Node
+struct BNode: public Node, public epoch_hook
 {
     typedef Key key_type;
     typedef Value value_type;
@@ -345,6 +347,7 @@ private:
 public:
     BNode() :
             Node(branch),
+            epoch_hook(),
             m_parent(nullptr),
             m_refCount(0)
     {
@@ -366,6 +369,84 @@ public:
     }
 };
 
+// frees branches torn down by erase
+template<reclamation::type Reclamation, typename BNode, typename Buffer>
+class branch_reclaimer;
+
+template<typename BNode, typename Buffer>
+class branch_reclaimer<reclamation::ref_count, BNode, Buffer>
+{
+public:
+    typedef BNode b_type;
+    typedef Buffer buffer_type;
+
+    // readers lock the branches they visit
+    static constexpr bool LOCK_FREE_READS = false;
+
+    struct read_guard
+    {
+        read_guard(const branch_reclaimer&)
+        {
+        }
+    };
+
+    // nobody holds the branch any more
+    void free(buffer_type& buffer, b_type* b)
+    {
+        buffer.deallocate(b);
+    }
+    void clear(buffer_type&)
+    {
+    }
+};
+
+template<typename BNode, typename Buffer>
+class branch_reclaimer<reclamation::epoch, BNode, Buffer>
+{
+public:
+    typedef BNode b_type;
+    typedef Buffer buffer_type;
+
+    // readers do not lock branches, they stay in the epoch domain instead
+    static constexpr bool LOCK_FREE_READS = true;
+
+    struct read_guard: public epoch_guard
+    {
+        read_guard(const branch_reclaimer& reclaimer) :
+                epoch_guard(reclaimer.m_domain)
+        {
+        }
+    };
+
+private:
+    struct deleter
+    {
+        buffer_type* m_buffer;
+
+        void operator()(b_type* b) const
+        {
+            m_buffer->deallocate(b);
+        }
+    };
+
+public:
+    // no writer holds the branch any more, but readers still may
+    void free(buffer_type& buffer, b_type* b)
+    {
+        deleter del = { &buffer };
+        m_retired.retire(m_domain, b);
+        m_retired.collect(m_domain, del);
+    }
+    void clear(buffer_type& buffer)
+    {
+        deleter del = { &buffer };
+        m_retired.clear(del);
+    }
+private:
+    epoch_domain m_domain;
+    epoch_retire_list<b_type> m_retired;
+};
+
 template<typename T, typename Hash, int = sizeof(std::size_t)>
 struct hash_adapter;
 
@@ -441,11 +522,15 @@ private:
 /// @param Hash hash function. Default is std::hash<Key>.
 /// @param Pred equal predicate. Default is std::equal_to<Key>.
 /// @param Allocator allocator type. Default is std::allocator<Value>.
+/// @param Reclamation the way readers keep branches alive:
+/// - `reclamation::ref_count` `find()` counts references to the branches it visits (default).
+/// - `reclamation::epoch` `find()` does not write to shared nodes, erased branches are freed
+///   when no reader can see them.
 ///
 template<typename Key, typename Value, int BFactor = 16,
         typename Hash = typename make_hash<Key>::type,
         typename Pred = std::equal_to<Key>, typename Allocator = std::allocator<
-                Value> >
+                Value>, reclamation::type Reclamation = default_reclamation::value>
 class hash_trie
 {
 public:
@@ -458,11 +543,12 @@ public:
 
 
     static constexpr int BFACTOR = BFactor;                                 ///< branching factor
+    static constexpr reclamation::type RECLAMATION = Reclamation;           ///< reclamation policy
 
     /// \cond HIDDEN_SYMBOLS
     typedef Hash hash_base_type;
     typedef hash_trie<key_type, mapped_type, BFACTOR, hash_base_type,
-            predicate_type, allocator_type> this_type;
+            predicate_type, allocator_type, RECLAMATION> this_type;
     /// \endcond
 
     typedef htrie::hash_adapter<key_type, hash_base_type> hash_func_type;   ///< adapted hash function type.
@@ -479,6 +565,7 @@ public:
 
     typedef pool_buffer<b_type, allocator_type> b_buffer_type;
     typedef pool_buffer<c_type, allocator_type> c_buffer_type;
+    typedef htrie::branch_reclaimer<RECLAMATION, b_type, b_buffer_type> reclaimer_type;
 
     typedef typename Allocator::template rebind<key_type>::other key_allocator_type;
     typedef typename Allocator::template rebind<mapped_type>::other mapped_allocator_type;
@@ -521,6 +608,7 @@ public:
     ~hash_trie()
     {
         assert(!dbgCheckRefrences());
+        m_reclaimer.clear(m_b_buffer);
     }
 
     ///
@@ -534,6 +622,12 @@ public:
     ///
     bool find(const key_type & key, mapped_type & val) const
     {
+        if (reclaimer_type::LOCK_FREE_READS)
+        {
+            typename reclaimer_type::read_guard guard(m_reclaimer);
+            return findUnlocked(key, val);
+        }
+
         const hash_type hash = m_hashFunc(key);
         hash_type shash = hash; // shifted hash
 
@@ -556,7 +650,7 @@ public:
             }
             else if (p->m_type == htrie::chain)
             {
-                return findInChain(bn, ptr, p, hash, key, val);
+                return findInChain(p, hash, key, val);
             }
         }
         assert(false); // shit happens
@@ -718,9 +812,37 @@ public:
     }
     /// \endcond
 private:
-    bool findInChain(cb_lock& bn,
-                     cptr_lock& ptr,
-                     const n_type* p,
+    // the function does not lock branches, the caller keeps them alive
+    bool findUnlocked(const key_type & key, mapped_type & val) const
+    {
+        constexpr hash_type mask = htrie::get_mask<BFACTOR>::value;
+        constexpr int shift = htrie::get_shift_size<BFACTOR>::value;
+        const hash_type hash = m_hashFunc(key);
+        hash_type shash = hash; // shifted hash
+
+        const b_type* bn = &m_root;
+
+        for (;;)
+        {
+            const n_type* p = bn->m_array[shash & mask].getNode();
+            if (!p)
+            {
+                return false;
+            }
+            else if (p->m_type == htrie::branch)
+            {
+                shash >>= shift;
+                bn = reinterpret_cast<const b_type*>(p);
+            }
+            else if (p->m_type == htrie::chain)
+            {
+                return findInChain(p, hash, key, val);
+            }
+        }
+        assert(false); // shit happens
+        return false;
+    }
+    bool findInChain(const n_type* p,
                      const hash_type hash,
                      const key_type & key,
                      mapped_type & val) const
@@ -951,7 +1073,7 @@ private:
             bn.swap(parent);
             parent.swap();
             raw_b->wait();
-            m_b_buffer.deallocate(raw_b);
+            m_reclaimer.free(m_b_buffer, raw_b);
         }
         return ret;
     }
@@ -1037,6 +1159,7 @@ private:
     mapped_allocator_type m_mappedAllocator;
     b_buffer_type m_b_buffer;
     c_buffer_type m_c_buffer;
+    reclaimer_type m_reclaimer;
     const hash_func_type m_hashFunc;
     const predicate_type m_eqFunc;
 }
@@ -0,0 +1,266 @@
+/*
+ * huge_page_allocator.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: masha
+ */
+
+/// \file huge_page_allocator.hpp
+///
+/// @brief Allocator that backs big blocks by huge pages.
+///
+
+#ifndef INCLUDE_HUGE_PAGE_ALLOCATOR_HPP_
+#define INCLUDE_HUGE_PAGE_ALLOCATOR_HPP_
+
+/// \cond HIDDEN_SYMBOLS
+#include "impl/first_touch.hpp"
+#include "aux/cppbasics.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <sys/mman.h>
+/// \endcond
+
+namespace xtomic
+{
+
+/// \cond HIDDEN_SYMBOLS
+struct HugePages
+{
+    enum EFlags
+    {
+        Explicit = 1,       // MAP_HUGETLB, needs pages reserved by vm.nr_hugepages
+        Transparent = 2,    // 2M aligned block and madvise(MADV_HUGEPAGE)
+        Populate = 4,       // MAP_POPULATE, pages are faulted in by mmap()
+        ParallelInit = 8,   // containers construct big arrays of nodes by several threads
+        Default = Explicit | Transparent | Populate,
+    };
+};
+/// \endcond
+
+///
+/// \class huge_page_allocator
+///
+/// \brief The allocator maps big blocks (1M and more) directly with `mmap()` so they are
+/// backed by huge pages, small blocks are taken from the heap.
+///
+/// Fixed sized containers allocate all nodes at once: fixed sized stack and queue, wait-free
+/// queue, tables of hash maps and sets. With the allocator such containers do not take
+/// a page fault per 4K on first touch and use much less TLB entries.
+///
+/// An explicit huge page is tried first. If the system has no reserved huge pages,
+/// the block is aligned to 2M and marked for transparent huge pages. With `Populate`
+/// the kernel faults in the block before `allocate()` returns. With `ParallelInit` hash
+/// tables construct their nodes by several threads, so the first touch is spread between
+/// CPUs (and NUMA nodes).
+///
+/// Example:
+///
+///     typedef xtomic::huge_page_allocator<int> allocator_type;
+///     xtomic::hash_map<int, int, std::hash<int>, std::equal_to<int>, allocator_type> map(50000000);
+///
+/// @param T type of element.
+/// @param Flags combination of `HugePages::EFlags`. Default is `HugePages::Default` (explicit or
+///        transparent huge pages, pre-faulted).
+///
+template<typename T, unsigned int Flags = HugePages::Default>
+class huge_page_allocator
+{
+public:
+    typedef T value_type;               ///< value type.
+    typedef T* pointer;                 ///< pointer.
+    typedef const T* const_pointer;     ///< const pointer.
+    typedef T& reference;               ///< reference.
+    typedef const T& const_reference;   ///< const reference.
+    typedef std::size_t size_type;      ///< size type.
+    typedef std::ptrdiff_t difference_type; ///< difference type.
+
+    /// allocator for another type.
+    template<typename U>
+    struct rebind
+    {
+        typedef huge_page_allocator<U, Flags> other; ///< rebound type.
+    };
+
+    /// \cond HIDDEN_SYMBOLS
+    static const size_type HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+    static const size_type MIN_MAPPED_SIZE = 1024 * 1024;
+    /// \endcond
+
+public:
+    huge_page_allocator()
+    {
+    }
+    huge_page_allocator(const huge_page_allocator&)
+    {
+    }
+    template<typename U>
+    huge_page_allocator(const huge_page_allocator<U, Flags>&)
+    {
+    }
+
+    ///
+    /// \brief The method allocates memory for n elements. Big blocks are mapped with `mmap()`.
+    ///
+    pointer allocate(size_type n, const void* = nullptr)
+    {
+        const size_type bytes = n * sizeof(T);
+        if (bytes < MIN_MAPPED_SIZE)
+        {
+            return m_heap.allocate(n);
+        }
+        return static_cast<pointer>(map(roundUp(bytes)));
+    }
+
+    ///
+    /// \brief The method releases memory allocated by allocate().
+    ///
+    void deallocate(pointer p, size_type n)
+    {
+        const size_type bytes = n * sizeof(T);
+        if (bytes < MIN_MAPPED_SIZE)
+        {
+            m_heap.deallocate(p, n);
+            return;
+        }
+        munmap(p, roundUp(bytes));
+    }
+
+#if XTOMIC_USE_CPP11
+    /// \cond HIDDEN_SYMBOLS
+    template<typename U, typename ... Args>
+    void construct(U* p, Args&&... args)
+    {
+        ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+    template<typename U>
+    void destroy(U* p)
+    {
+        p->~U();
+    }
+    /// \endcond
+#else
+    /// \cond HIDDEN_SYMBOLS
+    void construct(pointer p, const_reference val)
+    {
+        ::new (static_cast<void*>(p)) T(val);
+    }
+    void destroy(pointer p)
+    {
+        p->~T();
+    }
+    /// \endcond
+#endif
+
+    /// \cond HIDDEN_SYMBOLS
+    pointer address(reference x) const
+    {
+        return &x;
+    }
+    const_pointer address(const_reference x) const
+    {
+        return &x;
+    }
+    size_type max_size() const
+    {
+        return static_cast<size_type>(-1) / sizeof(T);
+    }
+    /// \endcond
+
+private:
+    static size_type roundUp(size_type bytes)
+    {
+        return (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+    }
+    static int populate()
+    {
+#ifdef MAP_POPULATE
+        return (Flags & HugePages::Populate) ? MAP_POPULATE : 0;
+#else
+        return 0;
+#endif
+    }
+    static void* map(size_type bytes)
+    {
+        const int flags = MAP_PRIVATE | MAP_ANONYMOUS | populate();
+#ifdef MAP_HUGETLB
+        if (Flags & HugePages::Explicit)
+        {
+            void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                    flags | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED)
+            {
+                return p;
+            }
+        }
+#endif
+        if (!(Flags & HugePages::Transparent))
+        {
+            return checked(
+                    mmap(nullptr, bytes, PROT_READ | PROT_WRITE, flags, -1,
+                            0));
+        }
+        // the block is mapped without MAP_POPULATE, otherwise small pages are
+        // faulted in before the advice is given
+        char* raw = static_cast<char*>(checked(
+                mmap(nullptr, bytes + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)));
+        char* aligned = reinterpret_cast<char*>(roundUp(
+                reinterpret_cast<size_type>(raw)));
+        if (aligned != raw)
+        {
+            munmap(raw, aligned - raw);
+        }
+        munmap(aligned + bytes, raw + HUGE_PAGE_SIZE - aligned);
+#ifdef MADV_HUGEPAGE
+        madvise(aligned, bytes, MADV_HUGEPAGE);
+#endif
+#ifdef MADV_POPULATE_WRITE
+        if (Flags & HugePages::Populate)
+        {
+            madvise(aligned, bytes, MADV_POPULATE_WRITE);
+        }
+#endif
+        return aligned;
+    }
+    static void* checked(void* p)
+    {
+        if (p == MAP_FAILED)
+        {
+            throw std::bad_alloc();
+        }
+        return p;
+    }
+
+private:
+    std::allocator<T> m_heap;
+};
+
+/// \cond HIDDEN_SYMBOLS
+template<typename T, unsigned int Flags, typename U>
+inline bool operator==(const huge_page_allocator<T, Flags>&,
+                       const huge_page_allocator<U, Flags>&)
+{
+    return true;
+}
+
+template<typename T, unsigned int Flags, typename U>
+inline bool operator!=(const huge_page_allocator<T, Flags>&,
+                       const huge_page_allocator<U, Flags>&)
+{
+    return false;
+}
+
+template<typename T, unsigned int Flags>
+struct parallel_first_touch<huge_page_allocator<T, Flags> >
+{
+    static const bool value = (Flags & HugePages::ParallelInit) != 0;
+};
+/// \endcond
+
+}
+
+#endif /* INCLUDE_HUGE_PAGE_ALLOCATOR_HPP_ */
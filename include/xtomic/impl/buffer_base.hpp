@@ -75,6 +75,20 @@ public:
     {
         return m_freeNodes.atomic_pop();
     }
+    // chain first->...->last is returned with a single CAS
+    void pushFreeNodes(node_type* first, node_type* last)
+    {
+        m_freeNodes.atomic_push(first, last);
+    }
+    // up to count nodes are taken with a single CAS,
+    // at exit count holds number of taken nodes
+    node_type* popFreeNodes(size_type& count)
+    {
+        std::size_t n = count;
+        node_type* p = m_freeNodes.atomic_pop(n);
+        count = static_cast<size_type>(n);
+        return p;
+    }
 #if XTOMIC_USE_CPP11
     template<typename ... Args>
     node_type* newNode(Args&&... data)
@@ -105,6 +119,15 @@ public:
         destroyData(p);
         pushFreeNode(p);
     }
+    void freeNodes(node_type* first, node_type* last)
+    {
+        for (node_type* p = first; p != last; p = p->m_next)
+        {
+            destroyData(p);
+        }
+        destroyData(last);
+        pushFreeNodes(first, last);
+    }
 
 private:
     data_allocator_type m_dataAllocator;
@@ -10,25 +10,51 @@
 
 #include "fixed_buffer.hpp"
 #include "dynamic_buffer.hpp"
+#include "magazine_buffer.hpp"
+#include "numa_buffer.hpp"
 
 namespace xtomic
 {
 
-template<typename T, typename Allocator, bool FixedSize>
+struct Buffer
+{
+    enum EPolicy
+    {
+        Shared,         // every node goes through the shared free list
+        ThreadCached,   // per-thread magazines in front of the shared free list
+        NumaLocal,      // free list per NUMA node, threads take nodes from the local one
+    };
+};
+
+template<typename T, typename Allocator, bool FixedSize,
+        Buffer::EPolicy Policy = Buffer::Shared>
 struct buffer_traits;
 
 template<typename T, typename Allocator>
-struct buffer_traits<T, Allocator, true>
+struct buffer_traits<T, Allocator, true, Buffer::Shared>
 {
     typedef fixed_buffer<T, Allocator> type;
 };
 
 template<typename T, typename Allocator>
-struct buffer_traits<T, Allocator, false>
+struct buffer_traits<T, Allocator, false, Buffer::Shared>
 {
     typedef dynamic_buffer<T, Allocator> type;
 };
 
+template<typename T, typename Allocator, bool FixedSize>
+struct buffer_traits<T, Allocator, FixedSize, Buffer::ThreadCached>
+{
+    typedef magazine_buffer<
+            typename buffer_traits<T, Allocator, FixedSize, Buffer::Shared>::type> type;
+};
+
+template<typename T, typename Allocator, bool FixedSize>
+struct buffer_traits<T, Allocator, FixedSize, Buffer::NumaLocal>
+{
+    typedef numa_buffer<T, Allocator, FixedSize> type;
+};
+
 }
 
 #endif /* INCLUDE_BUFFER_TRAITS_HPP_ */
@@ -0,0 +1,169 @@
+/*
+ * control_bytes.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: masha
+ */
+
+#ifndef INCLUDE_CONTROL_BYTES_HPP_
+#define INCLUDE_CONTROL_BYTES_HPP_
+
+#include "cas.hpp"
+#include <xtomic/quantum.hpp>
+
+#include <cstddef>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace xtomic
+{
+
+//
+// Control bytes of a hash table (indexing::control_bytes).
+//
+// Each slot has a byte in a separate array: CONTROL_EMPTY until the slot is
+// claimed, then 7 bits of the hash (the tag) for the rest of the table's life.
+// An inserting thread claims a slot by CAS of its byte before it touches the
+// node, so the bytes that are not empty cover all used slots and a probe may
+// stop at the first empty byte exactly as it stops at the first unused node.
+//
+// A probe reads a group of CONTROL_GROUP bytes at once and visits only the
+// slots whose tag matches. Groups are aligned, the capacity is a power of two
+// and at least 32, so a group never wraps around the end of the table.
+//
+static const unsigned char CONTROL_EMPTY = 0x80;
+static const std::size_t CONTROL_GROUP = 16;
+
+/// \cond HIDDEN_SYMBOLS
+
+inline unsigned char control_tag(const std::size_t hash)
+{
+    return static_cast<unsigned char>(hash & 0x7f);
+}
+
+// bit i of the result is set if byte i of the group equals the value
+inline unsigned int control_match(const unsigned char* group,
+                                  const unsigned char value)
+{
+#if defined(__SSE2__)
+    const __m128i bytes = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(group));
+    const __m128i pattern = _mm_set1_epi8(static_cast<char>(value));
+    return static_cast<unsigned int>(_mm_movemask_epi8(
+            _mm_cmpeq_epi8(bytes, pattern)));
+#else
+    unsigned int mask = 0;
+    for (std::size_t i = 0; i < CONTROL_GROUP; ++i)
+    {
+        if (group[i] == value)
+        {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+#endif
+}
+
+inline unsigned int control_lowest(const unsigned int mask)
+{
+    return static_cast<unsigned int>(__builtin_ctz(mask));
+}
+
+// claims the slot for the hash, fails if the slot has been claimed already
+inline bool control_claim(unsigned char* control,
+                          const std::size_t slot,
+                          const std::size_t hash)
+{
+    return atomic_cas(control[slot], CONTROL_EMPTY, control_tag(hash));
+}
+
+//
+// The probing sequence of a hash over control bytes. next() yields the slots
+// with the tag of the hash in probing order and fails at the first empty slot.
+//
+template<typename Table>
+class control_probe
+{
+public:
+    typedef Table table_type;
+    typedef typename table_type::size_type size_type;
+
+    static const unsigned int GROUP_MASK = (1u << CONTROL_GROUP) - 1;
+
+public:
+    control_probe(const table_type& table, const size_type hash) :
+            m_control(table.m_control),
+            m_mask(table.m_capacity - 1),
+            m_home(table.homeSlot(hash)),
+            m_group(m_home & ~(CONTROL_GROUP - 1)),
+            m_tag(control_tag(hash)),
+            m_matches(0),
+            m_empty(0),
+            m_wrapped(false)
+    {
+        // most hits read the node of the home slot, so the node is fetched
+        // while the control bytes are on their way
+        __builtin_prefetch(table.m_table + m_home);
+        load();
+    }
+    bool next(size_type& slot)
+    {
+        for (;;)
+        {
+            if (m_matches)
+            {
+                slot = m_group + control_lowest(m_matches);
+                m_matches &= m_matches - 1;
+                return true;
+            }
+            if (m_empty)
+            {
+                return false;
+            }
+            m_group = (m_group + CONTROL_GROUP) & m_mask;
+            load();
+        }
+    }
+    // the first empty slot of the sequence, valid after next() has failed
+    size_type emptySlot() const
+    {
+        return m_group + control_lowest(m_empty);
+    }
+private:
+    void load()
+    {
+        unsigned int valid = GROUP_MASK;
+        if (m_group == (m_home & ~(CONTROL_GROUP - 1)))
+        {
+            // the home group is visited from the home slot and, after the
+            // whole table, up to the home slot
+            const unsigned int first = 1u << (m_home & (CONTROL_GROUP - 1));
+            valid = m_wrapped ? first - 1 : GROUP_MASK & ~(first - 1);
+            m_wrapped = true;
+        }
+        const unsigned char* group = m_control + m_group;
+        const unsigned int empty = control_match(group, CONTROL_EMPTY) & valid;
+        const unsigned int matches = control_match(group, m_tag) & valid;
+        // nodes are read after the bytes
+        thread_fence(barriers::acquire);
+        m_empty = empty & (0u - empty);
+        m_matches = matches & (m_empty ? m_empty - 1 : GROUP_MASK);
+    }
+private:
+    const unsigned char* m_control;
+    const size_type m_mask;
+    const size_type m_home;
+    size_type m_group;
+    const unsigned char m_tag;
+    unsigned int m_matches;
+    unsigned int m_empty;   // the lowest empty byte of the group
+    bool m_wrapped;
+};
+
+/// \endcond
+
+}
+
+#endif /* INCLUDE_CONTROL_BYTES_HPP_ */
@@ -81,6 +81,58 @@ public:
     {
         m_base.freeNode(p);
     }
+
+    // Batch operations, see fixed_buffer.
+    // The buffer always reserves requested number of nodes.
+    node_type* reserveNodes(size_type& count)
+    {
+        size_type reserved = count;
+        node_type* first = m_base.popFreeNodes(reserved);
+        try
+        {
+            for (; reserved < count; ++reserved)
+            {
+                node_type* node = m_base.allocate_nodes(1);
+                node->m_next = first;
+                first = node;
+            }
+        }
+        catch (...)
+        {
+            if (first)
+            {
+                node_type* last = first;
+                while (last->m_next)
+                {
+                    last = last->m_next;
+                }
+                m_base.pushFreeNodes(first, last);
+            }
+            throw;
+        }
+        return first;
+    }
+#if XTOMIC_USE_CPP11
+    template<typename ... Args>
+    void constructData(node_type* p, Args&&... data)
+#else
+    void constructData(node_type* p, const value_type& data)
+#endif
+    {
+        m_base.constructData(p, std_forward(Args, data));
+    }
+    void destroyData(node_type* p)
+    {
+        m_base.destroyData(p);
+    }
+    void releaseNodes(node_type* first, node_type* last)
+    {
+        m_base.pushFreeNodes(first, last);
+    }
+    void freeNodes(node_type* first, node_type* last)
+    {
+        m_base.freeNodes(first, last);
+    }
     size_type getCapacity() const
     {
         return size_type();
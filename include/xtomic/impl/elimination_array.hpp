@@ -0,0 +1,199 @@
+/*
+ * elimination_array.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: masha
+ */
+
+#ifndef INCLUDE_ELIMINATION_ARRAY_HPP_
+#define INCLUDE_ELIMINATION_ARRAY_HPP_
+
+#include "aba_ptr.hpp"
+#include <xtomic/quantum.hpp>
+#include <xtomic/aux/cppbasics.hpp>
+
+#include <cstddef>
+
+namespace xtomic
+{
+
+//
+// Elimination array for a stack.
+//
+// A push and a pop that happen at the same time cancel each other, so they do not
+// need to touch the head of the stack. When the CAS on the head fails, a pusher
+// offers its node in a random slot and waits for a while. If a popper comes to
+// the slot during this time, it takes the node and both operations complete. Otherwise
+// the pusher takes the offer back and retries on the head.
+//
+// Slots are aba_ptr so a pusher never retracts an offer made with the same node by
+// somebody else after the node was popped and reused.
+//
+// Only the first m_width slots are used. The width grows when threads find slots
+// busy with an operation of the same kind and shrinks when they time out without
+// a partner.
+//
+template<typename Node, std::size_t Slots = 16>
+class elimination_array
+{
+public:
+    typedef Node node_type;
+    typedef std::size_t size_type;
+
+private:
+    typedef elimination_array<Node, Slots> this_class;
+    typedef aba_ptr<node_type> node_ptr;
+
+    struct slot_type
+    {
+        volatile node_ptr m_offer;
+        pad_4_cache_line(m_pad);
+    };
+
+    enum
+    {
+        SPIN = 128,
+    };
+
+private:
+    elimination_array(const this_class&);
+    this_class& operator=(const this_class&);
+
+public:
+    elimination_array() :
+            m_width(1)
+    {
+    }
+
+    // returns true if p has been taken by a pop
+    bool exchangePush(node_type* p)
+    {
+        const size_type width = m_width.load(barriers::relaxed);
+        slot_type& slot = m_slots[random() % width];
+
+        node_ptr expected;
+        expected = slot.m_offer;
+        if (expected.m_ptr)
+        {
+            // the slot is busy with another push
+            grow(width);
+            return false;
+        }
+        const node_ptr offer(p, expected.m_counter + 1);
+        if (!slot.m_offer.atomic_cas(expected, offer))
+        {
+            grow(width);
+            return false;
+        }
+        for (int i = 0; i < SPIN; ++i)
+        {
+            // only a pop changes the slot while the offer is there
+            if (slot.m_offer.m_counter != offer.m_counter)
+            {
+                return true;
+            }
+            cpu_relax();
+        }
+        if (slot.m_offer.atomic_cas(offer, node_ptr(nullptr, offer.m_counter + 1)))
+        {
+            shrink(width);
+            return false;
+        }
+        // the node has been taken right now
+        return true;
+    }
+
+    // returns a node offered by a push or nullptr
+    node_type* exchangePop()
+    {
+        const size_type width = m_width.load(barriers::relaxed);
+        slot_type& slot = m_slots[random() % width];
+
+        node_ptr expected;
+        for (int i = 0; i < SPIN; ++i)
+        {
+            expected = slot.m_offer;
+            if (expected.m_ptr)
+            {
+                if (slot.m_offer.atomic_cas(expected,
+                        node_ptr(nullptr, expected.m_counter + 1)))
+                {
+                    return expected.m_ptr;
+                }
+                // another pop has taken it
+                grow(width);
+                return nullptr;
+            }
+            cpu_relax();
+        }
+        shrink(width);
+        return nullptr;
+    }
+
+private:
+    void grow(const size_type width)
+    {
+        if (width < Slots)
+        {
+            m_width.store(width + 1, barriers::relaxed);
+        }
+    }
+    void shrink(const size_type width)
+    {
+        if (width > 1)
+        {
+            m_width.store(width - 1, barriers::relaxed);
+        }
+    }
+    // per thread xorshift generator
+    static size_type random()
+    {
+        static __thread unsigned int seed = 0;
+        if (!seed)
+        {
+            seed = static_cast<unsigned int>(reinterpret_cast<std::size_t>(&seed)) | 1;
+        }
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return seed;
+    }
+
+private:
+    slot_type m_slots[Slots];
+    xtomic::quantum<size_type> m_width;
+};
+
+// no elimination
+template<typename Node>
+class null_elimination_array
+{
+public:
+    typedef Node node_type;
+
+public:
+    bool exchangePush(node_type*)
+    {
+        return false;
+    }
+    node_type* exchangePop()
+    {
+        return nullptr;
+    }
+};
+
+template<typename Node, bool Enabled>
+struct elimination_traits
+{
+    typedef elimination_array<Node> type;
+};
+
+template<typename Node>
+struct elimination_traits<Node, false>
+{
+    typedef null_elimination_array<Node> type;
+};
+
+}
+
+#endif /* INCLUDE_ELIMINATION_ARRAY_HPP_ */
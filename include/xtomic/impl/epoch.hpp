@@ -0,0 +1,298 @@
+/*
+ * epoch.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: masha
+ */
+
+#ifndef INCLUDE_EPOCH_HPP_
+#define INCLUDE_EPOCH_HPP_
+
+#include "thread_slot.hpp"
+#include <xtomic/quantum.hpp>
+#include <xtomic/aux/cppbasics.hpp>
+
+#include <cstddef>
+#include <memory>
+
+namespace xtomic
+{
+
+//
+// Epoch based reclamation (EBR).
+//
+// Readers of a container do not count references to the objects they read,
+// instead they enter the epoch domain of the container for the time of the
+// operation. A writer retires an object it has made unreachable and the object
+// is freed later, when no reader that could see it is left.
+//
+// The domain has a slot per processor, SLOTS at most, the slots are allocated
+// out of the domain object. A thread is registered in the slot thread_slot()
+// modulo the number of slots. A slot keeps counters of readers of even and odd
+// epochs, so a reader writes only to the cache line of its own slot. Threads that
+// share a slot are counted together. The reader checks the epoch again after the
+// counter is incremented and starts over if the epoch has changed, so since the
+// check the reader is known to the next advance.
+//
+// The epoch advances from E to E + 1 when the counters of E - 1 are zero. Every
+// reader that could see an object retired in epoch E has left when the epoch
+// advances from E + 1, so the object is freed when the epoch reaches E + 2.
+// Readers never wait: the epoch is advanced by writers, either from time to time
+// (retire lists) or at once when the writer waits in synchronize().
+//
+class epoch_domain
+{
+public:
+    typedef std::size_t epoch_type;
+    typedef std::size_t count_type;
+    typedef std::size_t token_type;
+
+    static const std::size_t SLOTS = 64;
+
+private:
+    struct slot_type
+    {
+        // counters of readers of even and odd epochs
+        xtomic::quantum<count_type> m_count[2];
+        pad_4_cache_line(m_pad);
+    };
+
+    typedef std::allocator<slot_type> slot_allocator_type;
+
+    epoch_domain(const epoch_domain&); // = delete;
+    epoch_domain& operator=(const epoch_domain&); // = delete;
+
+public:
+    epoch_domain() :
+            m_epoch(0),
+            m_mask(thread_slot_count(SLOTS) - 1),
+            m_slotAllocator(),
+            m_slots(m_slotAllocator.allocate(m_mask + 1))
+    {
+        for (std::size_t i = 0; i <= m_mask; ++i)
+        {
+            ::new (static_cast<void*>(m_slots + i)) slot_type();
+        }
+    }
+    ~epoch_domain()
+    {
+        m_slotAllocator.deallocate(m_slots, m_mask + 1);
+    }
+    // returns the token to leave with
+    token_type enter() const
+    {
+        const std::size_t slot = thread_slot() & m_mask;
+        for (;;)
+        {
+            const epoch_type epoch = m_epoch.load(barriers::acquire);
+            const std::size_t parity = epoch & 1;
+            xtomic::quantum<count_type>& count = m_slots[slot].m_count[parity];
+            // the full barrier keeps the check below after the increment
+            ++count;
+            if (m_epoch.load(barriers::acquire) == epoch)
+            {
+                return slot * 2 + parity;
+            }
+            --count;
+        }
+    }
+    void leave(const token_type token) const
+    {
+        m_slots[token / 2].m_count[token % 2].fetch_sub(1, barriers::release);
+    }
+    // the epoch to tag an object that has just become unreachable
+    epoch_type getEpoch() const
+    {
+        thread_fence(barriers::full);
+        return m_epoch.load(barriers::acquire);
+    }
+    // the function never waits, it fails if there are readers of the previous epoch
+    bool tryAdvance()
+    {
+        const epoch_type epoch = m_epoch.load(barriers::acquire);
+        const std::size_t parity = (epoch - 1) & 1;
+        for (std::size_t i = 0; i <= m_mask; ++i)
+        {
+            if (m_slots[i].m_count[parity].load(barriers::acquire))
+            {
+                return false;
+            }
+        }
+        return m_epoch.atomic_cas(epoch, epoch + 1);
+    }
+    // waits until every reader that could see an object unreachable by the moment
+    // of the call has left, the caller must not be in the domain itself
+    void synchronize()
+    {
+        const epoch_type target = getEpoch() + 2;
+        while (m_epoch.load(barriers::acquire) < target)
+        {
+            if (!tryAdvance())
+            {
+                cpu_relax();
+            }
+        }
+    }
+    bool isSafe(const epoch_type retired) const
+    {
+        return retired + 2 <= m_epoch.load(barriers::acquire);
+    }
+private:
+    xtomic::quantum<epoch_type> m_epoch;
+    const std::size_t m_mask;
+    slot_allocator_type m_slotAllocator;
+    slot_type* const m_slots;
+};
+
+// the guard keeps the calling thread in the domain
+class epoch_guard
+{
+public:
+    epoch_guard(const epoch_domain& domain) :
+            m_domain(domain),
+            m_token(domain.enter())
+    {
+
+    }
+    ~epoch_guard()
+    {
+        m_domain.leave(m_token);
+    }
+private:
+    epoch_guard(const epoch_guard&); // = delete;
+    epoch_guard& operator=(const epoch_guard&); // = delete;
+
+private:
+    const epoch_domain& m_domain;
+    const epoch_domain::token_type m_token;
+};
+
+// objects are retired by means of the hook
+struct epoch_hook
+{
+    epoch_hook* m_retiredNext;
+    epoch_domain::epoch_type m_retiredEpoch;
+
+    epoch_hook() :
+            m_retiredNext(nullptr),
+            m_retiredEpoch(0)
+    {
+
+    }
+};
+
+//
+// Retired objects waiting for readers to leave. Node is derived from epoch_hook.
+//
+// Objects are freed in batches: collect() does nothing until Batch objects are
+// retired. Deleter is passed by the owner each time, so the list does not keep
+// pointers to the owner (e.g. to its allocator).
+//
+template<typename Node, std::size_t Batch = 32>
+class epoch_retire_list
+{
+public:
+    typedef Node node_type;
+    typedef epoch_domain::epoch_type epoch_type;
+
+    static const std::size_t BATCH = Batch;
+
+private:
+    epoch_retire_list(const epoch_retire_list&); // = delete;
+    epoch_retire_list& operator=(const epoch_retire_list&); // = delete;
+
+public:
+    epoch_retire_list() :
+            m_first(nullptr),
+            m_count(0),
+            m_collecting(0)
+    {
+
+    }
+    ~epoch_retire_list()
+    {
+        // the owner is expected to call clear()
+    }
+    // node must not be reachable by new readers any more
+    void retire(const epoch_domain& domain, node_type* node)
+    {
+        node->m_retiredEpoch = domain.getEpoch();
+        push(node);
+        ++m_count;
+    }
+    bool empty() const
+    {
+        return !m_first.load(barriers::relaxed);
+    }
+    // frees the nodes no reader can hold, the function never waits for readers
+    template<typename Deleter>
+    void collect(epoch_domain& domain, Deleter& deleter)
+    {
+        if (m_count.load(barriers::relaxed) < BATCH
+                || m_collecting.load(barriers::relaxed)
+                || !m_collecting.atomic_cas(0, 1))
+        {
+            return;
+        }
+        domain.tryAdvance();
+
+        epoch_hook* hook = takeAll();
+        while (hook)
+        {
+            epoch_hook* next = hook->m_retiredNext;
+            if (domain.isSafe(hook->m_retiredEpoch))
+            {
+                --m_count;
+                deleter(static_cast<node_type*>(hook));
+            }
+            else
+            {
+                push(hook);
+            }
+            hook = next;
+        }
+        m_collecting.store(0, barriers::release);
+    }
+    // frees all nodes, nobody may use the container any more
+    template<typename Deleter>
+    void clear(Deleter& deleter)
+    {
+        epoch_hook* hook = takeAll();
+        while (hook)
+        {
+            epoch_hook* next = hook->m_retiredNext;
+            deleter(static_cast<node_type*>(hook));
+            hook = next;
+        }
+        m_count.store(0, barriers::relaxed);
+    }
+private:
+    void push(epoch_hook* hook)
+    {
+        bool res;
+        do
+        {
+            hook->m_retiredNext = m_first.load(barriers::relaxed);
+            res = m_first.atomic_cas(hook->m_retiredNext, hook);
+        }
+        while (!res);
+    }
+    epoch_hook* takeAll()
+    {
+        epoch_hook* hook;
+        do
+        {
+            hook = m_first.load(barriers::acquire);
+        }
+        while (hook && !m_first.atomic_cas(hook, nullptr));
+        return hook;
+    }
+private:
+    xtomic::quantum<epoch_hook*> m_first;
+    xtomic::quantum<std::size_t> m_count;
+    xtomic::quantum<int> m_collecting;
+};
+
+}
+
+#endif /* INCLUDE_EPOCH_HPP_ */
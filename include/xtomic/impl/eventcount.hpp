@@ -0,0 +1,124 @@
+/*
+ * eventcount.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: masha
+ */
+
+#ifndef INCLUDE_EVENTCOUNT_HPP_
+#define INCLUDE_EVENTCOUNT_HPP_
+
+#include <xtomic/quantum.hpp>
+#include <xtomic/aux/cppbasics.hpp>
+#include <xtomic/aux/inttypes.hpp>
+
+#include <climits>
+#include <cerrno>
+#include <ctime>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+namespace xtomic
+{
+
+//
+// Event count: lets a thread sleep until a condition checked by a lock-free
+// predicate becomes true.
+//
+// The waiter:
+//
+//    key = ec.prepare_wait();
+//    if (condition())
+//        ec.cancel_wait();
+//    else
+//        ec.wait(key, timeout);
+//
+// The notifier makes the condition true and calls notify_one() (notify_all()).
+// The notifier does not touch anything but m_waiters unless somebody waits, so
+// there is no syscall when nobody sleeps. The waiter increments m_waiters before
+// it checks the condition and the notifier reads m_waiters after it changes the
+// condition (both sides are separated by full barriers) so either the waiter sees
+// the condition or the notifier sees the waiter. In the latter case the notifier
+// bumps m_epoch and the waiter either does not fall asleep (futex sees the new
+// value) or is waked.
+//
+// m_epoch is used as the futex word.
+//
+class eventcount
+{
+public:
+    typedef xtomic::uint32_t key_type;
+
+private:
+    eventcount(const eventcount&);
+    eventcount& operator=(const eventcount&);
+
+public:
+    eventcount() :
+            m_epoch(0),
+            m_waiters(0)
+    {
+    }
+
+    key_type prepare_wait()
+    {
+        ++m_waiters;
+        return m_epoch.load(barriers::acquire);
+    }
+    void cancel_wait()
+    {
+        --m_waiters;
+    }
+    // timeout is relative, nullptr means infinity.
+    // returns false if the timeout expired
+    bool wait(key_type key, const timespec* timeout)
+    {
+        bool res = true;
+        if (m_epoch.load(barriers::acquire) == key)
+        {
+            res = futex_wait(key, timeout) || errno != ETIMEDOUT;
+        }
+        --m_waiters;
+        return res;
+    }
+    void notify_one()
+    {
+        notify(1);
+    }
+    void notify_all()
+    {
+        notify(INT_MAX);
+    }
+private:
+    void notify(int count)
+    {
+        thread_fence(barriers::full);
+        if (m_waiters.load(barriers::relaxed))
+        {
+            ++m_epoch;
+            futex_wake(count);
+        }
+    }
+    int* futex_word()
+    {
+        return reinterpret_cast<int*>(&m_epoch);
+    }
+    bool futex_wait(key_type key, const timespec* timeout)
+    {
+        return syscall(SYS_futex, futex_word(), FUTEX_WAIT_PRIVATE,
+                static_cast<int>(key), timeout, nullptr, 0) == 0;
+    }
+    void futex_wake(int count)
+    {
+        syscall(SYS_futex, futex_word(), FUTEX_WAKE_PRIVATE, count, nullptr,
+                nullptr, 0);
+    }
+private:
+    xtomic::quantum<key_type> m_epoch;
+    xtomic::quantum<key_type> m_waiters;
+};
+
+}
+
+#endif /* INCLUDE_EVENTCOUNT_HPP_ */
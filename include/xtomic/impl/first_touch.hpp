@@ -0,0 +1,119 @@
+/*
+ * first_touch.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: masha
+ */
+
+#ifndef INCLUDE_FIRST_TOUCH_HPP_
+#define INCLUDE_FIRST_TOUCH_HPP_
+
+#include <xtomic/aux/cppbasics.hpp>
+
+#include <cstddef>
+#include <new>
+#include <pthread.h>
+#include <unistd.h>
+
+namespace xtomic
+{
+
+// The allocator asks containers to construct big arrays of nodes by several
+// threads, see huge_page_allocator.
+template<typename Allocator>
+struct parallel_first_touch
+{
+    static const bool value = false;
+};
+
+// default constructs count nodes, optionally splits the work between threads
+// so page faults (and zeroing of the pages) happen in parallel
+template<typename Node>
+class first_touch
+{
+public:
+    typedef Node node_type;
+    typedef std::size_t size_type;
+
+private:
+    enum
+    {
+        MAX_THREADS = 16,
+        MIN_BYTES_PER_THREAD = 8 * 1024 * 1024,
+    };
+
+    struct task_type
+    {
+        node_type* m_first;
+        size_type m_count;
+    };
+
+public:
+    static void construct(node_type* first, size_type count, bool parallel)
+    {
+        const size_type threads = parallel ? countThreads(count) : 1;
+        if (threads < 2)
+        {
+            constructRange(first, count);
+            return;
+        }
+        task_type tasks[MAX_THREADS];
+        pthread_t ids[MAX_THREADS];
+        bool started[MAX_THREADS];
+        const size_type slice = (count + threads - 1) / threads;
+        for (size_type i = 0; i < threads; ++i)
+        {
+            const size_type offset = i * slice;
+            tasks[i].m_first = first + offset;
+            tasks[i].m_count =
+                    offset + slice < count ? slice : count - offset;
+            // the first slice is left for the calling thread
+            started[i] = i > 0
+                    && pthread_create(&ids[i], nullptr, &run, &tasks[i]) == 0;
+        }
+        for (size_type i = 0; i < threads; ++i)
+        {
+            if (!started[i])
+            {
+                run(&tasks[i]);
+            }
+        }
+        for (size_type i = 1; i < threads; ++i)
+        {
+            if (started[i])
+            {
+                pthread_join(ids[i], nullptr);
+            }
+        }
+    }
+
+private:
+    static size_type countThreads(size_type count)
+    {
+        const long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        size_type threads = count * sizeof(node_type) / MIN_BYTES_PER_THREAD;
+        if (cpus > 0 && threads > static_cast<size_type>(cpus))
+        {
+            threads = static_cast<size_type>(cpus);
+        }
+        const size_type maxThreads = MAX_THREADS;
+        return threads < maxThreads ? threads : maxThreads;
+    }
+    static void constructRange(node_type* first, size_type count)
+    {
+        for (size_type i = 0; i < count; ++i)
+        {
+            ::new (static_cast<void*>(first + i)) node_type();
+        }
+    }
+    static void* run(void* arg)
+    {
+        task_type* task = static_cast<task_type*>(arg);
+        constructRange(task->m_first, task->m_count);
+        return nullptr;
+    }
+};
+
+}
+
+#endif /* INCLUDE_FIRST_TOUCH_HPP_ */
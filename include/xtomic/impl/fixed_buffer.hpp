@@ -58,6 +58,39 @@ public:
         m_base.freeNode(p);
     }
 
+    // Batch operations:
+    //  - reserveNodes() takes up to count free nodes at once, data is not constructed
+    //  - constructData() constructs data in a reserved node
+    //  - destroyData() destroys data, the node stays reserved
+    //  - releaseNodes() returns reserved nodes without data
+    //  - freeNodes() destroys data and returns nodes
+    // chains of nodes are linked by m_next
+    node_type* reserveNodes(size_type& count)
+    {
+        return m_base.popFreeNodes(count);
+    }
+#if XTOMIC_USE_CPP11
+    template<typename ... Args>
+    void constructData(node_type* p, Args&&... data)
+#else
+    void constructData(node_type* p, const value_type& data)
+#endif
+    {
+        m_base.constructData(p, std_forward(Args, data));
+    }
+    void destroyData(node_type* p)
+    {
+        m_base.destroyData(p);
+    }
+    void releaseNodes(node_type* first, node_type* last)
+    {
+        m_base.pushFreeNodes(first, last);
+    }
+    void freeNodes(node_type* first, node_type* last)
+    {
+        m_base.freeNodes(first, last);
+    }
+
     size_type getCapacity() const
     {
         return m_capacity;
@@ -30,6 +30,7 @@ struct align_4_cas16 hash_item
         allocated,  // hash & key & value are valid
     };
 
+    // the full hash of the key, probes compare it before the key itself
     std::size_t m_hash;
 
     // normal life cycle of an item in the hash table is:
@@ -118,7 +119,8 @@ private:
 public:
     hash_node() :
             m_hash(),
-            m_refCount(0)
+            m_refCount(0),
+            m_version(0)
     {
 
     }
@@ -173,12 +175,27 @@ public:
         while (m_refCount.load(barriers::relaxed))
             ;
     }
+    // seqlock of the value: the version is odd while the value is being modified
+    unsigned int getVersion() const
+    {
+        return m_version.load(barriers::acquire);
+    }
+    void beginWrite()
+    {
+        // the full barrier keeps modifications of the value after the increment
+        ++m_version;
+    }
+    void endWrite()
+    {
+        m_version.fetch_add(1, barriers::release);
+    }
 
 private:
     char m_key[sizeof(key_type)] align_as(key_type);
     char m_value[sizeof(mapped_type)] align_as(mapped_type);
     volatile hash_item_type m_hash;
     mutable xtomic::quantum<int> m_refCount;
+    xtomic::quantum<unsigned int> m_version;
 };
 
 }
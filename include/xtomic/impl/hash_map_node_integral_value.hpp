@@ -33,6 +33,17 @@ struct align_4_cas16 mapped_value
     typedef Value value_type;
     typedef typename get_int_by_size<sizeof(value_type)>::type state_type;
 
+private:
+    // the item without the padding up to the alignment, the padding of copies
+    // is not defined so it must not take part in a CAS
+    struct fields
+    {
+        state_type m_state;
+        value_type m_value;
+    };
+
+public:
+
     mapped_value() :
     m_state(unused), m_value(0)
     {
@@ -63,7 +74,10 @@ struct align_4_cas16 mapped_value
     }
     bool atomic_cas(const this_type & expected, const this_type & val)
     {
-        return xtomic::atomic_cas(*this, expected, val);
+        const fields oldFields = { expected.m_state, expected.m_value };
+        const fields newFields = { val.m_state, val.m_value };
+        return xtomic::atomic_cas(*reinterpret_cast<volatile fields*>(this),
+                oldFields, newFields);
     }
     bool atomic_cas(const state_type expected, const state_type val)
     {
@@ -112,6 +126,7 @@ private:
     this_type& operator=(const this_type&); // = delete;
 public:
     hash_node_integral_value() :
+            m_hash(0),
             m_value()
     {
 
@@ -124,6 +139,15 @@ public:
     {
         return reinterpret_cast<const key_type*>(m_key);
     }
+    // the full hash of the key, probes compare it before the key itself
+    hash_type getHash() const
+    {
+        return m_hash;
+    }
+    void setHash(const hash_type hash)
+    {
+        m_hash = hash;
+    }
     value_item_type& getValue()
     {
         return m_value;
@@ -134,6 +158,7 @@ public:
     }
 private:
     char m_key[sizeof(key_type)] align_as(key_type);
+    hash_type m_hash;
     value_item_type m_value;
 };
 
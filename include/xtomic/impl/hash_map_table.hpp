@@ -11,6 +11,7 @@
 #include "hash_map_node.hpp"
 #include "raw_hash_table.hpp"
 #include "ref_lock.hpp"
+#include "xtraits.hpp"
 #include <xtomic/aux/cppbasics.hpp>
 
 #include <utility>
@@ -23,11 +24,11 @@ namespace xtomic
 {
 
 template<typename Key, typename Value, typename Hash, typename Pred,
-        typename Allocator>
+        typename Allocator, indexing::type Indexing = default_indexing::value>
 class hash_map_table
 {
 public:
-    typedef hash_map_table<Key, Value, Hash, Pred, Allocator> this_type;
+    typedef hash_map_table<Key, Value, Hash, Pred, Allocator, Indexing> this_type;
     typedef Key key_type;
     typedef Value mapped_type;
     typedef Hash hash_func_type;
@@ -35,7 +36,7 @@ public:
     typedef Allocator allocator_type;
 
     typedef hash_node<key_type, mapped_type> node_type;
-    typedef hash_data_table<node_type> table_type;
+    typedef hash_data_table<node_type, Indexing> table_type;
     typedef typename table_type::size_type size_type;
     typedef typename allocator_type::template rebind<mapped_type>::other value_allocator_type;
     typedef typename allocator_type::template rebind<key_type>::other key_allocator_type;
@@ -47,6 +48,14 @@ public:
     static constexpr bool INTEGRAL_VALUE = false;
     static constexpr bool INTEGRAL_KEYVALUE = false;
 
+    // find() does not lock nodes with trivially copyable values, it copies the value
+    // and validates the copy by the version of the node, so readers do not write
+    // to the table
+    static constexpr bool OPTIMISTIC_READS =
+            is_trivially_copyable<mapped_type>::value;
+    // probes visit only slots with the tag of the hash
+    static constexpr bool CONTROL_BYTES = table_type::indexing_type::CONTROL_BYTES;
+
 //
 // template<typename CompatibleKey, Key>
 // struct CompatiblePredicate : public binary_function<CompatibleKey, Key, bool>
@@ -89,12 +98,22 @@ public:
                    const key_type & key,
                    mapped_type & value) const
     {
-        const size_type hash = m_hash_func(key);
-
+        return find_impl(raw_table, key, m_hash_func(key), value);
+    }
+    // the hash is hash_impl() of the key computed in advance
+    bool find_impl(const table_type& raw_table,
+                   const key_type & key,
+                   const size_type hash,
+                   mapped_type & value) const
+    {
+        if (CONTROL_BYTES)
+        {
+            return findGrouped(raw_table, key, hash, value);
+        }
         const node_type* table = raw_table.m_table;
         const size_type capacity = raw_table.m_capacity;
 
-        for (size_type i = hash % capacity;; ++i)
+        for (size_type i = raw_table.homeSlot(hash);; ++i)
         {
             if (i == capacity)
             {
@@ -119,34 +138,23 @@ public:
                 }
                 break;
             case hash_item_type::pending2:
-                if (m_eq_func(key, *node.getKey()))
+                if (item.m_hash == hash && m_eq_func(key, *node.getKey()))
                 {
                     // the item is being processed now, there is no reason to wait
                     return false;
                 }
                 break;
             case hash_item_type::touched:
-                if (m_eq_func(key, *node.getKey()))
+                if (item.m_hash == hash && m_eq_func(key, *node.getKey()))
                 {
                     // the item was erased recently
                     return false;
                 }
                 break;
             case hash_item_type::allocated:
-                if (m_eq_func(key, *node.getKey()))
+                if (item.m_hash == hash && m_eq_func(key, *node.getKey()))
                 {
-                    scoped_ref_lock guard(node);
-                    std::size_t state = node.getState();
-                    if (state == hash_item_type::allocated)
-                    {
-                        value = *node.getValue();
-                        return true;
-                    }
-                    else
-                    {
-                        // the item is being updated, there is no reason to wait
-                        return false;
-                    }
+                    return copyValue(node, value);
                 }
                 break;
             default:
@@ -170,12 +178,17 @@ public:
                      const mapped_type &val)
 #endif
     {
+        if (CONTROL_BYTES)
+        {
+            return insertGrouped(raw_table, key, updateIfExists,
+                    std_forward(Args, val));
+        }
         const size_type hash = m_hash_func(key);
 
         node_type* table = raw_table.m_table;
         const size_type capacity = raw_table.m_capacity;
 
-        for (size_type i = hash % capacity;; ++i)
+        for (size_type i = raw_table.homeSlot(hash);; ++i)
         {
             if (i == capacity)
             {
@@ -185,79 +198,29 @@ public:
             node_type& node = table[i];
             const hash_item_type item = node.getHash();
 
-            switch (item.m_state)
-            {
-            case hash_item_type::unused:
+            if (item.m_state == hash_item_type::unused)
             {
                 // the slot is empty so try to use it
                 hash_item_type new_item(hash, hash_item_type::pending);
 
                 if (node.atomic_cas(item, new_item))
                 {
-                    m_value_allocator.construct(node.getValue(),
-                            std_forward(Args, val));
-                    m_key_allocator.construct(node.getKey(), key);
-                    node.setState(hash_item_type::allocated);
-
-                    ++raw_table.m_used;
-                    ++raw_table.m_size;
+                    fillNode(raw_table, node, key, std_forward(Args, val));
                     return true;
                 }
                 // the slot has been updated by other thread so we have to start all over again
                 continue;
             }
-            case hash_item_type::pending:
-                if (item.m_hash == hash)
-                {
-                    // the first insert is in progress
-                    // cannot continue until it is finished
-                    // so start all over again
-                    continue;
-                }
-                break;
-            case hash_item_type::pending2:
-            case hash_item_type::allocated:
-                if (m_eq_func(key, *node.getKey()))
-                {
-                    if ( !updateIfExists )
-                    {
-                        // the item is allocated or concurrent insert/delete operation is in progress
-                        return false;
-                    }
-                    hash_item_type new_item(hash, hash_item_type::pending);
-
-                    if (node.atomic_cas(item, new_item))
-                    {
-                        m_value_allocator.destroy(node.getValue());
-                        m_value_allocator.construct(node.getValue(),
-                                std_forward(Args, val));
-                        node.setState(hash_item_type::allocated);
-                        return true;
-                    }
-                    // the slot has been updated by other thread so we have to start all over again
-                    continue;
-                }
-                break;
-            case hash_item_type::touched:
-                if (m_eq_func(key, *node.getKey()))
-                {
-                    hash_item_type new_item(hash, hash_item_type::pending2);
-
-                    if (node.atomic_cas(item, new_item))
-                    {
-                        m_value_allocator.construct(node.getValue(),
-                                std_forward(Args, val));
-                        node.setState(hash_item_type::allocated);
-                        ++raw_table.m_size;
-                        return true;
-                    }
-                    // the slot has been updated by other thread
-                    // so at least one concurrent insert operation took place
-                    return false;
-                }
-                break;
+            switch (insertAt(raw_table, node, item, hash, key, updateIfExists,
+                    std_forward(Args, val)))
+            {
+            case insert_done:
+                return true;
+            case insert_failed:
+                return false;
             default:
-                assert(false);
+                // the slot is taken by other key or has been updated by other thread
+                break;
             }
         }
         return false;
@@ -265,12 +228,16 @@ public:
 
     bool erase_impl(table_type& raw_table, const key_type & key)
     {
+        if (CONTROL_BYTES)
+        {
+            return eraseGrouped(raw_table, key);
+        }
         const size_type hash = m_hash_func(key);
 
         node_type* table = raw_table.m_table;
         const size_type capacity = raw_table.m_capacity;
 
-        for (size_type i = hash % capacity;; ++i)
+        for (size_type i = raw_table.homeSlot(hash);; ++i)
         {
             if (i == capacity)
             {
@@ -295,47 +262,508 @@ public:
                 }
                 break;
             case hash_item_type::pending2:
-                if (m_eq_func(key, *node.getKey()))
+                if (item.m_hash == hash && m_eq_func(key, *node.getKey()))
                 {
                     // the item is being processed now, there is no reason to wait
                     return false;
                 }
                 break;
             case hash_item_type::touched:
-                if (m_eq_func(key, *node.getKey()))
+                if (item.m_hash == hash && m_eq_func(key, *node.getKey()))
                 {
                     // the item was erased recently
                     return false;
                 }
                 break;
             case hash_item_type::allocated:
-                if (m_eq_func(key, *node.getKey()))
+                if (item.m_hash == hash && m_eq_func(key, *node.getKey()))
                 {
-                    // reset readiness
-                    hash_item_type new_item(hash, hash_item_type::pending2);
+                    return eraseAt(raw_table, node, item);
+                }
+                break;
+            default:
+                assert(false);
+            }
+        }
+
+        return false;
+    }
+
+    // applies func to the value of the key in place, the node is taken as by
+    // an update of insert_impl(), other writers of the key wait for it
+    template<typename Functor>
+    bool update_impl(table_type& raw_table,
+                     const key_type & key,
+                     Functor & func)
+    {
+        if (CONTROL_BYTES)
+        {
+            return updateGrouped(raw_table, key, func);
+        }
+        const size_type hash = m_hash_func(key);
+
+        node_type* table = raw_table.m_table;
+        const size_type capacity = raw_table.m_capacity;
 
-                    if (node.atomic_cas(item, new_item))
+        for (size_type i = raw_table.homeSlot(hash);; ++i)
+        {
+            if (i == capacity)
+            {
+                i = 0;
+            }
+
+            node_type& node = table[i];
+            hash_item_type item = node.getHash();
+
+            if (item.m_state == hash_item_type::unused)
+            {
+                // the search finished
+                return false;
+            }
+            insert_result res;
+            while ((res = updateAt(node, item, hash, key, func)) == insert_retry)
+            {
+                // the item is being modified by other thread
+                cpu_relax();
+                item = node.getHash();
+            }
+            if (res != insert_next)
+            {
+                return res == insert_done;
+            }
+        }
+        return false;
+    }
+
+    // find_impl() over control bytes
+    bool findGrouped(const table_type& raw_table,
+                     const key_type & key,
+                     const size_type hash,
+                     mapped_type & value) const
+    {
+        control_probe<table_type> probe(raw_table, hash);
+
+        for (size_type i; probe.next(i);)
+        {
+            const node_type& node = raw_table.m_table[i];
+            const hash_item_type item = waitForHash(node);
+
+            // the key of a pending item is being constructed
+            if (item.m_state == hash_item_type::pending || item.m_hash != hash
+                    || !m_eq_func(key, *node.getKey()))
+            {
+                continue;
+            }
+            if (item.m_state == hash_item_type::allocated)
+            {
+                return copyValue(node, value);
+            }
+            // the item is being processed now or was erased recently
+            return false;
+        }
+        return false;
+    }
+
+#if XTOMIC_USE_CPP11
+    // insert_impl() over control bytes
+    template<typename ... Args>
+    bool insertGrouped(table_type& raw_table,
+                       const key_type & key,
+                       const bool updateIfExists,
+                       Args&&... val)
+#else
+    bool insertGrouped(table_type& raw_table,
+                       const key_type & key,
+                       const bool updateIfExists,
+                       const mapped_type &val)
+#endif
+    {
+        const size_type hash = m_hash_func(key);
+
+        for (;;)
+        {
+            control_probe<table_type> probe(raw_table, hash);
+            insert_result res = insert_next;
+            size_type i;
+
+            while (res == insert_next && probe.next(i))
+            {
+                node_type& node = raw_table.m_table[i];
+                const hash_item_type item = node.getHash();
+
+                // a claimed slot is unused until its insert publishes the hash
+                res = item.m_state == hash_item_type::unused ?
+                        insert_retry :
+                        insertAt(raw_table, node, item, hash, key,
+                                updateIfExists, std_forward(Args, val));
+            }
+            if (res == insert_done)
+            {
+                return true;
+            }
+            if (res == insert_failed)
+            {
+                return false;
+            }
+            if (res == insert_retry)
+            {
+                // an insert into the probing sequence is in progress
+                cpu_relax();
+                continue;
+            }
+            // the key is not in the table, claim the first empty slot
+            i = probe.emptySlot();
+            if (!control_claim(raw_table.m_control, i, hash))
+            {
+                // other thread has taken the slot so start all over again
+                continue;
+            }
+            // nobody else changes the node of a claimed slot
+            node_type& node = raw_table.m_table[i];
+            node.atomic_cas(hash_item_type(),
+                    hash_item_type(hash, hash_item_type::pending));
+            fillNode(raw_table, node, key, std_forward(Args, val));
+            return true;
+        }
+    }
+
+    // erase_impl() over control bytes
+    bool eraseGrouped(table_type& raw_table, const key_type & key)
+    {
+        const size_type hash = m_hash_func(key);
+        control_probe<table_type> probe(raw_table, hash);
+
+        for (size_type i; probe.next(i);)
+        {
+            node_type& node = raw_table.m_table[i];
+            const hash_item_type item = waitForHash(node);
+
+            // the key of a pending item is being constructed
+            if (item.m_state == hash_item_type::pending || item.m_hash != hash
+                    || !m_eq_func(key, *node.getKey()))
+            {
+                continue;
+            }
+            if (item.m_state == hash_item_type::allocated)
+            {
+                return eraseAt(raw_table, node, item);
+            }
+            // the item is being processed now or was erased recently
+            return false;
+        }
+        return false;
+    }
+
+    // update_impl() over control bytes
+    template<typename Functor>
+    bool updateGrouped(table_type& raw_table,
+                       const key_type & key,
+                       Functor & func)
+    {
+        const size_type hash = m_hash_func(key);
+        control_probe<table_type> probe(raw_table, hash);
+
+        for (size_type i; probe.next(i);)
+        {
+            node_type& node = raw_table.m_table[i];
+            insert_result res;
+            while ((res = updateAt(node, waitForHash(node), hash, key, func))
+                    == insert_retry)
+            {
+                // the item is being modified by other thread
+                cpu_relax();
+            }
+            if (res != insert_next)
+            {
+                return res == insert_done;
+            }
+        }
+        return false;
+    }
+
+    // outcome of an insert into a slot that holds a hash
+    enum insert_result
+    {
+        insert_next,    // the slot belongs to other key
+        insert_retry,   // the slot is being modified by other thread
+        insert_done,    // the item is inserted or updated
+        insert_failed,  // the key is in the table or is being processed now
+    };
+
+#if XTOMIC_USE_CPP11
+    template<typename ... Args>
+    insert_result insertAt(table_type& raw_table,
+                           node_type& node,
+                           const hash_item_type& item,
+                           const size_type hash,
+                           const key_type & key,
+                           const bool updateIfExists,
+                           Args&&... val)
+#else
+    insert_result insertAt(table_type& raw_table,
+                           node_type& node,
+                           const hash_item_type& item,
+                           const size_type hash,
+                           const key_type & key,
+                           const bool updateIfExists,
+                           const mapped_type &val)
+#endif
+    {
+        switch (item.m_state)
+        {
+        case hash_item_type::pending:
+            if (item.m_hash == hash)
+            {
+                // the first insert is in progress
+                // cannot continue until it is finished
+                return insert_retry;
+            }
+            break;
+        case hash_item_type::pending2:
+        case hash_item_type::allocated:
+            if (item.m_hash == hash && m_eq_func(key, *node.getKey()))
+            {
+                if ( !updateIfExists )
+                {
+                    // the item is allocated or concurrent insert/delete operation is in progress
+                    return insert_failed;
+                }
+                hash_item_type new_item(hash, hash_item_type::pending);
+
+                if (node.atomic_cas(item, new_item))
+                {
+                    // wait for pending finds
+                    node.waitForRelease();
+                    node.beginWrite();
+                    m_value_allocator.destroy(node.getValue());
+                    try
                     {
-                        // wait for pending finds
-                        node.waitForRelease();
-                        // destroy the node
-                        m_value_allocator.destroy(node.getValue());
+                        m_value_allocator.construct(node.getValue(),
+                                std_forward(Args, val));
+                    }
+                    catch (...)
+                    {
+                        // the old value is gone, the item is erased
+                        node.endWrite();
                         node.setState(hash_item_type::touched);
                         --raw_table.m_size;
-                        return true;
+                        throw;
                     }
-                    // the item found but it is being erased in an other thread;
-                    return false;
+                    node.endWrite();
+                    node.setState(hash_item_type::allocated);
+                    return insert_done;
                 }
-                break;
-            default:
-                assert(false);
+                // the slot has been updated by other thread
+                return insert_retry;
+            }
+            break;
+        case hash_item_type::touched:
+            if (item.m_hash == hash && m_eq_func(key, *node.getKey()))
+            {
+                hash_item_type new_item(hash, hash_item_type::pending2);
+
+                if (node.atomic_cas(item, new_item))
+                {
+                    node.beginWrite();
+                    try
+                    {
+                        m_value_allocator.construct(node.getValue(),
+                                std_forward(Args, val));
+                    }
+                    catch (...)
+                    {
+                        node.endWrite();
+                        node.setState(hash_item_type::touched);
+                        throw;
+                    }
+                    node.endWrite();
+                    node.setState(hash_item_type::allocated);
+                    ++raw_table.m_size;
+                    return insert_done;
+                }
+                // the slot has been updated by other thread
+                // so at least one concurrent insert operation took place
+                return insert_failed;
             }
+            break;
+        default:
+            assert(false);
         }
+        return insert_next;
+    }
 
+    // fills the node of an unused slot taken by the thread; if the value cannot
+    // be constructed the key stays in the slot as erased, probes go on past it
+#if XTOMIC_USE_CPP11
+    template<typename ... Args>
+    void fillNode(table_type& raw_table,
+                  node_type& node,
+                  const key_type & key,
+                  Args&&... val)
+#else
+    void fillNode(table_type& raw_table,
+                  node_type& node,
+                  const key_type & key,
+                  const mapped_type &val)
+#endif
+    {
+        m_key_allocator.construct(node.getKey(), key);
+        ++raw_table.m_used;
+        try
+        {
+            m_value_allocator.construct(node.getValue(),
+                    std_forward(Args, val));
+        }
+        catch (...)
+        {
+            node.setState(hash_item_type::touched);
+            throw;
+        }
+        node.setState(hash_item_type::allocated);
+        ++raw_table.m_size;
+    }
+
+    // erases the allocated item of the key
+    bool eraseAt(table_type& raw_table,
+                 node_type& node,
+                 const hash_item_type& item)
+    {
+        // reset readiness
+        hash_item_type new_item(item.m_hash, hash_item_type::pending2);
+
+        if (node.atomic_cas(item, new_item))
+        {
+            // wait for pending finds
+            node.waitForRelease();
+            // destroy the node
+            node.beginWrite();
+            m_value_allocator.destroy(node.getValue());
+            node.endWrite();
+            node.setState(hash_item_type::touched);
+            --raw_table.m_size;
+            return true;
+        }
+        // the item found but it is being erased in an other thread;
+        return false;
+    }
+
+    // updates the allocated item of the key in place
+    template<typename Functor>
+    insert_result updateAt(node_type& node,
+                           const hash_item_type& item,
+                           const size_type hash,
+                           const key_type & key,
+                           Functor & func)
+    {
+        if (item.m_hash != hash)
+        {
+            return insert_next;
+        }
+        switch (item.m_state)
+        {
+        case hash_item_type::pending:
+            // an insert or an update is in progress, the key may be not constructed yet
+            return insert_retry;
+        case hash_item_type::pending2:
+            if (m_eq_func(key, *node.getKey()))
+            {
+                // the item is being erased or inserted again
+                return insert_retry;
+            }
+            break;
+        case hash_item_type::touched:
+            if (m_eq_func(key, *node.getKey()))
+            {
+                // the item was erased recently
+                return insert_failed;
+            }
+            break;
+        case hash_item_type::allocated:
+            if (m_eq_func(key, *node.getKey()))
+            {
+                hash_item_type new_item(hash, hash_item_type::pending);
+
+                if (!node.atomic_cas(item, new_item))
+                {
+                    // the slot has been updated by other thread
+                    return insert_retry;
+                }
+                // wait for pending finds
+                node.waitForRelease();
+                node.beginWrite();
+                try
+                {
+                    func(*node.getValue());
+                }
+                catch (...)
+                {
+                    node.endWrite();
+                    node.setState(hash_item_type::allocated);
+                    throw;
+                }
+                node.endWrite();
+                node.setState(hash_item_type::allocated);
+                return insert_done;
+            }
+            break;
+        default:
+            assert(false);
+        }
+        return insert_next;
+    }
+
+    // copies the value of the allocated item
+    bool copyValue(const node_type& node, mapped_type & value) const
+    {
+        if (OPTIMISTIC_READS)
+        {
+            return readValue(node, value);
+        }
+        scoped_ref_lock guard(node);
+        std::size_t state = node.getState();
+        if (state == hash_item_type::allocated)
+        {
+            value = *node.getValue();
+            return true;
+        }
+        // the item is being updated, there is no reason to wait
         return false;
     }
 
+    // a slot claimed by its control byte is unused until the insert
+    // publishes the hash
+    static hash_item_type waitForHash(const node_type& node)
+    {
+        hash_item_type item = node.getHash();
+        while (item.m_state == hash_item_type::unused)
+        {
+            cpu_relax();
+            item = node.getHash();
+        }
+        return item;
+    }
+
+    // seqlock read of the value, the function does not write to the node
+    bool readValue(const node_type& node, mapped_type & value) const
+    {
+        for (;;)
+        {
+            const unsigned int version = node.getVersion();
+            if ((version & 1) || node.getState() != hash_item_type::allocated)
+            {
+                // the item is being updated, there is no reason to wait
+                return false;
+            }
+            const mapped_type copy(*node.getValue());
+            thread_fence(barriers::acquire);
+            if (node.getVersion() == version)
+            {
+                value = copy;
+                return true;
+            }
+            // the value has been modified while it was being copied
+        }
+    }
     void destroyNode_impl(node_type & node)
     {
         hash_item_type item = node.getHash();
@@ -369,6 +797,44 @@ public:
             }
         }
     }
+    size_type hash_impl(const key_type & key) const
+    {
+        return m_hash_func(key);
+    }
+    // incremental form of rehash_impl()
+    // the function copies items with home slot in [first, last), it assumes:
+    //    * nobody modifies src
+    //    * the items are not in dst yet, other items of dst may be modified concurrently
+    size_type migrate_impl(const table_type& src,
+                           const size_type first,
+                           const size_type last,
+                           table_type& dst)
+    {
+        const size_type capacity = src.m_capacity;
+        size_type count = 0;
+
+        // an item may be placed beyond the range but not beyond an unused slot
+        for (size_type n = first; n < first + capacity; ++n)
+        {
+            node_type& node = src.m_table[n < capacity ? n : n - capacity];
+            const hash_item_type item = node.getHash();
+
+            if (item.m_state == hash_item_type::unused)
+            {
+                if (n >= last)
+                {
+                    break;
+                }
+            }
+            else if (item.m_state == hash_item_type::allocated
+                    && is_home_slot(src, item.m_hash, first, last))
+            {
+                insert_impl(dst, *node.getKey(), false, *node.getValue());
+                ++count;
+            }
+        }
+        return count;
+    }
     // simplified form of insert()
     // the function assumes:
     //    * exclusive access to the container
@@ -381,7 +847,7 @@ public:
     {
         const size_type capacity = dst.m_capacity;
 
-        for (size_type i = hash % capacity;; ++i)
+        for (size_type i = dst.homeSlot(hash);; ++i)
         {
             if (i == capacity)
             {
@@ -391,6 +857,10 @@ public:
             hash_item_type item = node.getHash();
             if (item.m_state == hash_item_type::unused)
             {
+                if (CONTROL_BYTES)
+                {
+                    control_claim(dst.m_control, i, hash);
+                }
                 node.setItem(hash, hash_item_type::allocated);
 
                 m_key_allocator.construct(node.getKey(), key);
@@ -10,9 +10,14 @@
 
 #include "hash_table_base.hpp"
 #include <xtomic/aux/cppbasics.hpp>
+#include <xtomic/aux/inttypes.hpp>
 
+#include <algorithm>
+#include <exception>
+#include <iterator>
 #include <vector>
 #include <utility>
+#include <pthread.h>
 
 namespace xtomic
 {
@@ -42,6 +47,40 @@ private:
     typedef typename base_type::insert_guard_type insert_guard_type;
     typedef typename base_type::scoped_reserver_type scoped_reserver_type;
 
+    // looks up a key of the batch in the table lookupBatch() has chosen for it
+    struct batch_finder
+    {
+        const hash_table_type& m_hashTable;
+        const key_type* m_keys;
+        mapped_type* m_values;
+        uint64_t* m_found;
+        size_type m_count;
+
+        void operator()(const table_type& table,
+                        const size_type i,
+                        const size_type hash)
+        {
+            if (m_hashTable.find_impl(table, m_keys[i], hash, m_values[i]))
+            {
+                m_found[i / 64] |= static_cast<uint64_t>(1) << (i % 64);
+                ++m_count;
+            }
+        }
+    };
+
+    // adds the delta to the value and keeps the value it had
+    struct value_adder
+    {
+        const mapped_type& m_delta;
+        mapped_type m_prev;
+
+        void operator()(mapped_type& value)
+        {
+            m_prev = value;
+            value += m_delta;
+        }
+    };
+
 public:
     hash_map_table_base(hash_table_type & hashTable, size_type reserve) :
             base_type(hashTable, reserve)
@@ -53,7 +92,20 @@ public:
         const table_type* ptr;
         const_guard_type guard(base_type::getBase(), ptr);
 
-        return base_type::m_hashTable.find_impl(*ptr, key, value);
+        return base_type::m_hashTable.find_impl(
+                *base_type::lookupTable(ptr, key), key, value);
+    }
+    size_type findBatch(const key_type* keys,
+                        const size_type count,
+                        mapped_type* values,
+                        uint64_t* foundMask) const
+    {
+        std::fill(foundMask, foundMask + (count + 63) / 64, 0);
+
+        batch_finder finder = { base_type::m_hashTable, keys, values,
+                foundMask, 0 };
+        base_type::lookupBatch(keys, count, finder);
+        return finder.m_count;
     }
 #if XTOMIC_USE_CPP11
     template<typename ... Args>
@@ -70,15 +122,284 @@ public:
         table_type* ptr;
         mutable_guard_type guard(base_type::getBase(), ptr);
 
-        return base_type::m_hashTable.insert_impl(*ptr, key, updateIfExists,
+        return base_type::m_hashTable.insert_impl(
+                *base_type::updateTable(ptr, key), key, updateIfExists,
                 std_forward(Args, val));
     }
+    // inserts the value unless the key is in the table, value receives the
+    // value of the key then
+    bool findOrInsert(const key_type & key, mapped_type & value)
+    {
+        // a round fails only if other threads insert and erase the key meanwhile
+        // or modify its value
+        while (!find(key, value))
+        {
+            if (insert(key, false, value))
+            {
+                return true;
+            }
+            cpu_relax();
+        }
+        return false;
+    }
+    template<typename Functor>
+    bool update(const key_type & key, Functor & func)
+    {
+        table_type* ptr;
+        mutable_guard_type guard(base_type::getBase(), ptr);
+
+        return base_type::m_hashTable.update_impl(
+                *base_type::updateTable(ptr, key), key, func);
+    }
+    // a missing key is inserted with the delta as if its value was mapped_type()
+    mapped_type fetchAdd(const key_type & key, const mapped_type & delta)
+    {
+        value_adder adder = { delta, mapped_type() };
+        for (;;)
+        {
+            if (update(key, adder))
+            {
+                return adder.m_prev;
+            }
+            if (insert(key, false, delta))
+            {
+                return mapped_type();
+            }
+            // other thread has inserted the key meanwhile
+        }
+    }
+
+    //
+    // Bulk inserts.
+    //
+    // All items of a range are reserved as concurrent inserts at once, so the
+    // table grows straight to the capacity for all of them instead of doubling
+    // on the way. The items are sorted by their home slots in that table (a counting
+    // sort by partitions of BULK_PARTITION slots) and inserted in that order, so the
+    // inserts sweep the table instead of jumping around it. A writer takes the
+    // table once per BULK_BLOCK items, a resize started by other thread waits for
+    // a block and not for the whole range.
+    //
+    // The sorted items may be split between threads. A thread takes whole
+    // partitions, so equal keys are inserted by one thread in the order of the
+    // range and the first of them wins. An exception of a thread is kept until
+    // all threads are joined, then the first one is rethrown; the other threads
+    // insert their items anyway. Before c++11 an exception cannot be passed to
+    // other thread, so the calling thread inserts all items.
+    //
+    template<typename Iterator>
+    size_type insertRange(Iterator first,
+                          Iterator last,
+                          const unsigned int threads)
+    {
+        const size_type count = std::distance(first, last);
+        if (!count)
+        {
+            return 0;
+        }
+        base_type::reserveInserts(count);
+
+        std::vector<Iterator> items;
+        std::vector<size_type> homes;
+        try
+        {
+            sortByHomeSlot(first, count, items, homes);
+        }
+        catch (...)
+        {
+            base_type::releaseInserts(count);
+            throw;
+        }
+
+        range_task<Iterator> tasks[MAX_BULK_THREADS];
+        pthread_t ids[MAX_BULK_THREADS];
+        bool started[MAX_BULK_THREADS];
+#if XTOMIC_USE_CPP11
+        const size_type maxTasks = MAX_BULK_THREADS;
+#else // XTOMIC_USE_CPP11
+        // exceptions of other threads cannot be rethrown
+        const size_type maxTasks = 1;
+#endif // XTOMIC_USE_CPP11
+        const size_type taskCount = std::max(
+                std::min(static_cast<size_type>(threads),
+                        std::min(count / BULK_BLOCK, maxTasks)),
+                static_cast<size_type>(1));
+        size_type offset = 0;
+        for (size_type i = 0; i < taskCount; ++i)
+        {
+            size_type end = i + 1 == taskCount ?
+                    count : std::max(offset, count * (i + 1) / taskCount);
+            // equal keys are in the same partition and go to the same task
+            while (end < count && end > 0
+                    && homes[end] / BULK_PARTITION
+                            == homes[end - 1] / BULK_PARTITION)
+            {
+                ++end;
+            }
+            tasks[i].m_base = this;
+            tasks[i].m_items = &items[0] + offset;
+            tasks[i].m_count = end - offset;
+            tasks[i].m_inserted = 0;
+            offset = end;
+            // the first task is left for the calling thread
+            started[i] = i > 0
+                    && pthread_create(&ids[i], nullptr,
+                            &range_task<Iterator>::run, &tasks[i]) == 0;
+        }
+        for (size_type i = 0; i < taskCount; ++i)
+        {
+            if (!started[i])
+            {
+                tasks[i].execute();
+            }
+        }
+        size_type inserted = 0;
+        for (size_type i = 0; i < taskCount; ++i)
+        {
+            if (started[i])
+            {
+                pthread_join(ids[i], nullptr);
+            }
+            inserted += tasks[i].m_inserted;
+        }
+#if XTOMIC_USE_CPP11
+        for (size_type i = 0; i < taskCount; ++i)
+        {
+            if (tasks[i].m_error)
+            {
+                std::rethrow_exception(tasks[i].m_error);
+            }
+        }
+#endif // XTOMIC_USE_CPP11
+        return inserted;
+    }
+
+private:
+    enum
+    {
+        BULK_PARTITION = 1024,  // home slots sorted as one
+        BULK_BLOCK = 4096,      // items inserted under one guard
+        MAX_BULK_THREADS = 16,
+    };
+
+    template<typename Iterator>
+    struct range_task
+    {
+        this_type* m_base;
+        const Iterator* m_items;
+        size_type m_count;
+        size_type m_inserted;
+#if XTOMIC_USE_CPP11
+        std::exception_ptr m_error;
+#endif // XTOMIC_USE_CPP11
+
+        void execute()
+        {
+#if XTOMIC_USE_CPP11
+            try
+            {
+                m_inserted = m_base->insertItems(m_items, m_count);
+            }
+            catch (...)
+            {
+                m_error = std::current_exception();
+            }
+#else // XTOMIC_USE_CPP11
+            m_inserted = m_base->insertItems(m_items, m_count);
+#endif // XTOMIC_USE_CPP11
+        }
+        static void* run(void* arg)
+        {
+            static_cast<range_task*>(arg)->execute();
+            return nullptr;
+        }
+    };
+
+    // items receives the iterators ordered by partitions of home slots (in the
+    // order of the range within a partition), homes receives their home slots
+    template<typename Iterator>
+    void sortByHomeSlot(Iterator first,
+                        const size_type count,
+                        std::vector<Iterator>& items,
+                        std::vector<size_type>& homes) const
+    {
+        std::vector<size_type> unsorted(count);
+        size_type partitions;
+        {
+            const table_type* ptr;
+            const_guard_type guard(base_type::getBase(), ptr);
+            const table_type& table = *base_type::lastTable(ptr);
+
+            Iterator i = first;
+            for (size_type n = 0; n < count; ++n, ++i)
+            {
+                unsorted[n] = table.homeSlot(
+                        base_type::m_hashTable.hash_impl(i->first));
+            }
+            partitions = table.m_capacity / BULK_PARTITION + 1;
+        }
+
+        std::vector<size_type> offsets(partitions + 1, 0);
+        for (size_type n = 0; n < count; ++n)
+        {
+            ++offsets[unsorted[n] / BULK_PARTITION + 1];
+        }
+        for (size_type p = 0; p < partitions; ++p)
+        {
+            offsets[p + 1] += offsets[p];
+        }
+        items.resize(count, first);
+        homes.resize(count);
+        Iterator i = first;
+        for (size_type n = 0; n < count; ++n, ++i)
+        {
+            const size_type pos = offsets[unsorted[n] / BULK_PARTITION]++;
+            items[pos] = i;
+            homes[pos] = unsorted[n];
+        }
+    }
+    // inserts the items and releases their reservations
+    template<typename Iterator>
+    size_type insertItems(const Iterator* items, const size_type count)
+    {
+        size_type inserted = 0;
+        size_type done = 0;
+        try
+        {
+            while (done < count)
+            {
+                const size_type end = std::min(done + BULK_BLOCK, count);
+                base_type::checkWatermark();
+
+                table_type* ptr;
+                mutable_guard_type guard(base_type::getBase(), ptr);
+                for (; done < end; ++done)
+                {
+                    const Iterator& item = items[done];
+                    if (base_type::m_hashTable.insert_impl(
+                            *base_type::updateTable(ptr, item->first),
+                            item->first, false, item->second))
+                    {
+                        ++inserted;
+                    }
+                    base_type::releaseInserts(1);
+                }
+            }
+        }
+        catch (...)
+        {
+            base_type::releaseInserts(count - done);
+            throw;
+        }
+        return inserted;
+    }
 };
 
-template<typename HashTable, bool greedy>
+template<typename HashTable, bool greedy,
+        rehashing::type Rehashing = default_rehashing::value>
 struct get_hash_map_table_base_type
 {
-    typedef typename get_hash_table_base_type<HashTable, greedy>::type base_type;
+    typedef typename get_hash_table_base_type<HashTable, greedy, Rehashing>::type base_type;
     typedef hash_map_table_base<base_type> type;
 };
 
@@ -10,6 +10,7 @@
 
 #include "hash_map_node_integral_key.hpp"
 #include "hash_table_base.hpp"
+#include "raw_hash_table.hpp"
 #include "ref_lock.hpp"
 #include "ref_ptr.hpp"
 #include <xtomic/aux/cppbasics.hpp>
@@ -24,11 +25,11 @@ namespace xtomic
 {
 
 template<typename Key, typename Value, typename Hash, typename Pred,
-        typename Allocator>
+        typename Allocator, indexing::type Indexing = default_indexing::value>
 class hash_map_table_integral_key
 {
 public:
-    typedef hash_map_table_integral_key<Key, Value, Hash, Pred, Allocator> this_type;
+    typedef hash_map_table_integral_key<Key, Value, Hash, Pred, Allocator, Indexing> this_type;
 
     typedef Key key_type;
     typedef Value mapped_type;
@@ -37,7 +38,7 @@ public:
     typedef Allocator allocator_type;
 
     typedef hash_node_integral_key<key_type, mapped_type> node_type;
-    typedef hash_data_table<node_type> table_type;
+    typedef hash_data_table<node_type, Indexing> table_type;
     typedef typename table_type::size_type size_type;
     typedef typename allocator_type::template rebind<mapped_type>::other value_allocator_type;
 
@@ -47,6 +48,8 @@ public:
     static constexpr bool INTEGRAL_KEY = true;
     static constexpr bool INTEGRAL_VALUE = false;
     static constexpr bool INTEGRAL_KEYVALUE = false;
+    // keys are compared in place, control bytes would not save anything
+    static constexpr bool CONTROL_BYTES = false;
 
 private:
 
@@ -86,12 +89,18 @@ public:
                    const key_type key,
                    mapped_type & value) const
     {
-        const std::size_t hash = m_hash_func(key);
-
+        return find_impl(raw_table, key, m_hash_func(key), value);
+    }
+    // the hash is hash_impl() of the key computed in advance
+    bool find_impl(const table_type& raw_table,
+                   const key_type key,
+                   const size_type hash,
+                   mapped_type & value) const
+    {
         const node_type* table = raw_table.m_table;
         const size_type capacity = raw_table.m_capacity;
 
-        for (size_type i = hash % capacity;;)
+        for (size_type i = raw_table.homeSlot(hash);;)
         {
             const node_type& node = table[i];
             const key_item_type item = node.getKey();
@@ -161,7 +170,7 @@ public:
         node_type* table = raw_table.m_table;
         const size_type capacity = raw_table.m_capacity;
 
-        for (size_type i = hash % capacity;;)
+        for (size_type i = raw_table.homeSlot(hash);;)
         {
             node_type& node = table[i];
             const key_item_type item = node.getKey();
@@ -175,10 +184,8 @@ public:
 
                 if (node.atomic_cas(item, new_item))
                 {
-                    m_value_allocator.construct(node.getValue(),
-                            std_forward(Args, val));
-                    node.setState(key_item_type::allocated);
                     ++raw_table.m_used;
+                    constructValue(node, std_forward(Args, val));
                     ++raw_table.m_size;
                     return true;
                 }
@@ -207,9 +214,16 @@ public:
                     if (node.atomic_cas(item, new_item))
                     {
                         m_value_allocator.destroy(node.getValue());
-                        m_value_allocator.construct(node.getValue(),
-                                std_forward(Args, val));
-                        node.setState(key_item_type::allocated);
+                        try
+                        {
+                            constructValue(node, std_forward(Args, val));
+                        }
+                        catch (...)
+                        {
+                            // the old value is gone, the item is erased
+                            --raw_table.m_size;
+                            throw;
+                        }
                         return true;
                     }
                     continue;
@@ -222,9 +236,7 @@ public:
 
                     if (node.atomic_cas(item, new_item))
                     {
-                        m_value_allocator.construct(node.getValue(),
-                                std_forward(Args, val));
-                        node.setState(key_item_type::allocated);
+                        constructValue(node, std_forward(Args, val));
                         ++raw_table.m_size;
                         return true;
                     }
@@ -252,7 +264,7 @@ public:
         node_type* table = raw_table.m_table;
         const size_type capacity = raw_table.m_capacity;
 
-        for (size_type i = hash % capacity;;)
+        for (size_type i = raw_table.homeSlot(hash);;)
         {
             node_type& node = table[i];
             const key_item_type item = node.getKey();
@@ -306,6 +318,77 @@ public:
         }
         return false;
     }
+    // applies func to the value of the key in place, the node is taken as by
+    // an update of insert_impl(), other writers of the key wait for it
+    template<typename Functor>
+    bool update_impl(table_type& raw_table,
+                     const key_type key,
+                     Functor & func)
+    {
+        const std::size_t hash = m_hash_func(key);
+
+        node_type* table = raw_table.m_table;
+        const size_type capacity = raw_table.m_capacity;
+
+        for (size_type i = raw_table.homeSlot(hash);;)
+        {
+            node_type& node = table[i];
+            const key_item_type item = node.getKey();
+
+            switch (item.m_state)
+            {
+            case key_item_type::unused:
+                // the search finished
+                return false;
+            case key_item_type::pending:
+                if (m_eq_func(key, item.m_key))
+                {
+                    // the item is being processed now, probe the slot again
+                    cpu_relax();
+                    continue;
+                }
+                break;
+            case key_item_type::touched:
+                if (m_eq_func(key, item.m_key))
+                {
+                    // the item was erased recently
+                    return false;
+                }
+                break;
+            case key_item_type::allocated:
+                if (m_eq_func(key, item.m_key))
+                {
+                    key_item_type new_item(key, key_item_type::pending);
+
+                    if (node.atomic_cas(item, new_item))
+                    {
+                        // wait for pending finds
+                        node.waitForRelease();
+                        try
+                        {
+                            func(*node.getValue());
+                        }
+                        catch (...)
+                        {
+                            node.setState(key_item_type::allocated);
+                            throw;
+                        }
+                        node.setState(key_item_type::allocated);
+                        return true;
+                    }
+                    continue;
+                }
+                break;
+            default:
+                assert(false);
+            }
+            if (++i == capacity)
+            {
+                i = 0;
+            }
+        }
+        return false;
+    }
     void destroyNode_impl(node_type & node)
     {
         key_item_type item = node.getKey();
@@ -335,8 +418,69 @@ public:
             }
         }
     }
+    size_type hash_impl(const key_type key) const
+    {
+        return m_hash_func(key);
+    }
+    // incremental form of rehash_impl()
+    // the function copies items with home slot in [first, last), it assumes:
+    //    * nobody modifies src
+    //    * the items are not in dst yet, other items of dst may be modified concurrently
+    size_type migrate_impl(const table_type& src,
+                           const size_type first,
+                           const size_type last,
+                           table_type& dst)
+    {
+        const size_type capacity = src.m_capacity;
+        size_type count = 0;
+
+        // an item may be placed beyond the range but not beyond an unused slot
+        for (size_type n = first; n < first + capacity; ++n)
+        {
+            const node_type& node = src.m_table[n < capacity ? n : n - capacity];
+            const key_item_type item = node.getKey();
+
+            if (item.m_state == key_item_type::unused)
+            {
+                if (n >= last)
+                {
+                    break;
+                }
+            }
+            else if (item.m_state == key_item_type::allocated
+                    && is_home_slot(src, m_hash_func(item.m_key), first, last))
+            {
+                const mapped_type & val = *node.getValue();
+                insert_impl(dst, item.m_key, false, val);
+                ++count;
+            }
+        }
+        return count;
+    }
 private:
 
+    // constructs the value of a pending node and publishes it; if the value
+    // cannot be constructed the node is left erased
+#if XTOMIC_USE_CPP11
+    template<typename ... Args>
+    void constructValue(node_type& node, Args&&... val)
+#else // XTOMIC_USE_CPP11
+    void constructValue(node_type& node, const mapped_type &val)
+#endif // XTOMIC_USE_CPP11
+    {
+        try
+        {
+            m_value_allocator.construct(node.getValue(),
+                    std_forward(Args, val));
+        }
+        catch (...)
+        {
+            node.setState(key_item_type::touched);
+            throw;
+        }
+        node.setState(key_item_type::allocated);
+    }
+
     // simplified form of insert()
     // the function assumes:
     //    * exclusive access to the container
@@ -348,7 +492,7 @@ private:
     {
         const size_type capacity = dst.m_capacity;
         const size_type hash = m_hash_func(key);
-        for (size_type i = hash % capacity;; ++i)
+        for (size_type i = dst.homeSlot(hash);; ++i)
         {
             if (i == capacity)
             {
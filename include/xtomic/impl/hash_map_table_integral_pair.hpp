@@ -9,6 +9,7 @@
 #define INCLUDE_HASH_MAP_TABLE_INTEGRAL_PAIR_HPP_
 
 #include "hash_map_node_integral_pair.hpp"
+#include "raw_hash_table.hpp"
 #include "cas.hpp"
 
 #include <cassert>
@@ -18,11 +19,11 @@
 namespace xtomic
 {
 template<typename Key, typename Value, typename Hash, typename Pred,
-        typename Allocator>
+        typename Allocator, indexing::type Indexing = default_indexing::value>
 class hash_map_table_integral_pair
 {
 public:
-    typedef hash_map_table_integral_pair<Key, Value, Hash, Pred, Allocator> this_type;
+    typedef hash_map_table_integral_pair<Key, Value, Hash, Pred, Allocator, Indexing> this_type;
 
     typedef Key key_type;
     typedef Value mapped_type;
@@ -31,7 +32,7 @@ public:
     typedef Allocator allocator_type;
 
     typedef hash_node_integral_pair<key_type, mapped_type> node_type;
-    typedef hash_data_table<node_type> table_type;
+    typedef hash_data_table<node_type, Indexing> table_type;
     typedef typename table_type::size_type size_type;
 
     typedef std::pair<key_type, mapped_type> value_type;
@@ -40,6 +41,8 @@ public:
     static constexpr bool INTEGRAL_KEY = true;
     static constexpr bool INTEGRAL_VALUE = true;
     static constexpr bool INTEGRAL_KEYVALUE = true;
+    // keys are compared in place, control bytes would not save anything
+    static constexpr bool CONTROL_BYTES = false;
 
 private:
     typedef typename node_type::state_type state_type;
@@ -69,12 +72,18 @@ public:
                    const key_type key,
                    mapped_type & value) const
     {
-        const std::size_t hash = m_hash_func(key);
-
+        return find_impl(raw_table, key, m_hash_func(key), value);
+    }
+    // the hash is hash_impl() of the key computed in advance
+    bool find_impl(const table_type& raw_table,
+                   const key_type key,
+                   const size_type hash,
+                   mapped_type & value) const
+    {
         const node_type* table = raw_table.m_table;
         const size_type capacity = raw_table.m_capacity;
 
-        for (size_type i = hash % capacity;;)
+        for (size_type i = raw_table.homeSlot(hash);;)
         {
             const node_type node = table[i];
 
@@ -118,7 +127,7 @@ public:
         node_type* table = raw_table.m_table;
         const size_type capacity = raw_table.m_capacity;
 
-        for (size_type i = hash % capacity;;)
+        for (size_type i = raw_table.homeSlot(hash);;)
         {
             const node_type node = table[i];
 
@@ -190,7 +199,7 @@ public:
         node_type* table = raw_table.m_table;
         const size_type capacity = raw_table.m_capacity;
 
-        for (size_type i = hash % capacity;;)
+        for (size_type i = raw_table.homeSlot(hash);;)
         {
             const node_type node = table[i];
 
@@ -233,6 +242,63 @@ public:
         }
         return false;
     }
+    // applies func to the value of the key, the new value replaces the old one
+    // by a single CAS of the node, func is applied again if the node has been
+    // changed meanwhile
+    template<typename Functor>
+    bool update_impl(table_type& raw_table,
+                     const key_type key,
+                     Functor & func)
+    {
+        const std::size_t hash = m_hash_func(key);
+
+        node_type* table = raw_table.m_table;
+        const size_type capacity = raw_table.m_capacity;
+
+        for (size_type i = raw_table.homeSlot(hash);;)
+        {
+            const node_type node = table[i];
+
+            switch (node.m_data.m_state)
+            {
+            case node_type::unused:
+                // the search finished
+                return false;
+            case node_type::touched:
+                if (m_eq_func(key, node.m_data.m_key))
+                {
+                    // the item was erased recently
+                    return false;
+                }
+                break;
+            case node_type::allocated:
+                if (m_eq_func(key, node.m_data.m_key))
+                {
+                    // the fields of the node are packed, func gets a copy
+                    mapped_type value = node.m_data.m_value;
+                    func(value);
+
+                    const node_type new_node(node_type::allocated,
+                            node.m_data.m_key, value);
+
+                    if (table[i].atomic_cas(node, new_node))
+                    {
+                        return true;
+                    }
+                    // the slot has been updated by other thread so we have to start all over again
+                    continue;
+                }
+                break;
+            default:
+                assert(false);
+            }
+            if (++i == capacity)
+            {
+                i = 0;
+            }
+        }
+        return false;
+    }
     void destroyNode_impl(node_type & node)
     {
     }
@@ -249,6 +315,44 @@ public:
             }
         }
     }
+    size_type hash_impl(const key_type key) const
+    {
+        return m_hash_func(key);
+    }
+    // incremental form of rehash_impl()
+    // the function copies items with home slot in [first, last), it assumes:
+    //    * nobody modifies src
+    //    * the items are not in dst yet, other items of dst may be modified concurrently
+    size_type migrate_impl(const table_type& src,
+                           const size_type first,
+                           const size_type last,
+                           table_type& dst)
+    {
+        const size_type capacity = src.m_capacity;
+        size_type count = 0;
+
+        // an item may be placed beyond the range but not beyond an unused slot
+        for (size_type n = first; n < first + capacity; ++n)
+        {
+            const node_type node = src.m_table[n < capacity ? n : n - capacity];
+
+            if (node_type::unused == node.m_data.m_state)
+            {
+                if (n >= last)
+                {
+                    break;
+                }
+            }
+            else if (node_type::allocated == node.m_data.m_state
+                    && is_home_slot(src, m_hash_func(node.m_data.m_key), first,
+                            last))
+            {
+                insert_impl(dst, node.m_data.m_key, false, node.m_data.m_value);
+                ++count;
+            }
+        }
+        return count;
+    }
 
     // simplified form of insert()
     // the function assumes:
@@ -260,7 +364,7 @@ public:
         const size_type capacity = dst.m_capacity;
         const size_type hash = m_hash_func(new_node.m_data.m_key);
 
-        for (size_type i = hash % capacity;; ++i)
+        for (size_type i = dst.homeSlot(hash);; ++i)
         {
             if (i == capacity)
             {
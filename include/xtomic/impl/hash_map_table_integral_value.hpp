@@ -23,11 +23,11 @@ namespace xtomic
 {
 
 template<typename Key, typename Value, typename Hash, typename Pred,
-        typename Allocator>
+        typename Allocator, indexing::type Indexing = default_indexing::value>
 class hash_map_table_integral_value
 {
 public:
-    typedef hash_map_table_integral_value<Key, Value, Hash, Pred, Allocator> this_type;
+    typedef hash_map_table_integral_value<Key, Value, Hash, Pred, Allocator, Indexing> this_type;
     typedef Key key_type;
     typedef Value mapped_type;
     typedef Hash hash_func_type;
@@ -35,7 +35,7 @@ public:
     typedef Allocator allocator_type;
 
     typedef hash_node_integral_value<key_type, mapped_type> node_type;
-    typedef hash_data_table<node_type> table_type;
+    typedef hash_data_table<node_type, Indexing> table_type;
     typedef typename node_type::value_item_type value_item_type;
     typedef typename table_type::size_type size_type;
     typedef typename allocator_type::template rebind<key_type>::other key_allocator_type;
@@ -46,6 +46,8 @@ public:
     static constexpr bool INTEGRAL_KEY = false;
     static constexpr bool INTEGRAL_VALUE = true;
     static constexpr bool INTEGRAL_KEYVALUE = false;
+    // probes visit only slots with the tag of the hash
+    static constexpr bool CONTROL_BYTES = table_type::indexing_type::CONTROL_BYTES;
 
 //
 // template<typename CompatibleKey, Key>
@@ -81,12 +83,22 @@ public:
                    const key_type & key,
                    mapped_type & value) const
     {
-        const size_type hash = m_hash_func(key);
-
+        return find_impl(raw_table, key, m_hash_func(key), value);
+    }
+    // the hash is hash_impl() of the key computed in advance
+    bool find_impl(const table_type& raw_table,
+                   const key_type & key,
+                   const size_type hash,
+                   mapped_type & value) const
+    {
+        if (CONTROL_BYTES)
+        {
+            return findGrouped(raw_table, key, hash, value);
+        }
         const node_type* table = raw_table.m_table;
         const size_type capacity = raw_table.m_capacity;
 
-        for (size_type i = hash % capacity;;)
+        for (size_type i = raw_table.homeSlot(hash);;)
         {
             const node_type& node = table[i];
             const value_item_type item = node.getValue();
@@ -103,14 +115,14 @@ public:
                 //continue;
                 continue;
             case value_item_type::touched:
-                if (m_eq_func(key, *node.getKey()))
+                if (node.getHash() == hash && m_eq_func(key, *node.getKey()))
                 {
                     // the item was erased recently
                     return false;
                 }
                 break;
             case value_item_type::allocated:
-                if (m_eq_func(key, *node.getKey()))
+                if (node.getHash() == hash && m_eq_func(key, *node.getKey()))
                 {
                     value = item.m_value;
                     return true;
@@ -133,12 +145,16 @@ public:
                      const bool updateIfExists,
                      const mapped_type &val)
     {
+        if (CONTROL_BYTES)
+        {
+            return insertGrouped(raw_table, key, updateIfExists, val);
+        }
         const size_type hash = m_hash_func(key);
 
         node_type* table = raw_table.m_table;
         const size_type capacity = raw_table.m_capacity;
 
-        for (size_type i = hash % capacity;;)
+        for (size_type i = raw_table.homeSlot(hash);;)
         {
             node_type& node = table[i];
             const value_item_type item = node.getValue();
@@ -153,6 +169,7 @@ public:
                 {
                     value_item_type & ritem = node.getValue();
                     ritem.m_value = val;
+                    node.setHash(hash);
                     m_key_allocator.construct(node.getKey(), key);
                     thread_fence(barriers::release);
                     ritem.m_state = value_item_type::allocated;
@@ -169,7 +186,7 @@ public:
                 // so start all over again
                 continue;
             case value_item_type::allocated:
-                if (m_eq_func(key, *node.getKey()))
+                if (node.getHash() == hash && m_eq_func(key, *node.getKey()))
                 {
                     if ( !updateIfExists )
                     {
@@ -189,7 +206,7 @@ public:
                 }
                 break;
             case value_item_type::touched:
-                if (m_eq_func(key, *node.getKey()))
+                if (node.getHash() == hash && m_eq_func(key, *node.getKey()))
                 {
                     if (node.getValue().atomic_cas(value_item_type::touched,
                             value_item_type::pending))
@@ -219,12 +236,16 @@ public:
 
     bool erase_impl(table_type& raw_table, const key_type & key)
     {
+        if (CONTROL_BYTES)
+        {
+            return eraseGrouped(raw_table, key);
+        }
         const size_type hash = m_hash_func(key);
 
         node_type* table = raw_table.m_table;
         const size_type capacity = raw_table.m_capacity;
 
-        for (size_type i = hash % capacity;;)
+        for (size_type i = raw_table.homeSlot(hash);;)
         {
             node_type& node = table[i];
             const value_item_type item = node.getValue();
@@ -238,14 +259,14 @@ public:
                 // the first insert is in progress
                 break;
             case value_item_type::touched:
-                if (m_eq_func(key, *node.getKey()))
+                if (node.getHash() == hash && m_eq_func(key, *node.getKey()))
                 {
                     // the item was erased recently
                     return false;
                 }
                 break;
             case value_item_type::allocated:
-                if (m_eq_func(key, *node.getKey()))
+                if (node.getHash() == hash && m_eq_func(key, *node.getKey()))
                 {
                     // reset readiness
                     if (node.getValue().atomic_cas(value_item_type::allocated,
@@ -270,6 +291,261 @@ public:
         return false;
     }
 
+    // applies func to the value of the key, the new value replaces the old one
+    // by a single CAS of the state and the value, func is applied again if the
+    // item has been changed meanwhile
+    template<typename Functor>
+    bool update_impl(table_type& raw_table,
+                     const key_type & key,
+                     Functor & func)
+    {
+        if (CONTROL_BYTES)
+        {
+            return updateGrouped(raw_table, key, func);
+        }
+        const size_type hash = m_hash_func(key);
+
+        node_type* table = raw_table.m_table;
+        const size_type capacity = raw_table.m_capacity;
+
+        for (size_type i = raw_table.homeSlot(hash);;)
+        {
+            node_type& node = table[i];
+            const value_item_type item = node.getValue();
+
+            switch (item.m_state)
+            {
+            case value_item_type::unused:
+                // the search finished
+                return false;
+            case value_item_type::pending:
+                // an insert or an update is in progress, probe the slot again
+                cpu_relax();
+                continue;
+            case value_item_type::touched:
+                if (node.getHash() == hash && m_eq_func(key, *node.getKey()))
+                {
+                    // the item was erased recently
+                    return false;
+                }
+                break;
+            case value_item_type::allocated:
+                if (node.getHash() == hash && m_eq_func(key, *node.getKey()))
+                {
+                    if (updateValue(node, item, func))
+                    {
+                        return true;
+                    }
+                    // the item has been updated by other thread
+                    continue;
+                }
+                break;
+            default:
+                assert(false);
+            }
+            if (++i == capacity)
+            {
+                i = 0;
+            }
+        }
+        return false;
+    }
+
+    // find_impl() over control bytes
+    bool findGrouped(const table_type& raw_table,
+                     const key_type & key,
+                     const size_type hash,
+                     mapped_type & value) const
+    {
+        control_probe<table_type> probe(raw_table, hash);
+
+        for (size_type i; probe.next(i);)
+        {
+            const node_type& node = raw_table.m_table[i];
+            const value_item_type item = waitForKey(node);
+
+            if (node.getHash() == hash && m_eq_func(key, *node.getKey()))
+            {
+                if (item.m_state == value_item_type::allocated)
+                {
+                    value = item.m_value;
+                    return true;
+                }
+                // the item was erased recently
+                return false;
+            }
+        }
+        return false;
+    }
+
+    // insert_impl() over control bytes
+    bool insertGrouped(table_type& raw_table,
+                       const key_type & key,
+                       const bool updateIfExists,
+                       const mapped_type &val)
+    {
+        const size_type hash = m_hash_func(key);
+
+        for (;;)
+        {
+            control_probe<table_type> probe(raw_table, hash);
+            bool retry = false;
+            size_type i;
+
+            while (!retry && probe.next(i))
+            {
+                node_type& node = raw_table.m_table[i];
+                const value_item_type item = waitForKey(node);
+
+                if (node.getHash() != hash || !m_eq_func(key, *node.getKey()))
+                {
+                    continue;
+                }
+                if (item.m_state == value_item_type::touched)
+                {
+                    if (node.getValue().atomic_cas(value_item_type::touched,
+                            value_item_type::pending))
+                    {
+                        value_item_type & ritem = node.getValue();
+                        ritem.m_value = val;
+                        thread_fence(barriers::release);
+                        ritem.m_state = value_item_type::allocated;
+                        ++raw_table.m_size;
+                        return true;
+                    }
+                    // the slot has been updated by other thread
+                    // so at least one concurrent insert operation took place
+                    return false;
+                }
+                if ( !updateIfExists )
+                {
+                    return false;
+                }
+                if (node.getValue().atomic_cas(value_item_type::allocated,
+                        value_item_type::pending))
+                {
+                    value_item_type & ritem = node.getValue();
+                    ritem.m_value = val;
+                    thread_fence(barriers::release);
+                    ritem.m_state = value_item_type::allocated;
+                    return true;
+                }
+                // the slot has been updated by other thread so start all over again
+                retry = true;
+            }
+            if (retry)
+            {
+                continue;
+            }
+            // the key is not in the table, claim the first empty slot
+            i = probe.emptySlot();
+            if (!control_claim(raw_table.m_control, i, hash))
+            {
+                // other thread has taken the slot so start all over again
+                continue;
+            }
+            // nobody else changes the node of a claimed slot
+            node_type& node = raw_table.m_table[i];
+            node.getValue().atomic_cas(value_item_type::unused,
+                    value_item_type::pending);
+            value_item_type & ritem = node.getValue();
+            ritem.m_value = val;
+            node.setHash(hash);
+            m_key_allocator.construct(node.getKey(), key);
+            thread_fence(barriers::release);
+            ritem.m_state = value_item_type::allocated;
+            ++raw_table.m_used;
+            ++raw_table.m_size;
+            return true;
+        }
+    }
+
+    // erase_impl() over control bytes
+    bool eraseGrouped(table_type& raw_table, const key_type & key)
+    {
+        const size_type hash = m_hash_func(key);
+        control_probe<table_type> probe(raw_table, hash);
+
+        for (size_type i; probe.next(i);)
+        {
+            node_type& node = raw_table.m_table[i];
+            const value_item_type item = waitForKey(node);
+
+            if (node.getHash() == hash && m_eq_func(key, *node.getKey()))
+            {
+                // the item either is erased now or was erased recently
+                if (item.m_state == value_item_type::allocated
+                        && node.getValue().atomic_cas(
+                                value_item_type::allocated,
+                                value_item_type::touched))
+                {
+                    --raw_table.m_size;
+                    return true;
+                }
+                return false;
+            }
+        }
+        return false;
+    }
+
+    // update_impl() over control bytes
+    template<typename Functor>
+    bool updateGrouped(table_type& raw_table,
+                       const key_type & key,
+                       Functor & func)
+    {
+        const size_type hash = m_hash_func(key);
+        control_probe<table_type> probe(raw_table, hash);
+
+        for (size_type i; probe.next(i);)
+        {
+            node_type& node = raw_table.m_table[i];
+            value_item_type item = waitForKey(node);
+
+            if (node.getHash() != hash || !m_eq_func(key, *node.getKey()))
+            {
+                continue;
+            }
+            // the item is either updated now or was erased recently
+            while (item.m_state == value_item_type::allocated)
+            {
+                if (updateValue(node, item, func))
+                {
+                    return true;
+                }
+                item = waitForKey(node);
+            }
+            return false;
+        }
+        return false;
+    }
+
+    // replaces the allocated item by a single CAS if nobody has changed it
+    template<typename Functor>
+    static bool updateValue(node_type& node,
+                            const value_item_type& item,
+                            Functor & func)
+    {
+        mapped_type value = item.m_value;
+        func(value);
+        return node.getValue().atomic_cas(item,
+                value_item_type(value_item_type::allocated, value));
+    }
+
+    // the key of a slot claimed by its control byte is valid once the item
+    // is neither unused nor pending
+    static value_item_type waitForKey(const node_type& node)
+    {
+        value_item_type item = node.getValue();
+        while (item.m_state == value_item_type::unused
+                || item.m_state == value_item_type::pending)
+        {
+            cpu_relax();
+            item = node.getValue();
+        }
+        return item;
+    }
+
     void destroyNode_impl(node_type & node)
     {
         const value_item_type item = node.getValue();
@@ -299,6 +575,48 @@ public:
             }
         }
     }
+    size_type hash_impl(const key_type & key) const
+    {
+        return m_hash_func(key);
+    }
+    // incremental form of rehash_impl()
+    // the function copies items with home slot in [first, last), it assumes:
+    //    * nobody modifies src
+    //    * the items are not in dst yet, other items of dst may be modified concurrently
+    size_type migrate_impl(const table_type& src,
+                           const size_type first,
+                           const size_type last,
+                           table_type& dst)
+    {
+        const size_type capacity = src.m_capacity;
+        size_type count = 0;
+
+        // an item may be placed beyond the range but not beyond an unused slot
+        for (size_type n = first; n < first + capacity; ++n)
+        {
+            node_type& node = src.m_table[n < capacity ? n : n - capacity];
+            const value_item_type& item = node.getValue();
+
+            if (item.m_state == value_item_type::unused)
+            {
+                if (n >= last)
+                {
+                    break;
+                }
+            }
+            else if (item.m_state == value_item_type::allocated)
+            {
+                const key_type & key = *node.getKey();
+                if (is_home_slot(src, node.getHash(), first, last))
+                {
+                    const mapped_type val = item.m_value;
+                    insert_impl(dst, key, false, val);
+                    ++count;
+                }
+            }
+        }
+        return count;
+    }
     // simplified form of insert()
     // the function assumes:
     //    * exclusive access to the container
@@ -311,7 +629,7 @@ public:
         const size_type hash = m_hash_func(key);
         const size_type capacity = dst.m_capacity;
 
-        for (size_type i = hash % capacity;; ++i)
+        for (size_type i = dst.homeSlot(hash);; ++i)
         {
             if (i == capacity)
             {
@@ -321,6 +639,11 @@ public:
             value_item_type& item = node.getValue();
             if (item.m_state == value_item_type::unused)
             {
+                if (CONTROL_BYTES)
+                {
+                    control_claim(dst.m_control, i, hash);
+                }
+                node.setHash(hash);
                 m_key_allocator.construct(node.getKey(), key);
                 item.m_value = val;
                 thread_fence(barriers::release);
@@ -26,6 +26,7 @@ struct align_4_cas16 hash_set_item
         allocated,  // hash & key are valid
     };
 
+    // the full hash of the key, probes compare it before the key itself
     std::size_t m_hash;
 
     // normal life cycle of an item in the hash table is:
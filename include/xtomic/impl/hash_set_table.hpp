@@ -29,24 +29,26 @@
 namespace xtomic
 {
 
-template<typename Key, typename Hash, typename Pred, typename Allocator>
+template<typename Key, typename Hash, typename Pred, typename Allocator, indexing::type Indexing = default_indexing::value>
 class hash_set_table
 {
 public:
-    typedef hash_set_table<Key, Hash, Pred, Allocator> this_type;
+    typedef hash_set_table<Key, Hash, Pred, Allocator, Indexing> this_type;
     typedef Key key_type;
     typedef Hash hash_func_type;
     typedef Pred equal_predicate_type;
     typedef Allocator allocator_type;
 
     typedef hash_set_node<key_type> node_type;
-    typedef hash_data_table<node_type> table_type;
+    typedef hash_data_table<node_type, Indexing> table_type;
 
     typedef typename table_type::size_type size_type;
     typedef typename Allocator::template rebind<key_type>::other key_allocator_type;
     typedef std::vector<key_type> snapshot_type;
 
     static constexpr bool INTEGRAL = false;
+    // control bytes are used by the maps only
+    static constexpr bool CONTROL_BYTES = false;
 
 //
 // template<typename CompatibleKey, Key>
@@ -83,14 +85,19 @@ public:
     }
     bool find_impl(const table_type& raw_table, const key_type & key) const
     {
-        hash_func_type hash_func;
+        return find_impl(raw_table, key, hash_impl(key));
+    }
+    // the hash is hash_impl() of the key computed in advance
+    bool find_impl(const table_type& raw_table,
+                   const key_type & key,
+                   const size_type hash) const
+    {
         equal_predicate_type eq_func;
 
-        const size_type hash = hash_func(key);
         const node_type* table = raw_table.m_table;
         const size_type capacity = raw_table.m_capacity;
 
-        for (size_type i = hash % capacity;; ++i)
+        for (size_type i = raw_table.homeSlot(hash);; ++i)
         {
             if (i == capacity)
             {
@@ -114,14 +121,14 @@ public:
                 }
                 break;
             case hash_item_type::touched:
-                if (eq_func(key, *node.getKey()))
+                if (item.m_hash == hash && eq_func(key, *node.getKey()))
                 {
                     // the item was erased recently
                     return false;
                 }
                 break;
             case hash_item_type::allocated:
-                if (eq_func(key, *node.getKey()))
+                if (item.m_hash == hash && eq_func(key, *node.getKey()))
                 {
                     return true;
                 }
@@ -142,12 +149,8 @@ public:
         node_type* table = raw_table.m_table;
         const size_type capacity = raw_table.m_capacity;
 
-        for (size_type i = hash % capacity;; ++i)
+        for (size_type i = raw_table.homeSlot(hash);;)
         {
-            if (i == capacity)
-            {
-                i = 0;
-            }
             node_type& node = table[i];
             const hash_item_type item = node.m_hash;
 
@@ -179,14 +182,14 @@ public:
                 }
                 break;
             case hash_item_type::allocated:
-                if (eq_func(key, *node.getKey()))
+                if (item.m_hash == hash && eq_func(key, *node.getKey()))
                 {
                     // the item is allocated or concurrent insert/delete operation is in progress
                     return false;
                 }
                 break;
             case hash_item_type::touched:
-                if (eq_func(key, *node.getKey()))
+                if (item.m_hash == hash && eq_func(key, *node.getKey()))
                 {
                     static constexpr std::size_t touched =
                             hash_item_type::touched;
@@ -206,6 +209,10 @@ public:
             default:
                 assert(false);
             }
+            if (++i == capacity)
+            {
+                i = 0;
+            }
         }
         throw std::bad_alloc();
         return false;
@@ -219,7 +226,7 @@ public:
         node_type* table = raw_table.m_table;
         const size_type capacity = raw_table.m_capacity;
 
-        for (size_type i = hash % capacity;; ++i)
+        for (size_type i = raw_table.homeSlot(hash);; ++i)
         {
             if (i == capacity)
             {
@@ -243,14 +250,14 @@ public:
                 }
                 break;
             case hash_item_type::touched:
-                if (eq_func(key, *node.getKey()))
+                if (item.m_hash == hash && eq_func(key, *node.getKey()))
                 {
                     // the item was erased recently
                     return false;
                 }
                 break;
             case hash_item_type::allocated:
-                if (eq_func(key, *node.getKey()))
+                if (item.m_hash == hash && eq_func(key, *node.getKey()))
                 {
                     static constexpr std::size_t touched =
                             hash_item_type::touched;
@@ -302,6 +309,45 @@ public:
             }
         }
     }
+    size_type hash_impl(const key_type & key) const
+    {
+        hash_func_type hash_func;
+        return hash_func(key);
+    }
+    // incremental form of rehash_impl()
+    // the function copies items with home slot in [first, last), it assumes:
+    //    * nobody modifies src
+    //    * the items are not in dst yet, other items of dst may be modified concurrently
+    size_type migrate_impl(const table_type& src,
+                           const size_type first,
+                           const size_type last,
+                           table_type& dst)
+    {
+        const size_type capacity = src.m_capacity;
+        size_type count = 0;
+
+        // an item may be placed beyond the range but not beyond an unused slot
+        for (size_type n = first; n < first + capacity; ++n)
+        {
+            node_type& node = src.m_table[n < capacity ? n : n - capacity];
+            const hash_item_type item = node.m_hash;
+
+            if (item.m_state == hash_item_type::unused)
+            {
+                if (n >= last)
+                {
+                    break;
+                }
+            }
+            else if (item.m_state == hash_item_type::allocated
+                    && is_home_slot(src, item.m_hash, first, last))
+            {
+                insert_impl(dst, *node.getKey());
+                ++count;
+            }
+        }
+        return count;
+    }
 
     // simplified form of insert()
     // the function assumes:
@@ -314,7 +360,7 @@ public:
     {
         const size_type capacity = dst.m_capacity;
 
-        for (size_type i = hash % capacity;; ++i)
+        for (size_type i = dst.homeSlot(hash);; ++i)
         {
             if (i == capacity)
             {
@@ -10,7 +10,9 @@
 
 #include "hash_table_base.hpp"
 #include <xtomic/aux/cppbasics.hpp>
+#include <xtomic/aux/inttypes.hpp>
 
+#include <algorithm>
 #include <vector>
 
 namespace xtomic
@@ -39,6 +41,26 @@ private:
     typedef typename base_type::insert_guard_type insert_guard_type;
     typedef typename base_type::scoped_reserver_type scoped_reserver_type;
 
+    // looks up a key of the batch in the table lookupBatch() has chosen for it
+    struct batch_finder
+    {
+        const hash_table_type& m_hashTable;
+        const key_type* m_keys;
+        uint64_t* m_found;
+        size_type m_count;
+
+        void operator()(const table_type& table,
+                        const size_type i,
+                        const size_type hash)
+        {
+            if (m_hashTable.find_impl(table, m_keys[i], hash))
+            {
+                m_found[i / 64] |= static_cast<uint64_t>(1) << (i % 64);
+                ++m_count;
+            }
+        }
+    };
+
 public:
     hash_set_table_base(hash_table_type & hashTable, size_type reserve) :
             base_type(hashTable, reserve)
@@ -50,7 +72,18 @@ public:
         const table_type* ptr;
         const_guard_type guard(base_type::getBase(), ptr);
 
-        return base_type::m_hashTable.find_impl(*ptr, key);
+        return base_type::m_hashTable.find_impl(
+                *base_type::lookupTable(ptr, key), key);
+    }
+    size_type findBatch(const key_type* keys,
+                        const size_type count,
+                        uint64_t* foundMask) const
+    {
+        std::fill(foundMask, foundMask + (count + 63) / 64, 0);
+
+        batch_finder finder = { base_type::m_hashTable, keys, foundMask, 0 };
+        base_type::lookupBatch(keys, count, finder);
+        return finder.m_count;
     }
     bool insert(const key_type & key)
     {
@@ -62,14 +95,16 @@ public:
         table_type* ptr;
         mutable_guard_type guard(base_type::getBase(), ptr);
 
-        return base_type::m_hashTable.insert_impl(*ptr, key);
+        return base_type::m_hashTable.insert_impl(
+                *base_type::updateTable(ptr, key), key);
     }
 };
 
-template<typename HashTable, bool greedy>
+template<typename HashTable, bool greedy,
+        rehashing::type Rehashing = default_rehashing::value>
 struct get_hash_set_table_base_type
 {
-    typedef typename get_hash_table_base_type<HashTable, greedy>::type base_type;
+    typedef typename get_hash_table_base_type<HashTable, greedy, Rehashing>::type base_type;
     typedef hash_set_table_base<base_type> type;
 };
 }
@@ -9,6 +9,7 @@
 #define INCLUDE_HASH_SET_TABLE_INTEGRAL_KEY_HPP_
 
 #include "hash_set_integral_key.hpp"
+#include "raw_hash_table.hpp"
 
 #include <cassert>
 #include <functional>
@@ -16,23 +17,25 @@
 
 namespace xtomic
 {
-template<typename Key, typename Hash, typename Pred, typename Allocator>
+template<typename Key, typename Hash, typename Pred, typename Allocator, indexing::type Indexing = default_indexing::value>
 class hash_set_table_integral_key
 {
 public:
-    typedef hash_set_table_integral_key<Key, Hash, Pred, Allocator> this_type;
+    typedef hash_set_table_integral_key<Key, Hash, Pred, Allocator, Indexing> this_type;
     typedef Key key_type;
     typedef Hash hash_func_type;
     typedef Pred equal_predicate_type;
     typedef Allocator allocator_type;
 
     typedef hash_set_integral_key<key_type> node_type;
-    typedef hash_data_table<node_type> table_type;
+    typedef hash_data_table<node_type, Indexing> table_type;
 
     typedef typename table_type::size_type size_type;
     typedef std::vector<key_type> snapshot_type;
 
     static constexpr bool INTEGRAL = true;
+    // keys are compared in place, control bytes would not save anything
+    static constexpr bool CONTROL_BYTES = false;
 
 private:
     typedef typename node_type::state_type state_type;
@@ -59,15 +62,19 @@ public:
     }
     bool find_impl(const table_type& raw_table, const key_type key) const
     {
-        hash_func_type hash_func;
+        return find_impl(raw_table, key, hash_impl(key));
+    }
+    // the hash is hash_impl() of the key computed in advance
+    bool find_impl(const table_type& raw_table,
+                   const key_type key,
+                   const size_type hash) const
+    {
         equal_predicate_type eq_func;
 
-        const size_type hash = hash_func(key);
-
         const node_type* table = raw_table.m_table;
         const size_type capacity = raw_table.m_capacity;
 
-        for (size_type i = hash % capacity;; ++i)
+        for (size_type i = raw_table.homeSlot(hash);; ++i)
         {
             if (i == capacity)
             {
@@ -109,13 +116,10 @@ public:
         node_type* table = raw_table.m_table;
         const size_type capacity = raw_table.m_capacity;
 
-        for (size_type i = hash % capacity;; ++i)
+        for (size_type i = raw_table.homeSlot(hash);;)
         {
-            if (i == capacity)
-            {
-                i = 0;
-            }
-            node_type& node = table[i];
+            // the copy is the expected value of CAS below
+            const node_type node = table[i];
 
             switch (node.m_state)
             {
@@ -159,6 +163,10 @@ public:
             default:
                 assert(false);
             }
+            if (++i == capacity)
+            {
+                i = 0;
+            }
         }
         throw std::bad_alloc();
         return false;
@@ -173,7 +181,7 @@ public:
         node_type* table = raw_table.m_table;
         const size_type capacity = raw_table.m_capacity;
 
-        for (size_type i = hash % capacity;; ++i)
+        for (size_type i = raw_table.homeSlot(hash);; ++i)
         {
             if (i == capacity)
             {
@@ -235,6 +243,46 @@ public:
             }
         }
     }
+    size_type hash_impl(const key_type key) const
+    {
+        hash_func_type hash_func;
+        return hash_func(key);
+    }
+    // incremental form of rehash_impl()
+    // the function copies items with home slot in [first, last), it assumes:
+    //    * nobody modifies src
+    //    * the items are not in dst yet, other items of dst may be modified concurrently
+    size_type migrate_impl(const table_type& src,
+                           const size_type first,
+                           const size_type last,
+                           table_type& dst)
+    {
+        hash_func_type hash_func;
+
+        const size_type capacity = src.m_capacity;
+        size_type count = 0;
+
+        // an item may be placed beyond the range but not beyond an unused slot
+        for (size_type n = first; n < first + capacity; ++n)
+        {
+            const node_type& node = src.m_table[n < capacity ? n : n - capacity];
+
+            if (node_type::unused == node.m_state)
+            {
+                if (n >= last)
+                {
+                    break;
+                }
+            }
+            else if (node_type::allocated == node.m_state
+                    && is_home_slot(src, hash_func(node.m_key), first, last))
+            {
+                insert_impl(dst, node.m_key);
+                ++count;
+            }
+        }
+        return count;
+    }
     // simplified form of insert()
     // the function assumes:
     //    * exclusive access to the container
@@ -247,7 +295,7 @@ public:
         const size_type capacity = dst.m_capacity;
         node_type* table = dst.m_table;
 
-        for (size_type i = hash % capacity;; ++i)
+        for (size_type i = dst.homeSlot(hash);; ++i)
         {
             if (i == capacity)
             {
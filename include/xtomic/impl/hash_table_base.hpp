@@ -10,6 +10,11 @@
 
 #include "ref_ptr.hpp"
 #include "ref_lock.hpp"
+#include "first_touch.hpp"
+#include "rehashing.hpp"
+#include "epoch.hpp"
+#include "control_bytes.hpp"
+#include "sharded_counter.hpp"
 #include <xtomic/aux/cppbasics.hpp>
 #include <xtomic/quantum.hpp>
 
@@ -23,129 +28,64 @@ namespace xtomic
 namespace
 {
 template<typename Value>
-struct LinkedEnvelop: public Value
+struct LinkedEnvelop: public Value, public epoch_hook
 {
 
     typedef LinkedEnvelop<Value> this_type;
     typedef Value value_type;
-    typedef std::size_t count_type;
-
-    mutable xtomic::quantum<count_type> m_writeCount;
-
-    this_type* m_link;
 
     LinkedEnvelop() :
             Value(),
-            m_link(nullptr)
+            epoch_hook()
     {
 
     }
 };
 
-template<typename Value>
-struct align_4_cas16 CountedEnvelop: public Value
+//
+// Writers of a table enter the domain of writers before they read the pointer
+// to the table. A thread that replaces the table takes the pointer away and
+// waits until the writers that could have seen it leave, after that nobody
+// modifies the table. Writers count themselves in the slots of their threads,
+// so they do not share cache lines unless the table is being replaced.
+//
+template<typename Table>
+Table* acquireWritable(const xtomic::quantum<Table*>& table,
+                       const epoch_domain& writers,
+                       epoch_domain::token_type& token)
 {
-
-    typedef CountedEnvelop<Value> this_type;
-    typedef Value value_type;
-    typedef std::size_t count_type;
-
-    mutable xtomic::quantum<count_type> m_readCount;
-    mutable xtomic::quantum<count_type> m_writeCount;
-
-    CountedEnvelop() :
-            Value(),
-            m_readCount(0),
-            m_writeCount(0)
+    for (;;)
     {
-
-    }
-};
-
-template<typename Value>
-struct align_4_cas16 CountedPtr
-{
-    typedef CountedPtr<Value> this_type;
-    typedef Value value_type;
-    typedef typename value_type::count_type count_type;
-    typedef value_type* ptr_type;
-    typedef const value_type* const_ptr_type;
-
-    xtomic::quantum<ptr_type> m_ptr;
-    mutable xtomic::quantum<count_type> m_count;
-
-    CountedPtr(ptr_type ptr = nullptr, count_type count = 0) :
-            m_ptr(ptr),
-            m_count(count)
-    {
-
-    }
-
-    ptr_type aquire()
-    {
-        bool res;
-        ptr_type ptr;
-        do
-        {
-            ptr = m_ptr.load(barriers::acquire);
-            if (!ptr)
-            {
-                continue;
-            }
-            count_type count = m_count.load(barriers::acquire);
-
-            this_type expected(ptr, count);
-            this_type next(ptr, ++count);
-            res = xtomic::atomic_cas(*this, expected, next);
-        }
-        while (!res);
-        return ptr;
-    }
-    const_ptr_type aquire() const
-    {
-        return const_cast<this_type*>(this)->aquire();
-    }
-    bool tryReset(ptr_type expected, ptr_type ptr, this_type& prev)
-    {
-        prev.m_ptr.store(expected, barriers::release);
-        prev.m_count.store(m_count.load(barriers::acquire), barriers::release);
-        this_type next(ptr, 0);
-        bool res = xtomic::atomic_cas(*this, prev, next);
-        return res;
-    }
-    void reset(ptr_type expected, ptr_type ptr, this_type& prev)
-    {
-        bool res;
-        do
+        token = writers.enter();
+        Table* ptr = table.load(barriers::acquire);
+        if (ptr)
         {
-            res = tryReset(expected, ptr, prev);
+            return ptr;
         }
-        while (!res);
-    }
-    void reset(this_type& expected, ptr_type ptr, this_type& prev)
-    {
-        reset(expected.m_ptr.load(barriers::relaxed), ptr, prev);
-    }
-    void waitFor(xtomic::quantum<count_type>& count)
-    {
-        count_type expected = m_count.load(barriers::acquire);
-        count_type actual = count.load(barriers::acquire);
-        while (actual != expected)
+        writers.leave(token);
+        // the table is being replaced
+        while (!table.load(barriers::acquire))
         {
-            actual = count.load(barriers::acquire);
+            cpu_relax();
         }
     }
-    void waitForReads()
-    {
-        ptr_type p = m_ptr.load(barriers::acquire);
-        waitFor(p->m_readCount);
-    }
-    void waitForWrites()
+}
+
+// takes the table from writers, the caller must not be a writer itself
+template<typename Table>
+bool closeWritable(xtomic::quantum<Table*>& table,
+                   epoch_domain& writers,
+                   Table*& ptr)
+{
+    ptr = table.load(barriers::relaxed);
+    if (!ptr || !table.atomic_cas(ptr, nullptr))
     {
-        ptr_type p = m_ptr.load(barriers::acquire);
-        waitFor(p->m_writeCount);
+        return false;
     }
-};
+    // wait for pending writes
+    writers.synchronize();
+    return true;
+}
 
 template<typename Base>
 class const_table_guard
@@ -154,19 +94,22 @@ public:
     typedef const_table_guard<Base> this_type;
     typedef Base base_type;
     typedef typename base_type::table_type table_type;
+    typedef typename base_type::read_token_type read_token_type;
 public:
     const_table_guard(const base_type& base, const table_type*& ptr) :
             m_base(base),
-            m_ptr(base.acquireConstTable())
+            m_token(),
+            m_ptr(base.acquireConstTable(m_token))
     {
         ptr = m_ptr;
     }
     ~const_table_guard()
     {
-        m_base.releaseConstTable(m_ptr);
+        m_base.releaseConstTable(m_ptr, m_token);
     }
 private:
     const base_type& m_base;
+    read_token_type m_token;
     const table_type* m_ptr;
 };
 
@@ -177,47 +120,67 @@ public:
     typedef const_table_guard<Base> this_type;
     typedef Base base_type;
     typedef typename base_type::table_type table_type;
+    typedef typename base_type::write_token_type write_token_type;
 public:
     mutable_table_guard(base_type& base, table_type*& ptr) :
             m_base(base),
-            m_ptr(base.acquireMutableTable())
+            m_token(),
+            m_ptr(base.acquireMutableTable(m_token))
     {
         ptr = m_ptr;
     }
     ~mutable_table_guard()
     {
-        m_base.releaseMutableTable(m_ptr);
+        m_base.releaseMutableTable(m_ptr, m_token);
     }
 private:
     base_type& m_base;
+    write_token_type m_token;
     table_type* m_ptr;
 };
 
 // the class reserves extra space for insert operation
+//
+// every insert in progress is counted in the slot of its thread, a slot moves
+// its count to the shared total only when threads of the slot insert at once,
+// so normally the inserts do not share cache lines
 class insert_guard
 {
 public:
     typedef std::size_t count_type;
 
     insert_guard() :
-            m_count(0)
+            m_count(2)
     {
 
     }
-    count_type addRef() const
+    void addRef() const
+    {
+        ++m_count;
+    }
+    void release() const
     {
-        return ++m_count;
+        --m_count;
     }
-    count_type release() const
+    void addRef(const count_type count) const
     {
-        return --m_count;
+        m_count.add(count);
+    }
+    void release(const count_type count) const
+    {
+        m_count.sub(count);
+    }
+    // the number of inserts in progress is not greater
+    count_type getBound() const
+    {
+        return m_count.approximate() + m_count.error();
     }
     count_type get() const
     {
-        return m_count.load(barriers::relaxed);
+        return m_count.exact();
     }
 private:
-    mutable xtomic::quantum<count_type> m_count;
+    mutable sharded_counter m_count;
 };
 }
 
@@ -232,10 +195,20 @@ public:
     typedef typename hash_table_type::size_type size_type;
     typedef typename hash_table_type::allocator_type allocator_type;
     typedef typename allocator_type::template rebind<node_type>::other node_allocator_type;
+    typedef typename table_type::chunk_type chunk_type;
+    typedef typename allocator_type::template rebind<chunk_type>::other chunk_allocator_type;
+    typedef typename allocator_type::template rebind<unsigned char>::other control_allocator_type;
 
     static const unsigned int HIGH_WATERMARK_MULT = 7;
     static const unsigned int HIGH_WATERMARK_DIV = 10;
     static const unsigned int MIN_CAPACITY = 20;
+    static const unsigned int MIGRATION_CHUNK = 256; // home slots moved at once by incremental rehashing
+    static const unsigned int COUNTER_ERROR_DIV = 32; // counters of a table are exact within 1/32 of the watermark
+
+    enum EChunkState
+    {
+        chunk_idle, chunk_moving, chunk_moved,
+    };
 
 public:
     root_hash_table(hash_table_type & hashTable) :
@@ -271,22 +244,66 @@ public:
             m_hashTable.destroyNode_impl(node);
         }
         m_nodeAllocator.deallocate(ptr->m_table, ptr->m_capacity);
+        if (ptr->m_control)
+        {
+            m_controlAllocator.deallocate(ptr->m_control, ptr->m_capacity);
+        }
+        if (ptr->m_chunks)
+        {
+            m_chunkAllocator.deallocate(ptr->m_chunks, ptr->m_chunkCount);
+        }
     }
     void initNodes(table_type* ptr, size_type capacity)
     {
+        capacity = table_type::indexing_type::roundCapacity(capacity);
         ptr->m_capacity = capacity;
+        ptr->m_bits = table_type::indexing_type::calcBits(capacity);
         ptr->m_highWatermark = calcWatermark(capacity);
-        ptr->m_size.store(0, barriers::relaxed);
-        ptr->m_used.store(0, barriers::relaxed);
+        const size_type batch = calcCounterBatch(ptr->m_highWatermark);
+        ptr->m_size.reset(batch);
+        ptr->m_used.reset(batch);
+        ptr->m_next.store(nullptr, barriers::relaxed);
+        ptr->m_chunks = nullptr;
+        ptr->m_chunkCount = 0;
         ptr->m_table = m_nodeAllocator.allocate(capacity);
-        for (size_type i = 0; i < capacity; ++i)
+        first_touch<node_type>::construct(ptr->m_table, capacity,
+                parallel_first_touch<allocator_type>::value);
+        ptr->m_control = nullptr;
+        if (hash_table_type::CONTROL_BYTES)
         {
-            ::new ((void *) &ptr->m_table[i]) node_type();
+            ptr->m_control = m_controlAllocator.allocate(capacity);
+            std::fill(ptr->m_control, ptr->m_control + capacity, CONTROL_EMPTY);
         }
     }
+    // the counters of a table are summed up only close to the watermarks
+    static size_type calcCounterBatch(size_type watermark)
+    {
+        return std::max(
+                watermark / (sharded_counter::SLOTS * COUNTER_ERROR_DIV),
+                static_cast<size_type>(1));
+    }
+    static size_type calcChunkCount(size_type capacity)
+    {
+        return (capacity + MIGRATION_CHUNK - 1) / MIGRATION_CHUNK;
+    }
+    chunk_type* allocateChunks(size_type count)
+    {
+        chunk_type* chunks = m_chunkAllocator.allocate(count);
+        for (size_type i = 0; i < count; ++i)
+        {
+            ::new (static_cast<void*>(chunks + i)) chunk_type(chunk_idle);
+        }
+        return chunks;
+    }
+    void deallocateChunks(chunk_type* chunks, size_type count)
+    {
+        m_chunkAllocator.deallocate(chunks, count);
+    }
 
 protected:
     node_allocator_type m_nodeAllocator;
+    chunk_allocator_type m_chunkAllocator;
+    control_allocator_type m_controlAllocator;
     hash_table_type& m_hashTable;
 };
 
@@ -303,11 +320,25 @@ public:
     typedef LinkedEnvelop<table_type> linked_table_type;
     typedef typename allocator_type::template rebind<linked_table_type>::other table_allocator_type;
     typedef table_type* cookie_type;
+    typedef epoch_domain::token_type read_token_type;
+    typedef epoch_domain::token_type write_token_type;
+
+    static const unsigned int RECLAIM_PERIOD = 64; // writes of a thread between attempts to free retired tables
 
 private:
-    typedef xtomic::quantum<linked_table_type*> linked_table_ptr_type;
     typedef xtomic::quantum<table_type*> table_ptr_type;
-    typedef CountedPtr<linked_table_type> table_cptr_type;
+    // retired tables are freed as soon as possible
+    typedef epoch_retire_list<linked_table_type, 1> retire_list_type;
+
+    struct table_deleter
+    {
+        greedy_hash_table_base* m_owner;
+
+        void operator()(linked_table_type* ltable) const
+        {
+            m_owner->freeTable(ltable);
+        }
+    };
 public:
 
     greedy_hash_table_base(hash_table_type & hashTable,
@@ -316,21 +347,16 @@ public:
     {
         const size_type capacity = base_type::calcCapacity(watermark);
         table_type* ptr = allocateTable(capacity);
-        linked_table_type* envelop = static_cast<linked_table_type*>(ptr);
         m_constTable.store(ptr, barriers::relaxed);
-        m_mutableTable.m_ptr.store(envelop, barriers::relaxed);
+        m_mutableTable.store(ptr, barriers::relaxed);
     }
     ~greedy_hash_table_base()
     {
-        linked_table_type* ltable = m_usedTables.load(barriers::relaxed);
-        while (ltable)
-        {
-            linked_table_type* next = ltable->m_link;
-            base_type::destroyNodes(ltable);
-            m_tableAllocator.destroy(ltable);
-            m_tableAllocator.deallocate(ltable, 1);
-            ltable = next;
-        }
+        table_deleter deleter = { this };
+        m_retiredTables.clear(deleter);
+        freeTable(
+                static_cast<linked_table_type*>(m_mutableTable.load(
+                        barriers::relaxed)));
     }
 
     table_type* allocateTable(const size_type capacity)
@@ -342,71 +368,72 @@ public:
         return table;
     }
 
+    // the table is freed when no reader can hold it any more
     void deallocateTable(table_type* table)
     {
         linked_table_type* envelop = static_cast<linked_table_type*>(table);
 
-        bool res;
-        do
-        {
-            envelop->m_link = m_usedTables.load(barriers::relaxed);
-            res = m_usedTables.atomic_cas(envelop->m_link, envelop);
-        }
-        while (!res);
-    }
-    const table_type* acquireConstTable() const
-    {
-        return m_constTable.load(barriers::relaxed);
+        // the table is not reachable by the moment it is retired
+        m_retiredTables.retire(m_readers, envelop);
+        reclaim();
     }
-    void releaseConstTable(const table_type*) const
+    const table_type* acquireConstTable(read_token_type& token) const
     {
+        token = m_readers.enter();
+        return m_constTable.load(barriers::acquire);
     }
-    table_type* acquireMutableTable()
+    void releaseConstTable(const table_type*, const read_token_type token) const
     {
-        return m_mutableTable.aquire();
+        m_readers.leave(token);
     }
-    void releaseMutableTable(table_type* ptr) const
+    table_type* acquireMutableTable(write_token_type& token)
     {
-        const linked_table_type* envelop =
-                static_cast<const linked_table_type*>(ptr);
-        ++envelop->m_writeCount;
+        return acquireWritable(m_mutableTable, m_writers, token);
     }
-    bool startRehashing(table_type*& ptr, cookie_type& cookie)
+    void releaseMutableTable(table_type*, const write_token_type token)
     {
-        linked_table_type* envelop = m_mutableTable.m_ptr.load(
-                barriers::relaxed);
-        if (!envelop)
-        {
-            return false;
-        }
-        ptr = envelop;
-        table_cptr_type state;
-        bool res = m_mutableTable.tryReset(envelop, nullptr, state);
-        if (res)
+        m_writers.leave(token);
+
+        // readers do not report leaving, so writers look after retired tables
+        static __thread unsigned int calls = 0;
+        if (++calls % RECLAIM_PERIOD == 0 && !m_retiredTables.empty())
         {
-            // wait for pending writes
-            state.waitForWrites();
+            reclaim();
         }
-        return res;
+    }
+    bool startRehashing(table_type*& ptr, cookie_type&)
+    {
+        return closeWritable(m_mutableTable, m_writers, ptr);
     }
     void finalizeRehashing(table_type* ptr, cookie_type)
     {
         m_constTable.store(ptr, barriers::relaxed);
-        linked_table_type* envelop = static_cast<linked_table_type*>(ptr);
-        envelop->m_writeCount.store(0, barriers::relaxed);
-        m_mutableTable.m_count.store(0, barriers::relaxed);
-        m_mutableTable.m_ptr.store(envelop, barriers::release);
+        m_mutableTable.store(ptr, barriers::release);
 
     }
     void cancelRehashing(table_type* ptr)
     {
-        linked_table_type* envelop = static_cast<linked_table_type*>(ptr);
-        m_mutableTable.m_ptr.store(envelop, barriers::release);
+        m_mutableTable.store(ptr, barriers::release);
+    }
+private:
+    void freeTable(linked_table_type* ltable)
+    {
+        base_type::destroyNodes(ltable);
+        m_tableAllocator.destroy(ltable);
+        m_tableAllocator.deallocate(ltable, 1);
+    }
+    // frees retired tables nobody can read, the function does not wait for readers
+    void reclaim()
+    {
+        table_deleter deleter = { this };
+        m_retiredTables.collect(m_readers, deleter);
     }
 private:
     table_ptr_type m_constTable;
-    table_cptr_type m_mutableTable;
-    linked_table_ptr_type m_usedTables;
+    table_ptr_type m_mutableTable;
+    retire_list_type m_retiredTables;
+    epoch_domain m_readers;
+    epoch_domain m_writers;
 
     table_allocator_type m_tableAllocator;
 };
@@ -421,29 +448,33 @@ public:
     typedef typename hash_table_type::allocator_type allocator_type;
     typedef typename hash_table_type::size_type size_type;
 
-    typedef CountedEnvelop<table_type> counted_table_type;
-    typedef CountedPtr<counted_table_type> table_ptr_type;
-    typedef table_ptr_type cookie_type;
-    typedef typename allocator_type::template rebind<counted_table_type>::other table_allocator_type;
+    typedef table_type* cookie_type;
+    typedef typename allocator_type::template rebind<table_type>::other table_allocator_type;
+    typedef epoch_domain::token_type read_token_type;
+    typedef epoch_domain::token_type write_token_type;
+
+private:
+    typedef xtomic::quantum<table_type*> table_ptr_type;
+public:
 
     wise_hash_table_base(hash_table_type & hashTable, const size_type watermark) :
             root_hash_table<HashTable>(hashTable)
     {
         const size_type capacity = base_type::calcCapacity(watermark);
-        counted_table_type* table =
-                static_cast<counted_table_type*>(allocateTable(capacity));
-        m_constTable.m_ptr.store(table, barriers::relaxed);
-        m_mutableTable.m_ptr.store(table, barriers::relaxed);
+        table_type* table = allocateTable(capacity);
+        m_constTable.store(table, barriers::relaxed);
+        m_mutableTable.store(table, barriers::relaxed);
     }
     ~wise_hash_table_base()
     {
+        deallocateTable(m_mutableTable.load(barriers::relaxed));
     }
 
     table_type* allocateTable(const size_type capacity)
     {
-        counted_table_type* table = m_tableAllocator.allocate(1);
+        table_type* table = m_tableAllocator.allocate(1);
         // allocators did not support default constructors before c++11
-        ::new (static_cast<void*>(table)) counted_table_type();
+        ::new (static_cast<void*>(table)) table_type();
         base_type::initNodes(table, capacity);
         return table;
     }
@@ -451,73 +482,53 @@ public:
     void deallocateTable(table_type* ptr)
     {
         base_type::destroyNodes(ptr);
-        counted_table_type* envelop = static_cast<counted_table_type*>(ptr);
-        m_tableAllocator.destroy(envelop);
-        m_tableAllocator.deallocate(envelop, 1);
+        m_tableAllocator.destroy(ptr);
+        m_tableAllocator.deallocate(ptr, 1);
     }
-    const table_type* acquireConstTable() const
+    // readers write only to the slot of their thread
+    const table_type* acquireConstTable(read_token_type& token) const
     {
-        return m_constTable.aquire();
+        token = m_readers.enter();
+        return m_constTable.load(barriers::acquire);
     }
-    void releaseConstTable(const table_type* table) const
+    void releaseConstTable(const table_type*, const read_token_type token) const
     {
-        const counted_table_type* evelop =
-                static_cast<const counted_table_type*>(table);
-        ++evelop->m_readCount;
+        m_readers.leave(token);
     }
-    table_type* acquireMutableTable()
+    table_type* acquireMutableTable(write_token_type& token)
     {
-        return m_mutableTable.aquire();
+        return acquireWritable(m_mutableTable, m_writers, token);
     }
-    void releaseMutableTable(table_type* table) const
+    void releaseMutableTable(table_type*, const write_token_type token) const
     {
-        const counted_table_type* envelop =
-                static_cast<const counted_table_type*>(table);
-        ++envelop->m_writeCount;
+        m_writers.leave(token);
     }
-    bool startRehashing(table_type*& ptr, cookie_type & cookie)
+    bool startRehashing(table_type*& ptr, cookie_type&)
     {
-        counted_table_type* envelop = m_mutableTable.m_ptr.load(
-                barriers::relaxed);
-        if (!envelop)
-        {
-            return false;
-        }
-        ptr = envelop;
-        bool res = m_mutableTable.tryReset(envelop, nullptr, cookie);
-        if (res)
-        {
-            // wait for pending writes
-            cookie.waitForWrites();
-        }
-        return res;
+        return closeWritable(m_mutableTable, m_writers, ptr);
     }
-    void finalizeRehashing(table_type* ptr, cookie_type & cookie)
+    void finalizeRehashing(table_type* ptr, cookie_type&)
     {
-        cookie_type readCookie;
-
-        counted_table_type* envelop = static_cast<counted_table_type*>(ptr);
-        envelop->m_readCount.store(0, barriers::relaxed);
-        envelop->m_writeCount.store(0, barriers::relaxed);
-        m_constTable.reset(cookie, envelop, readCookie);
-        m_mutableTable.m_count.store(0, barriers::relaxed);
-        m_mutableTable.m_ptr.store(envelop, barriers::release);
+        m_constTable.store(ptr, barriers::release);
+        m_mutableTable.store(ptr, barriers::release);
 
-        readCookie.waitForReads();
+        // the old table is freed by the caller as soon as its readers have left
+        m_readers.synchronize();
     }
     void cancelRehashing(table_type* ptr)
     {
-        counted_table_type* envelop = static_cast<counted_table_type*>(ptr);
-        m_mutableTable.m_ptr.store(envelop, barriers::release);
+        m_mutableTable.store(ptr, barriers::release);
     }
 private:
     table_ptr_type m_constTable;
     table_ptr_type m_mutableTable;
+    epoch_domain m_readers;
+    epoch_domain m_writers;
 
     table_allocator_type m_tableAllocator;
 };
 
-template<typename Base>
+template<typename Base, rehashing::type Rehashing = default_rehashing::value>
 class hash_table_base: protected Base
 {
 private:
@@ -538,12 +549,41 @@ public:
     typedef typename hash_table_type::table_type table_type;
     typedef typename hash_table_type::snapshot_type snapshot_type;
 
+    static const bool INCREMENTAL = Rehashing == rehashing::incremental;
+    // the table shrinks when the number of items drops below the percentage of
+    // the high watermark, 0 disables shrinking on erase
+    static const unsigned int DEFAULT_LOW_WATERMARK = 15;
+    // the number of keys of a batch whose home slots are fetched ahead of lookups
+    static const size_type PREFETCH_DISTANCE = 8;
+
+private:
+    typedef typename table_type::chunk_type chunk_type;
+
 public:
     hash_table_base(hash_table_type & hashTable, size_type watermark) :
-            base_type(hashTable, watermark)
+            base_type(hashTable, watermark),
+            m_minCapacity(
+                    table_type::indexing_type::roundCapacity(
+                            base_type::calcCapacity(watermark))),
+            m_lowWatermark(DEFAULT_LOW_WATERMARK),
+            m_resizing(0)
     {
 
     }
+    ~hash_table_base()
+    {
+        if (INCREMENTAL)
+        {
+            // the table of unfinished migration is not known to the base
+            table_type* ptr;
+            mutable_guard_type guard(getBase(), ptr);
+            table_type* next = ptr->m_next.load(barriers::acquire);
+            if (next)
+            {
+                base_type::deallocateTable(next);
+            }
+        }
+    }
 
 public:
     void getSnapshot(snapshot_type & snapshot) const
@@ -552,77 +592,117 @@ public:
         {
             const table_type* ptr;
             const_guard_type guard(getBase(), ptr);
-            tmp.reserve(ptr->m_size.load(barriers::relaxed));
+            // items are collected from one table
+            ptr = completeMigration(ptr);
+            tmp.reserve(ptr->m_size.exact());
             base_type::m_hashTable.getSnapshot_imp(*ptr, tmp);
         }
         snapshot.swap(tmp);
     }
     bool erase(const key_type & key)
     {
-        table_type* ptr;
-        mutable_guard_type guard(getBase(), ptr);
-
-        return base_type::m_hashTable.erase_impl(*ptr, key);
-    }
-    void checkWatermark()
-    {
-        while (isAboveWatermark())
+        bool res;
+        bool moved = false;
+        bool shrink = false;
         {
-            cookie_type cookie;
-            table_type * ptr;
-            bool res = base_type::startRehashing(ptr, cookie);
-            if (!res)
-            {
-                continue;
-            }
+            table_type* ptr;
+            mutable_guard_type guard(getBase(), ptr);
 
-            size_type next_capacity = ptr->m_capacity * 2;
-            table_type* next_ptr;
-
-            try
+            res = base_type::m_hashTable.erase_impl(*updateTable(ptr, key),
+                    key);
+            if (ptr->m_next.load(barriers::relaxed))
             {
-                next_ptr = base_type::allocateTable(next_capacity);
-                base_type::m_hashTable.rehash_impl(*ptr, *next_ptr);
+                // a shrinking table may not see inserts to finish the migration
+                moved = ptr->m_migrated.load(barriers::acquire)
+                        == ptr->m_chunkCount;
             }
-            catch (...)
+            else
             {
-                base_type::cancelRehashing(ptr);
-                throw;
+                shrink = res && isBelowLowWatermark(*ptr)
+                        && calcNextCapacity(*ptr, false);
             }
-            base_type::finalizeRehashing(next_ptr, cookie);
-            base_type::deallocateTable(ptr);
+        }
+        // the table cannot be resized while the guard is held
+        if (moved)
+        {
+            finishMigration();
+        }
+        else if (shrink)
+        {
+            resize(false);
+        }
+        return res;
+    }
+    void checkWatermark()
+    {
+        if (INCREMENTAL)
+        {
+            checkMigration();
+            return;
+        }
+        while (isAboveWatermark())
+        {
+            resize(false);
         }
     }
+    void shrinkToFit()
+    {
+        if (INCREMENTAL)
+        {
+            // an unfinished migration cannot be followed by another one
+            completeResize();
+            resize(true);
+            completeResize();
+        }
+        else
+        {
+            resize(true);
+        }
+    }
+    unsigned int getLowWatermark() const
+    {
+        return m_lowWatermark.load(barriers::relaxed);
+    }
+    void setLowWatermark(const unsigned int percent)
+    {
+        m_lowWatermark.store(percent, barriers::relaxed);
+    }
     size_type getCapacity() const
     {
         const table_type* ptr;
         const_guard_type guard(getBase(), ptr);
-        return ptr->m_highWatermark;
+        return lastTable(ptr)->m_highWatermark;
     }
     size_type size() const
     {
         const table_type* ptr;
         const_guard_type guard(getBase(), ptr);
-        return ptr->m_size.load(barriers::relaxed);
+        // while items move, each of them is counted by one of the tables
+        size_type size = ptr->m_size.exact();
+        for (ptr = ptr->m_next.load(barriers::acquire); ptr;
+                ptr = ptr->m_next.load(barriers::acquire))
+        {
+            size += ptr->m_size.exact();
+        }
+        return size;
     }
     size_type getUsed() const
     {
         const table_type* ptr;
         const_guard_type guard(getBase(), ptr);
-        return ptr->m_used;
+        return lastTable(ptr)->m_used.exact();
     }
     size_type getHighWatermark() const
     {
         const table_type* ptr;
         const_guard_type guard(getBase(), ptr);
-        return ptr->m_highWatermark;
+        return lastTable(ptr)->m_highWatermark;
     }
     bool isAboveWatermark()
     {
         const table_type* ptr;
         const_guard_type guard(getBase(), ptr);
-        return (ptr->m_used.load(barriers::relaxed)
-                + m_concurrentInsertions.get()) >= ptr->m_highWatermark;
+        return isAboveWatermark(*ptr);
     }
 protected:
     base_type& getBase()
@@ -633,8 +713,483 @@ protected:
     {
         return *static_cast<const base_type*>(this);
     }
+
+    //
+    // Incremental rehashing.
+    //
+    // When the table reaches a watermark the next table (see calcNextCapacity()) is published
+    // as m_next of the current one. Writers are paused only to drain pending writes,
+    // after that nobody modifies the old table. The items are moved by chunks of
+    // MIGRATION_CHUNK home slots: before a writer touches a key it moves the chunk of
+    // the key and one more chunk, then it modifies the new table. Lookups go to the
+    // new table if the chunk of the key is moved and to the old one otherwise.
+    // The first insert after the last chunk is moved replaces the old table with
+    // the new one.
+    //
+    // So an operation usually waits for two chunks instead of the whole table.
+    // Inserts still wait while the next table is allocated and when the next table
+    // reaches its own watermark before all items are moved.
+    //
+
+    // the table to look the key up in
+    const table_type* lookupTable(const table_type* ptr,
+                                  const key_type & key) const
+    {
+        if (INCREMENTAL && ptr->m_next.load(barriers::relaxed))
+        {
+            return lookupTableByHash(ptr,
+                    base_type::m_hashTable.hash_impl(key));
+        }
+        return ptr;
+    }
+    // the same for the hash of the key
+    const table_type* lookupTableByHash(const table_type* ptr,
+                                        const size_type hash) const
+    {
+        if (INCREMENTAL)
+        {
+            const table_type* next = ptr->m_next.load(barriers::acquire);
+            while (next && isMoved(*ptr, hash))
+            {
+                ptr = next;
+                next = ptr->m_next.load(barriers::acquire);
+            }
+        }
+        return ptr;
+    }
+
+    //
+    // Batched lookups.
+    //
+    // A lookup of a big table waits for a cache miss or two: the home slot and
+    // (for control bytes) its group. The keys of a batch are hashed and their home
+    // slots prefetched PREFETCH_DISTANCE keys ahead of the lookups, so the misses
+    // of several keys are in flight at once. All lookups share one acquisition
+    // of the table.
+    //
+    // lookup(table, i, hash) is called for each key i of the batch in order.
+    //
+    template<typename Lookup>
+    void lookupBatch(const key_type* keys,
+                     const size_type count,
+                     Lookup& lookup) const
+    {
+        const table_type* ptr;
+        const_guard_type guard(getBase(), ptr);
+
+        const table_type* tables[PREFETCH_DISTANCE];
+        size_type hashes[PREFETCH_DISTANCE];
+
+        for (size_type i = 0; i < count + PREFETCH_DISTANCE; ++i)
+        {
+            const size_type k = i % PREFETCH_DISTANCE;
+            if (i >= PREFETCH_DISTANCE)
+            {
+                lookup(*tables[k], i - PREFETCH_DISTANCE, hashes[k]);
+            }
+            if (i < count)
+            {
+                hashes[k] = base_type::m_hashTable.hash_impl(keys[i]);
+                tables[k] = lookupTableByHash(ptr, hashes[k]);
+                prefetch_home_slot(*tables[k], hashes[k]);
+            }
+        }
+    }
+    // the table to modify the key in
+    table_type* updateTable(table_type* ptr, const key_type & key)
+    {
+        if (INCREMENTAL)
+        {
+            table_type* next = ptr->m_next.load(barriers::acquire);
+            if (next)
+            {
+                moveChunk(*ptr, chunkOf(*ptr, key));
+                helpMigration(*ptr);
+                return next;
+            }
+        }
+        return ptr;
+    }
+    // the table new items go to
+    const table_type* lastTable(const table_type* ptr) const
+    {
+        for (const table_type* next = ptr->m_next.load(barriers::acquire);
+                next; next = ptr->m_next.load(barriers::acquire))
+        {
+            ptr = next;
+        }
+        return ptr;
+    }
+
+    // a batch of inserts is reserved at once, so the table grows straight to
+    // the capacity for all of them; each insert of the batch releases its share
+    void reserveInserts(const size_type count)
+    {
+        m_concurrentInsertions.addRef(count);
+        try
+        {
+            checkWatermark();
+        }
+        catch (...)
+        {
+            m_concurrentInsertions.release(count);
+            throw;
+        }
+    }
+    void releaseInserts(const size_type count)
+    {
+        m_concurrentInsertions.release(count);
+    }
+
+private:
+    // the checks read the shared totals of the counters, the slots of the
+    // counters are summed up only when the totals are close to the watermark
+    bool isAboveWatermark(const table_type& table) const
+    {
+        const size_type watermark = table.m_highWatermark;
+        if (table.m_used.approximate() + table.m_used.error()
+                + m_concurrentInsertions.getBound() < watermark)
+        {
+            return false;
+        }
+        return (table.m_used.exact() + m_concurrentInsertions.get())
+                >= watermark;
+    }
+    bool isBelowLowWatermark(const table_type& table) const
+    {
+        if (table.m_capacity <= m_minCapacity)
+        {
+            return false;
+        }
+        const size_type limit = table.m_highWatermark
+                * m_lowWatermark.load(barriers::relaxed);
+        const size_type size = table.m_size.approximate();
+        const size_type error = table.m_size.error();
+        if (size >= error && (size - error) * 100 >= limit)
+        {
+            return false;
+        }
+        return table.m_size.exact() * 100 < limit;
+    }
+    // the capacity of the next table or 0 if the table is not resized
+    size_type calcNextCapacity(const table_type& table, const bool fit) const
+    {
+        const size_type live = table.m_size.exact()
+                + m_concurrentInsertions.get();
+        if (isAboveWatermark(table))
+        {
+            // erased items leave tombstones which count in m_used until the table is
+            // rehashed, so under insert/erase churn the watermark is reached while the
+            // table is mostly empty; tombstones are not copied by rehashing so in that
+            // case the table is rebuilt with the same capacity instead of growing;
+            // a batch of inserts reserved at once (see reserveInserts()) may
+            // need more than twice the capacity
+            return live * 2 < table.m_highWatermark ?
+                    table.m_capacity :
+                    std::max(table.m_capacity * 2,
+                            table_type::indexing_type::roundCapacity(
+                                    base_type::calcCapacity(live)));
+        }
+        if (fit || isBelowLowWatermark(table))
+        {
+            // the items take a half of the high watermark of the smaller table
+            // so it does not grow back soon
+            const size_type capacity =
+                    table_type::indexing_type::roundCapacity(
+                            std::max(base_type::calcCapacity(live * 2),
+                                    m_minCapacity));
+            return capacity < table.m_capacity ? capacity : 0;
+        }
+        return 0;
+    }
+    // replaces the table with the table of calcNextCapacity(),
+    // in incremental mode the function only starts migration
+    void resize(const bool fit)
+    {
+        if (INCREMENTAL)
+        {
+            size_type capacity = 0;
+            size_type next_capacity = 0;
+            {
+                const table_type* ptr;
+                const_guard_type guard(getBase(), ptr);
+                if (!ptr->m_next.load(barriers::acquire))
+                {
+                    capacity = ptr->m_capacity;
+                    next_capacity = calcNextCapacity(*ptr, fit);
+                }
+            }
+            if (next_capacity)
+            {
+                startMigration(capacity, next_capacity, fit);
+            }
+            return;
+        }
+
+        cookie_type cookie;
+        table_type * ptr;
+        if (!base_type::startRehashing(ptr, cookie))
+        {
+            return;
+        }
+
+        const size_type next_capacity = calcNextCapacity(*ptr, fit);
+        if (!next_capacity)
+        {
+            // the table was resized by other thread
+            base_type::cancelRehashing(ptr);
+            return;
+        }
+
+        table_type* next_ptr;
+        try
+        {
+            next_ptr = base_type::allocateTable(next_capacity);
+            base_type::m_hashTable.rehash_impl(*ptr, *next_ptr);
+        }
+        catch (...)
+        {
+            base_type::cancelRehashing(ptr);
+            throw;
+        }
+        base_type::finalizeRehashing(next_ptr, cookie);
+        base_type::deallocateTable(ptr);
+    }
+    // moves all items to the last table and releases the old one
+    void completeResize()
+    {
+        {
+            const table_type* ptr;
+            const_guard_type guard(getBase(), ptr);
+            if (!ptr->m_next.load(barriers::acquire))
+            {
+                return;
+            }
+            completeMigration(ptr);
+        }
+        finishMigration();
+    }
+    size_type chunkOf(const table_type& table, const key_type & key) const
+    {
+        return table.homeSlot(base_type::m_hashTable.hash_impl(key))
+                / base_type::MIGRATION_CHUNK;
+    }
+    bool isMoved(const table_type& table, const size_type hash) const
+    {
+        return table.m_chunks[table.homeSlot(hash) / base_type::MIGRATION_CHUNK].load(
+                barriers::acquire) == base_type::chunk_moved;
+    }
+    // like the loop in checkWatermark() the function does not let an insert go
+    // beyond the watermark: it waits until the next table is published and until
+    // the migration is finished if the next table is about to grow in its turn
+    void checkMigration()
+    {
+        for (;;)
+        {
+            size_type capacity = 0;
+            size_type next_capacity = 0;
+            bool moved = false;
+            bool wait = false;
+            {
+                const table_type* ptr;
+                const_guard_type guard(getBase(), ptr);
+                const table_type* next = ptr->m_next.load(barriers::acquire);
+                if (next)
+                {
+                    moved = ptr->m_migrated.load(barriers::acquire)
+                            == ptr->m_chunkCount;
+                    wait = isAboveWatermark(*next);
+                    if (wait && !moved)
+                    {
+                        completeMigration(ptr);
+                        continue;
+                    }
+                }
+                else if (isAboveWatermark(*ptr))
+                {
+                    capacity = ptr->m_capacity;
+                    next_capacity = calcNextCapacity(*ptr, false);
+                    wait = true;
+                }
+            }
+            if (moved)
+            {
+                finishMigration();
+            }
+            else if (capacity)
+            {
+                startMigration(capacity, next_capacity, false);
+            }
+            if (!wait)
+            {
+                return;
+            }
+            cpu_relax();
+        }
+    }
+    void startMigration(const size_type capacity,
+                        const size_type next_capacity,
+                        const bool fit)
+    {
+        // the only thread allocates the next table, others go on with the current one
+        if (m_resizing.load(barriers::relaxed) || !m_resizing.atomic_cas(0, 1))
+        {
+            return;
+        }
+        const size_type count = base_type::calcChunkCount(capacity);
+        table_type* next = nullptr;
+        chunk_type* chunks = nullptr;
+        try
+        {
+            next = base_type::allocateTable(next_capacity);
+            chunks = base_type::allocateChunks(count);
+        }
+        catch (...)
+        {
+            if (next)
+            {
+                base_type::deallocateTable(next);
+            }
+            m_resizing.store(0, barriers::release);
+            throw;
+        }
+
+        cookie_type cookie;
+        table_type* ptr;
+        while (!base_type::startRehashing(ptr, cookie))
+        {
+            cpu_relax();
+        }
+        const size_type expected =
+                ptr->m_capacity == capacity ? calcNextCapacity(*ptr, fit) : 0;
+        if (!expected || ptr->m_next.load(barriers::relaxed)
+                || (expected < capacity) != (next_capacity < capacity))
+        {
+            // the table was resized by other thread
+            base_type::cancelRehashing(ptr);
+            base_type::deallocateChunks(chunks, count);
+            base_type::deallocateTable(next);
+        }
+        else
+        {
+            ptr->m_chunks = chunks;
+            ptr->m_chunkCount = count;
+            ptr->m_claimed.store(0, barriers::relaxed);
+            ptr->m_migrated.store(0, barriers::relaxed);
+            ptr->m_next.store(next, barriers::release);
+            base_type::cancelRehashing(ptr);
+        }
+        m_resizing.store(0, barriers::release);
+    }
+    void finishMigration()
+    {
+        // the flag is kept until the old table is released, so the next table does
+        // not start its own migration (and is not released) while readers of the old
+        // table may still follow m_next
+        if (m_resizing.load(barriers::relaxed) || !m_resizing.atomic_cas(0, 1))
+        {
+            // the next insert tries again
+            return;
+        }
+        cookie_type cookie;
+        table_type* ptr;
+        if (base_type::startRehashing(ptr, cookie))
+        {
+            table_type* next = ptr->m_next.load(barriers::acquire);
+            if (!next
+                    || ptr->m_migrated.load(barriers::acquire)
+                            != ptr->m_chunkCount)
+            {
+                // the table was replaced by other thread
+                base_type::cancelRehashing(ptr);
+            }
+            else
+            {
+                base_type::finalizeRehashing(next, cookie);
+                base_type::deallocateTable(ptr);
+            }
+        }
+        m_resizing.store(0, barriers::release);
+    }
+    // moves the chunk or waits while other thread moves it
+    void moveChunk(table_type& src, const size_type chunk) const
+    {
+        const chunk_type& state = src.m_chunks[chunk];
+        while (state.load(barriers::acquire) != base_type::chunk_moved)
+        {
+            if (!tryMoveChunk(src, chunk))
+            {
+                cpu_relax();
+            }
+        }
+    }
+    // moves the next chunk nobody has taken yet
+    void helpMigration(table_type& src) const
+    {
+        if (src.m_claimed.load(barriers::relaxed) < src.m_chunkCount)
+        {
+            const size_type chunk = src.m_claimed.fetch_add(1,
+                    barriers::relaxed);
+            if (chunk < src.m_chunkCount)
+            {
+                tryMoveChunk(src, chunk);
+            }
+        }
+    }
+    bool tryMoveChunk(table_type& src, const size_type chunk) const
+    {
+        chunk_type& state = src.m_chunks[chunk];
+        if (state.load(barriers::relaxed) != base_type::chunk_idle
+                || !state.atomic_cas(base_type::chunk_idle,
+                        base_type::chunk_moving))
+        {
+            return false;
+        }
+        const size_type first = chunk * base_type::MIGRATION_CHUNK;
+        const size_type last = std::min(
+                first + static_cast<size_type>(base_type::MIGRATION_CHUNK),
+                src.m_capacity);
+        size_type count;
+        try
+        {
+            count = base_type::m_hashTable.migrate_impl(src, first, last,
+                    *src.m_next.load(barriers::relaxed));
+        }
+        catch (...)
+        {
+            // items already copied are skipped next time
+            state.store(base_type::chunk_idle, barriers::release);
+            throw;
+        }
+        src.m_size.sub(count);
+        state.store(base_type::chunk_moved, barriers::release);
+        ++src.m_migrated;
+        return true;
+    }
+    // moves all remaining chunks, returns the table with all items
+    const table_type* completeMigration(const table_type* ptr) const
+    {
+        for (table_type* next = ptr->m_next.load(barriers::acquire); next;
+                next = ptr->m_next.load(barriers::acquire))
+        {
+            // the old table is not changed by writers any more
+            table_type& src = const_cast<table_type&>(*ptr);
+            for (size_type chunk = 0; chunk < src.m_chunkCount; ++chunk)
+            {
+                moveChunk(src, chunk);
+            }
+            ptr = next;
+        }
+        return ptr;
+    }
+
 protected:
     insert_guard_type m_concurrentInsertions;
+private:
+    // the table does not shrink below the initial capacity
+    const size_type m_minCapacity;
+    xtomic::quantum<unsigned int> m_lowWatermark;
+    xtomic::quantum<int> m_resizing;
 };
 
 template<typename HashTable, bool greedy>
@@ -652,11 +1207,12 @@ struct get_hash_table_family_type<HashTable, false>
     typedef wise_hash_table_base<HashTable> type;
 };
 
-template<typename HashTable, bool greedy>
+template<typename HashTable, bool greedy,
+        rehashing::type Rehashing = default_rehashing::value>
 struct get_hash_table_base_type
 {
     typedef typename get_hash_table_family_type<HashTable, greedy>::type family_type;
-    typedef hash_table_base<family_type> type;
+    typedef hash_table_base<family_type, Rehashing> type;
 };
 
 }
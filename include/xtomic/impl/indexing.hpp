@@ -0,0 +1,160 @@
+/*
+ * indexing.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: masha
+ */
+
+#ifndef INCLUDE_INDEXING_HPP_
+#define INCLUDE_INDEXING_HPP_
+
+#include "xtraits.hpp"
+#include <xtomic/aux/cppbasics.hpp>
+
+#include <cstddef>
+
+namespace xtomic
+{
+
+struct indexing
+{
+    enum type
+    {
+        // any capacity, the home slot is hash % capacity
+        modulo,
+        // capacity is a power of two, the home slot is taken from the mixed hash
+        power_of_two,
+        // power_of_two addressing plus a byte of hash bits per slot that is probed
+        // for a group of slots at once
+        control_bytes,
+    };
+};
+
+struct default_indexing: public integral_const<indexing::type, indexing::modulo>
+{
+
+};
+
+/// \cond HIDDEN_SYMBOLS
+
+// multiplicative (Fibonacci) hashing, the high bits of the product depend on
+// every bit of the hash so identity hashes of integral keys (e.g. std::hash<int>)
+// do not cluster; it costs a multiplication and a shift instead of a division
+// note: bits is never 0, tables have at least MIN_CAPACITY slots
+template<std::size_t = sizeof(std::size_t)>
+struct hash_mixer
+{
+    static std::size_t mix(const std::size_t hash, const unsigned int bits)
+    {
+        return (hash * 0x9e3779b97f4a7c15ULL) >> (64 - bits);
+    }
+};
+
+template<>
+struct hash_mixer<4>
+{
+    static std::size_t mix(const std::size_t hash, const unsigned int bits)
+    {
+        return (hash * 0x9e3779b9U) >> (32 - bits);
+    }
+};
+
+// the finalizer of MurmurHash3, every bit of the result depends on every bit
+// of the hash; sharded_hash_map takes the shard from the high bits of the
+// result, they have nothing in common with the bits hash_mixer gives to the
+// table of the shard
+template<std::size_t = sizeof(std::size_t)>
+struct hash_scrambler
+{
+    static std::size_t scramble(std::size_t hash)
+    {
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+};
+
+template<>
+struct hash_scrambler<4>
+{
+    static std::size_t scramble(std::size_t hash)
+    {
+        hash ^= hash >> 16;
+        hash *= 0x85ebca6bU;
+        hash ^= hash >> 13;
+        hash *= 0xc2b2ae35U;
+        hash ^= hash >> 16;
+        return hash;
+    }
+};
+
+template<indexing::type Indexing>
+struct table_indexing;
+
+template<>
+struct table_indexing<indexing::modulo>
+{
+    typedef std::size_t size_type;
+
+    static constexpr bool CONTROL_BYTES = false;
+
+    static size_type roundCapacity(const size_type capacity)
+    {
+        return capacity;
+    }
+    static unsigned int calcBits(const size_type /*capacity*/)
+    {
+        return 0;
+    }
+    static size_type homeSlot(const size_type hash,
+                              const size_type capacity,
+                              const unsigned int /*bits*/)
+    {
+        return hash % capacity;
+    }
+};
+
+template<>
+struct table_indexing<indexing::power_of_two>
+{
+    typedef std::size_t size_type;
+
+    static constexpr bool CONTROL_BYTES = false;
+
+    static size_type roundCapacity(const size_type capacity)
+    {
+        return static_cast<size_type>(1) << calcBits(capacity);
+    }
+    // the least number of bits to address the capacity
+    static unsigned int calcBits(const size_type capacity)
+    {
+        unsigned int bits = 0;
+        while ((static_cast<size_type>(1) << bits) < capacity)
+        {
+            ++bits;
+        }
+        return bits;
+    }
+    static size_type homeSlot(const size_type hash,
+                              const size_type /*capacity*/,
+                              const unsigned int bits)
+    {
+        return hash_mixer<>::mix(hash, bits);
+    }
+};
+
+template<>
+struct table_indexing<indexing::control_bytes> : public table_indexing<
+        indexing::power_of_two>
+{
+    static constexpr bool CONTROL_BYTES = true;
+};
+
+/// \endcond
+
+}
+
+#endif /* INCLUDE_INDEXING_HPP_ */
@@ -0,0 +1,274 @@
+/*
+ * magazine_buffer.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: masha
+ */
+
+#ifndef INCLUDE_MAGAZINE_BUFFER_HPP_
+#define INCLUDE_MAGAZINE_BUFFER_HPP_
+
+#include "thread_slot.hpp"
+#include <xtomic/quantum.hpp>
+#include <xtomic/aux/cppbasics.hpp>
+
+#include <cstddef>
+
+namespace xtomic
+{
+
+//
+// Per-thread node caches (magazines) in front of fixed_buffer or dynamic_buffer.
+//
+// Each thread maps to one of Slots magazines. A magazine is a private chain of
+// free nodes: newNode() takes a node from the magazine of the calling thread and
+// freeNode() puts it back. The magazine exchanges nodes with the free list of the
+// underlying buffer in batches of BATCH nodes with a single CAS, so most operations
+// do not touch the shared free list.
+//
+// A magazine is protected by a flag. The flag lives in the same cache line as
+// the magazine and normally is used by the same thread, so taking it is cheap.
+// If two threads share a magazine and meet, the loser goes directly to
+// the underlying buffer.
+//
+// When fixed sized buffer runs out of free nodes, newNode() looks through other
+// magazines before it gives up, so all nodes are still available to any thread.
+//
+template<typename Buffer, std::size_t Slots = 64>
+class magazine_buffer
+{
+public:
+    typedef Buffer buffer_type;
+    typedef typename buffer_type::value_type value_type;
+    typedef typename buffer_type::allocator_type allocator_type;
+    typedef typename buffer_type::node_type node_type;
+    typedef typename buffer_type::size_type size_type;
+    typedef magazine_buffer<Buffer, Slots> this_class;
+public:
+    static const bool fixed_size = buffer_type::fixed_size;
+
+private:
+    enum
+    {
+        BATCH = 32,
+    };
+
+    struct slot_type
+    {
+        xtomic::quantum<int> m_lock;
+        node_type* m_first;
+        size_type m_count;
+        pad_4_cache_line(m_pad);
+
+        slot_type() :
+                m_lock(0),
+                m_first(nullptr),
+                m_count(0)
+        {
+        }
+    };
+
+private:
+    magazine_buffer(const this_class&);
+    this_class& operator=(const this_class&);
+
+public:
+    magazine_buffer(size_type capacity) :
+            m_buff(capacity)
+    {
+    }
+
+    ~magazine_buffer()
+    {
+        for (std::size_t i = 0; i < Slots; ++i)
+        {
+            slot_type& slot = m_slots[i];
+            if (slot.m_first)
+            {
+                m_buff.releaseNodes(slot.m_first, lastNode(slot.m_first));
+            }
+        }
+    }
+#if XTOMIC_USE_CPP11
+    template<typename ... Args>
+    node_type* newNode(Args&&... data)
+#else
+    node_type* newNode(const value_type& data)
+#endif
+    {
+        node_type* p = take();
+        if (!p)
+        {
+            return nullptr;
+        }
+        try
+        {
+            m_buff.constructData(p, std_forward(Args, data));
+        }
+        catch (...)
+        {
+            put(p);
+            throw;
+        }
+        return p;
+    }
+#if !XTOMIC_USE_CPP11
+    node_type* newNode()
+    {
+        return newNode(value_type());
+    }
+#endif
+
+    void freeNode(node_type* p)
+    {
+        m_buff.destroyData(p);
+        put(p);
+    }
+
+    // Batch operations go directly to the underlying buffer, see fixed_buffer.
+    node_type* reserveNodes(size_type& count)
+    {
+        return m_buff.reserveNodes(count);
+    }
+#if XTOMIC_USE_CPP11
+    template<typename ... Args>
+    void constructData(node_type* p, Args&&... data)
+#else
+    void constructData(node_type* p, const value_type& data)
+#endif
+    {
+        m_buff.constructData(p, std_forward(Args, data));
+    }
+    void destroyData(node_type* p)
+    {
+        m_buff.destroyData(p);
+    }
+    void releaseNodes(node_type* first, node_type* last)
+    {
+        m_buff.releaseNodes(first, last);
+    }
+    void freeNodes(node_type* first, node_type* last)
+    {
+        m_buff.freeNodes(first, last);
+    }
+
+    size_type getCapacity() const
+    {
+        return m_buff.getCapacity();
+    }
+
+private:
+    static bool lock(slot_type& slot)
+    {
+        return slot.m_lock.load(barriers::relaxed) == 0
+                && slot.m_lock.atomic_cas(0, 1);
+    }
+    static void unlock(slot_type& slot)
+    {
+        slot.m_lock.store(0, barriers::release);
+    }
+    static node_type* lastNode(node_type* p)
+    {
+        while (p->m_next)
+        {
+            p = p->m_next;
+        }
+        return p;
+    }
+    slot_type& mySlot()
+    {
+        return m_slots[thread_slot() % Slots];
+    }
+    node_type* take()
+    {
+        node_type* p = nullptr;
+        slot_type& slot = mySlot();
+        if (!lock(slot))
+        {
+            size_type count = 1;
+            p = m_buff.reserveNodes(count);
+        }
+        else
+        {
+            if (!slot.m_first)
+            {
+                size_type count = BATCH;
+                slot.m_first = m_buff.reserveNodes(count);
+                slot.m_count = count;
+            }
+            p = slot.m_first;
+            if (p)
+            {
+                slot.m_first = p->m_next;
+                --slot.m_count;
+            }
+            unlock(slot);
+        }
+        if (!p && fixed_size)
+        {
+            p = scavenge();
+        }
+        return p;
+    }
+    void put(node_type* p)
+    {
+        slot_type& slot = mySlot();
+        if (!lock(slot))
+        {
+            m_buff.releaseNodes(p, p);
+            return;
+        }
+        p->m_next = slot.m_first;
+        slot.m_first = p;
+        if (++slot.m_count < 2 * BATCH)
+        {
+            unlock(slot);
+            return;
+        }
+        // the magazine is full, return a batch to the buffer
+        node_type* first = slot.m_first;
+        node_type* last = first;
+        for (size_type i = 1; i < BATCH; ++i)
+        {
+            last = last->m_next;
+        }
+        slot.m_first = last->m_next;
+        slot.m_count -= BATCH;
+        unlock(slot);
+        last->m_next = nullptr;
+        m_buff.releaseNodes(first, last);
+    }
+    // takes a node from any magazine
+    node_type* scavenge()
+    {
+        for (std::size_t i = 0; i < Slots; ++i)
+        {
+            slot_type& slot = m_slots[i];
+            if (!slot.m_first || !lock(slot))
+            {
+                continue;
+            }
+            node_type* p = slot.m_first;
+            if (p)
+            {
+                slot.m_first = p->m_next;
+                --slot.m_count;
+            }
+            unlock(slot);
+            if (p)
+            {
+                return p;
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    buffer_type m_buff;
+    pad_4_cache_line(m_pad);
+    slot_type m_slots[Slots];
+};
+
+}
+
+#endif /* INCLUDE_MAGAZINE_BUFFER_HPP_ */
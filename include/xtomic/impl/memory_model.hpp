@@ -10,6 +10,7 @@
 
 #include "hash_map_table_base.hpp"
 #include "hash_set_table_base.hpp"
+#include "rehashing.hpp"
 #include "xtraits.hpp"
 
 namespace xtomic
@@ -29,41 +30,43 @@ struct default_memory_model: public integral_const<memory_model::type,
 
 };
 
-template<typename HashTable, memory_model::type type>
+template<typename HashTable, memory_model::type type,
+        rehashing::type Rehashing = default_rehashing::value>
 struct hash_map_table_base_traits;
 
-template<typename HashTable, memory_model::type type>
+template<typename HashTable, memory_model::type type,
+        rehashing::type Rehashing = default_rehashing::value>
 struct hash_set_table_base_traits;
 
-template<typename HashTable>
-struct hash_map_table_base_traits<HashTable, memory_model::greedy> :
+template<typename HashTable, rehashing::type Rehashing>
+struct hash_map_table_base_traits<HashTable, memory_model::greedy, Rehashing> :
                                                                      public get_hash_map_table_base_type<
                                                                              HashTable,
-                                                                             true>
+                                                                             true, Rehashing>
 {
 };
 
-template<typename HashTable>
-struct hash_map_table_base_traits<HashTable, memory_model::wise> :
+template<typename HashTable, rehashing::type Rehashing>
+struct hash_map_table_base_traits<HashTable, memory_model::wise, Rehashing> :
                                                                    public get_hash_map_table_base_type<
                                                                            HashTable,
-                                                                           false>
+                                                                           false, Rehashing>
 {
 };
 
-template<typename HashTable>
-struct hash_set_table_base_traits<HashTable, memory_model::greedy> :
+template<typename HashTable, rehashing::type Rehashing>
+struct hash_set_table_base_traits<HashTable, memory_model::greedy, Rehashing> :
                                                                      public get_hash_set_table_base_type<
                                                                              HashTable,
-                                                                             true>
+                                                                             true, Rehashing>
 {
 };
 
-template<typename HashTable>
-struct hash_set_table_base_traits<HashTable, memory_model::wise> :
+template<typename HashTable, rehashing::type Rehashing>
+struct hash_set_table_base_traits<HashTable, memory_model::wise, Rehashing> :
                                                                    public get_hash_set_table_base_type<
                                                                            HashTable,
-                                                                           false>
+                                                                           false, Rehashing>
 {
 };
 
@@ -0,0 +1,126 @@
+/*
+ * numa.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: masha
+ */
+
+#ifndef INCLUDE_NUMA_HPP_
+#define INCLUDE_NUMA_HPP_
+
+#include <xtomic/aux/cppbasics.hpp>
+
+#include <cstddef>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+namespace xtomic
+{
+
+//
+// Minimal NUMA support on top of raw system calls, libnuma is not required.
+// If the kernel does not support NUMA system calls the machine is treated as
+// a single node one.
+//
+struct numa
+{
+    enum
+    {
+        MAX_NODES = 64,      // nodes above are folded
+        REFRESH_PERIOD = 256,   // number of calls to currentNode() between getcpu() calls
+    };
+
+    // number of memory nodes available for the process
+    static std::size_t nodeCount()
+    {
+        static const std::size_t count = queryNodeCount();
+        return count;
+    }
+
+    // node of the CPU the calling thread runs on. The value is cached per thread
+    // and refreshed periodically, threads seldom move from node to node.
+    static std::size_t currentNode()
+    {
+        static __thread std::size_t node = 0;
+        static __thread unsigned int calls = 0;
+        if (calls++ % REFRESH_PERIOD == 0)
+        {
+            node = queryCurrentNode();
+        }
+        return node;
+    }
+
+    // asks the kernel to place pages of the range on the node, pages that
+    // are already touched are moved. The range is shrunk to page bounds.
+    static void bindMemory(void* addr, std::size_t len, std::size_t node)
+    {
+        if (nodeCount() < 2)
+        {
+            return;
+        }
+        const std::size_t pageSize = static_cast<std::size_t>(sysconf(
+                _SC_PAGESIZE));
+        std::size_t first = reinterpret_cast<std::size_t>(addr);
+        std::size_t last = first + len;
+        first = (first + pageSize - 1) & ~(pageSize - 1);
+        last &= ~(pageSize - 1);
+        if (first >= last)
+        {
+            return;
+        }
+        unsigned long mask = 1UL << node;
+        // errors are ignored, the memory just stays where it is
+        syscall(SYS_mbind, first, last - first, MPOL_PREFERRED, &mask,
+                sizeof(mask) * 8, MPOL_MF_MOVE);
+    }
+
+private:
+    // see linux/mempolicy.h
+    enum
+    {
+        MPOL_PREFERRED = 1,
+        MPOL_MF_MOVE = 1 << 1,
+        MPOL_F_MEMS_ALLOWED = 1 << 2,
+    };
+
+    static std::size_t queryNodeCount()
+    {
+        enum
+        {
+            BITS = sizeof(unsigned long) * 8,
+            WORDS = 1024 / BITS,
+        };
+        unsigned long mask[WORDS] = { };
+        int mode = 0;
+        if (syscall(SYS_get_mempolicy, &mode, mask, WORDS * BITS, 0,
+                MPOL_F_MEMS_ALLOWED) != 0)
+        {
+            return 1;
+        }
+        std::size_t count = 1;
+        for (std::size_t i = 0; i < WORDS * BITS; ++i)
+        {
+            if (mask[i / BITS] & (1UL << (i % BITS)))
+            {
+                count = i + 1;
+            }
+        }
+        return count < MAX_NODES ? count : static_cast<std::size_t>(MAX_NODES);
+    }
+
+    static std::size_t queryCurrentNode()
+    {
+        unsigned int cpu = 0;
+        unsigned int node = 0;
+        if (nodeCount() < 2
+                || syscall(SYS_getcpu, &cpu, &node, nullptr) != 0)
+        {
+            return 0;
+        }
+        return node % nodeCount();
+    }
+};
+
+}
+
+#endif /* INCLUDE_NUMA_HPP_ */
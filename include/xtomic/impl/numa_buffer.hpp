@@ -0,0 +1,268 @@
+/*
+ * numa_buffer.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: masha
+ */
+
+#ifndef INCLUDE_NUMA_BUFFER_HPP_
+#define INCLUDE_NUMA_BUFFER_HPP_
+
+#include "buffer_base.hpp"
+#include "numa.hpp"
+#include <xtomic/aux/cppbasics.hpp>
+
+#include <cstddef>
+
+namespace xtomic
+{
+
+//
+// Buffer with a pool of free nodes per NUMA node. A thread takes nodes from
+// the pool of the node it runs on.
+//
+// Fixed sized buffer allocates all nodes in one block as fixed_buffer does, splits
+// the block into equal slices and asks the kernel to place each slice on its own
+// node. A freed node always returns to the pool of its slice, so nodes never move
+// between pools. If the local pool is empty, nodes are taken from other pools.
+//
+// Dynamic sized buffer allocates missing nodes in the calling thread, so the first
+// touch places them on the local node. There is no cheap way to find where a node
+// lives, so freed nodes go to the pool of the freeing thread.
+//
+// On a single node machine the buffer has one pool and works as fixed_buffer
+// (dynamic_buffer) does.
+//
+template<typename T, typename Allocator, bool FixedSize>
+class numa_buffer
+{
+public:
+    typedef T value_type;
+    typedef Allocator allocator_type;
+    typedef numa_buffer<value_type, allocator_type, FixedSize> this_class;
+    typedef buffer_base<this_class> base_class;
+    typedef typename base_class::node_type node_type;
+    typedef typename base_class::size_type size_type;
+public:
+    static const bool fixed_size = FixedSize;
+
+private:
+    struct pool_type
+    {
+        base_class m_base;
+        pad_4_cache_line(m_pad);
+    };
+
+private:
+    numa_buffer(const this_class&);
+    this_class& operator=(const this_class&);
+
+public:
+    numa_buffer(size_type capacity) :
+            m_nodeCount(numa::nodeCount()),
+            m_capacity(fixed_size ? capacity : 0),
+            m_slice(0),
+            m_reserved(nullptr)
+    {
+        if (fixed_size)
+        {
+            m_slice = (m_capacity + m_nodeCount - 1) / m_nodeCount;
+            m_reserved = m_pools[0].m_base.allocate_nodes(m_capacity);
+            for (size_type node = 0; node < m_nodeCount; ++node)
+            {
+                const size_type first = node * m_slice;
+                const size_type last = first + m_slice < m_capacity ?
+                        first + m_slice : m_capacity;
+                if (first >= last)
+                {
+                    break;
+                }
+                // before the nodes are touched
+                numa::bindMemory(m_reserved + first,
+                        (last - first) * sizeof(node_type), node);
+                for (size_type i = first; i < last; ++i)
+                {
+                    m_pools[node].m_base.pushFreeNode(m_reserved + i);
+                }
+            }
+        }
+        else
+        {
+            base_class& base = localPool();
+            for (size_type i = 0; i < capacity; ++i)
+            {
+                base.pushFreeNode(base.allocate_nodes(1));
+            }
+        }
+    }
+
+    ~numa_buffer()
+    {
+        if (fixed_size)
+        {
+            m_pools[0].m_base.deallocate_nodes(m_reserved, m_capacity);
+            return;
+        }
+        for (size_type node = 0; node < m_nodeCount; ++node)
+        {
+            base_class& base = m_pools[node].m_base;
+            node_type* p = base.popFreeNode();
+            while (p)
+            {
+                base.deallocate_nodes(p, 1);
+                p = base.popFreeNode();
+            }
+        }
+    }
+#if XTOMIC_USE_CPP11
+    template<typename ... Args>
+    node_type* newNode(Args&&... data)
+#else
+    node_type* newNode(const value_type& data)
+#endif
+    {
+        size_type count = 1;
+        node_type* p = reserveNodes(count);
+        if (!p)
+        {
+            return nullptr;
+        }
+        try
+        {
+            constructData(p, std_forward(Args, data));
+        }
+        catch (...)
+        {
+            releaseNodes(p, p);
+            throw;
+        }
+        return p;
+    }
+#if !XTOMIC_USE_CPP11
+    node_type* newNode()
+    {
+        return newNode(value_type());
+    }
+#endif
+
+    void freeNode(node_type* p)
+    {
+        destroyData(p);
+        releaseNodes(p, p);
+    }
+
+    // Batch operations, see fixed_buffer.
+    // Dynamic sized buffer always reserves requested number of nodes.
+    node_type* reserveNodes(size_type& count)
+    {
+        const size_type local = numa::currentNode();
+        size_type reserved = count;
+        node_type* first = m_pools[local].m_base.popFreeNodes(reserved);
+        if (fixed_size)
+        {
+            // borrow from other nodes only if there is nothing local
+            for (size_type i = 1; !first && i < m_nodeCount; ++i)
+            {
+                reserved = count;
+                first = m_pools[(local + i) % m_nodeCount].m_base.popFreeNodes(
+                        reserved);
+            }
+            count = first ? reserved : 0;
+            return first;
+        }
+        base_class& base = m_pools[local].m_base;
+        try
+        {
+            for (; reserved < count; ++reserved)
+            {
+                node_type* node = base.allocate_nodes(1);
+                node->m_next = first;
+                first = node;
+            }
+        }
+        catch (...)
+        {
+            if (first)
+            {
+                node_type* last = first;
+                while (last->m_next)
+                {
+                    last = last->m_next;
+                }
+                base.pushFreeNodes(first, last);
+            }
+            throw;
+        }
+        return first;
+    }
+#if XTOMIC_USE_CPP11
+    template<typename ... Args>
+    void constructData(node_type* p, Args&&... data)
+#else
+    void constructData(node_type* p, const value_type& data)
+#endif
+    {
+        m_pools[0].m_base.constructData(p, std_forward(Args, data));
+    }
+    void destroyData(node_type* p)
+    {
+        m_pools[0].m_base.destroyData(p);
+    }
+    void releaseNodes(node_type* first, node_type* last)
+    {
+        if (!fixed_size)
+        {
+            localPool().pushFreeNodes(first, last);
+            return;
+        }
+        // the chain is split into runs of nodes from the same slice
+        last->m_next = nullptr;
+        while (first)
+        {
+            const size_type node = homeNode(first);
+            node_type* end = first;
+            while (end->m_next && homeNode(end->m_next) == node)
+            {
+                end = end->m_next;
+            }
+            node_type* next = end->m_next;
+            m_pools[node].m_base.pushFreeNodes(first, end);
+            first = next;
+        }
+    }
+    void freeNodes(node_type* first, node_type* last)
+    {
+        for (node_type* p = first; p != last; p = p->m_next)
+        {
+            destroyData(p);
+        }
+        destroyData(last);
+        releaseNodes(first, last);
+    }
+
+    size_type getCapacity() const
+    {
+        return m_capacity;
+    }
+
+private:
+    base_class& localPool()
+    {
+        return m_pools[numa::currentNode()].m_base;
+    }
+    size_type homeNode(const node_type* p) const
+    {
+        return static_cast<size_type>(p - m_reserved) / m_slice;
+    }
+
+private:
+    pool_type m_pools[numa::MAX_NODES];
+    const size_type m_nodeCount;
+    const size_type m_capacity;
+    size_type m_slice;
+    node_type* m_reserved;
+};
+
+}
+
+#endif /* INCLUDE_NUMA_BUFFER_HPP_ */
@@ -78,6 +78,25 @@ public:
         --m_lock;
         return p;
     }
+    // pops up to count nodes at once, see stack_base_aba::atomic_pop()
+    node_type* atomic_pop(std::size_t& count)
+    {
+        // acquire consumer lock
+        const counter_type lock = ++m_lock;
+        const std::size_t requested = count;
+
+        // attempt to pop items
+        node_type* p = m_consumerEnd.atomic_pop(count);
+        if (!p && lock == 1)
+        {
+            p = m_producerEnd.atomic_removeHead();
+            m_consumerEnd.atomic_setHead(p);
+            count = requested;
+            p = m_consumerEnd.atomic_pop(count);
+        }
+        --m_lock;
+        return p;
+    }
 private:
     xtomic::quantum<counter_type> m_lock;
 public:
@@ -106,6 +125,42 @@ public:
         }
         return p;
     }
+    // pops up to count nodes at once, the producer end is drained at most once
+    // at exit count holds number of popped nodes, the chain is terminated by nullptr
+    node_type* atomic_pop(std::size_t& count)
+    {
+        node_type* first = nullptr;
+        node_type* last = nullptr;
+        std::size_t popped = 0;
+        bool drained = false;
+        while (popped < count)
+        {
+            node_type* p = m_consumerEnd.pop();
+            if (!p)
+            {
+                if (drained)
+                {
+                    break;
+                }
+                drained = true;
+                p = inverter_type::invert(m_producerEnd.atomic_removeHead());
+                m_consumerEnd.setHead(p);
+                continue;
+            }
+            if (last)
+            {
+                last->m_next = p;
+            }
+            else
+            {
+                first = p;
+            }
+            last = p;
+            ++popped;
+        }
+        count = popped;
+        return first;
+    }
 public:
     stack_type m_producerEnd;
     stack_type m_consumerEnd;
@@ -159,6 +214,16 @@ public:
     {
         return base_class::atomic_pop();
     }
+    // pushes the chain first->...->last, first is the most recent item
+    void atomic_push(node_type* first, node_type* last)
+    {
+        base_class::m_producerEnd.atomic_push(first, last);
+    }
+    // pops up to count nodes, at exit count holds number of popped nodes
+    node_type* atomic_pop(std::size_t& count)
+    {
+        return base_class::atomic_pop(count);
+    }
     void push(node_type* p)
     {
         base_class::m_producerEnd.push(p);
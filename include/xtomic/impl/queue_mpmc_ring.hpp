@@ -0,0 +1,353 @@
+/*
+ * queue_mpmc_ring.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: masha
+ */
+
+#ifndef INCLUDE_QUEUE_MPMC_RING_HPP_
+#define INCLUDE_QUEUE_MPMC_RING_HPP_
+
+#include <xtomic/aux/cppbasics.hpp>
+#include <xtomic/quantum.hpp>
+
+#include <memory>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+
+namespace xtomic
+{
+
+//
+// Bounded many producers many consumers ring buffer.
+//
+// The buffer is an array of cells, each cell holds a sequence number besides data.
+// For a cell with index i the sequence number is:
+//  - pos       when the cell is free and it is awaited by a producer at position pos
+//  - pos + 1   when the cell holds data pushed at position pos
+// where pos is a free running position of the producer (consumer) and
+// i == pos & m_mask.
+//
+// A producer claims a cell by advancing m_enqueuePos with a single CAS, constructs
+// the data and publishes it by storing the sequence number. A consumer does the
+// same with m_dequeuePos and releases the cell for the next lap of producers.
+// So there are no linked nodes and no free list, each operation touches its
+// position counter and one cell.
+//
+// If the data cannot be constructed the producer publishes its cell as skipped,
+// consumers release a skipped cell without popping it. If the data cannot be
+// assigned to the receiver the consumer drops it and releases its cells. So the
+// item is lost but the ring goes on.
+//
+// Capacity is rounded up to the nearest power of two.
+//
+template<typename T, typename Allocator = std::allocator<T> >
+class queue_mpmc_ring
+{
+public:
+    static const bool many_producers = true;
+    static const bool many_consumers = true;
+    static const bool fixed_size = true;
+    static const bool wait_free = false;
+
+public:
+    typedef T value_type;
+    typedef std::size_t size_type;
+private:
+    typedef queue_mpmc_ring<T, Allocator> this_class;
+    typedef std::ptrdiff_t difference_type;
+
+    struct cell_type
+    {
+        xtomic::quantum<size_type> m_sequence;
+        // the cell is published without data
+        bool m_skipped;
+        char m_data[sizeof(T)] align_as(T);
+
+        T* getData()
+        {
+            return reinterpret_cast<T*>(m_data);
+        }
+    };
+
+    typedef Allocator data_allocator_type;
+    typedef typename Allocator::template rebind<cell_type>::other cell_allocator_type;
+
+    struct position_type
+    {
+        xtomic::quantum<size_type> m_pos;
+        pad_4_cache_line(m_pad);
+
+        position_type() :
+                m_pos(0)
+        {
+        }
+    };
+
+private:
+    queue_mpmc_ring(const this_class&);
+    this_class& operator=(const this_class&);
+
+public:
+    queue_mpmc_ring(size_type capacity) :
+            m_capacity(calcCapacity(capacity)),
+            m_mask(m_capacity - 1),
+            m_buffer(nullptr)
+    {
+        m_buffer = m_cellAllocator.allocate(m_capacity);
+        for (size_type i = 0; i < m_capacity; ++i)
+        {
+            ::new (static_cast<void*>(&m_buffer[i].m_sequence)) xtomic::quantum<
+                    size_type>(i);
+            m_buffer[i].m_skipped = false;
+        }
+    }
+
+    ~queue_mpmc_ring()
+    {
+        const size_type head = m_enqueuePos.m_pos.load(barriers::relaxed);
+        for (size_type pos = m_dequeuePos.m_pos.load(barriers::relaxed);
+                pos != head; ++pos)
+        {
+            cell_type& cell = m_buffer[pos & m_mask];
+            if (!cell.m_skipped)
+            {
+                m_dataAllocator.destroy(cell.getData());
+            }
+        }
+        m_cellAllocator.deallocate(m_buffer, m_capacity);
+    }
+
+#if XTOMIC_USE_CPP11
+    template<typename ... Args>
+    bool push(Args&&... data)
+#else
+    bool push(const value_type& data)
+#endif
+    {
+        size_type count = 1;
+        const size_type pos = claim(m_enqueuePos, 0, count);
+        if (!count)
+        {
+            return false;
+        }
+        cell_type& cell = m_buffer[pos & m_mask];
+        try
+        {
+            m_dataAllocator.construct(cell.getData(), std_forward(Args, data));
+        }
+        catch (...)
+        {
+            skip(pos, 1);
+            throw;
+        }
+        cell.m_sequence.store(pos + 1, barriers::release);
+        return true;
+    }
+    bool pop(T & val)
+    {
+        for (;;)
+        {
+            size_type count = 1;
+            const size_type pos = claim(m_dequeuePos, 1, count);
+            if (!count)
+            {
+                return false;
+            }
+            cell_type& cell = m_buffer[pos & m_mask];
+            const bool skipped = cell.m_skipped;
+            if (!skipped)
+            {
+                try
+                {
+                    val = std_move(*cell.getData());
+                }
+                catch (...)
+                {
+                    discard(pos, 1);
+                    throw;
+                }
+                m_dataAllocator.destroy(cell.getData());
+            }
+            release(pos);
+            if (!skipped)
+            {
+                return true;
+            }
+        }
+    }
+    // all cells for the range are claimed by a single CAS
+    template<typename ForwardIterator>
+    size_type push_bulk(ForwardIterator first, ForwardIterator last)
+    {
+        size_type count = static_cast<size_type>(std::distance(first, last));
+        if (!count)
+        {
+            return 0;
+        }
+        const size_type pos = claim(m_enqueuePos, 0, count);
+        for (size_type i = 0; i < count; ++i, ++first)
+        {
+            cell_type& cell = m_buffer[(pos + i) & m_mask];
+            try
+            {
+                m_dataAllocator.construct(cell.getData(), *first);
+            }
+            catch (...)
+            {
+                // the rest of the claimed cells are skipped as well
+                skip(pos + i, count - i);
+                throw;
+            }
+            cell.m_sequence.store(pos + i + 1, barriers::release);
+        }
+        return count;
+    }
+    // all cells for the range are claimed by a single CAS
+    template<typename OutputIterator>
+    size_type pop_bulk(OutputIterator out, size_type max)
+    {
+        size_type popped = 0;
+        while (popped < max)
+        {
+            size_type count = max - popped;
+            const size_type pos = claim(m_dequeuePos, 1, count);
+            if (!count)
+            {
+                break;
+            }
+            for (size_type i = 0; i < count; ++i)
+            {
+                cell_type& cell = m_buffer[(pos + i) & m_mask];
+                if (!cell.m_skipped)
+                {
+                    try
+                    {
+                        *out = std_move(*cell.getData());
+                        ++out;
+                    }
+                    catch (...)
+                    {
+                        // the rest of the claimed cells are dropped as well
+                        discard(pos + i, count - i);
+                        throw;
+                    }
+                    m_dataAllocator.destroy(cell.getData());
+                    ++popped;
+                }
+                release(pos + i);
+            }
+        }
+        return popped;
+    }
+    size_type size() const
+    {
+        // the consumer position is loaded first so the result never underflows
+        const size_type tail = m_dequeuePos.m_pos.load(barriers::acquire);
+        const size_type head = m_enqueuePos.m_pos.load(barriers::acquire);
+        return std::min(head - tail, m_capacity);
+    }
+    size_type getCapacity() const
+    {
+        return m_capacity;
+    }
+private:
+    // publishes count claimed cells from pos without data
+    void skip(const size_type pos, const size_type count)
+    {
+        for (size_type i = 0; i < count; ++i)
+        {
+            cell_type& cell = m_buffer[(pos + i) & m_mask];
+            cell.m_skipped = true;
+            cell.m_sequence.store(pos + i + 1, barriers::release);
+        }
+    }
+    // drops the data of count claimed cells from pos and releases them
+    void discard(const size_type pos, const size_type count)
+    {
+        for (size_type i = 0; i < count; ++i)
+        {
+            cell_type& cell = m_buffer[(pos + i) & m_mask];
+            if (!cell.m_skipped)
+            {
+                m_dataAllocator.destroy(cell.getData());
+            }
+            release(pos + i);
+        }
+    }
+    // returns the popped cell to producers of the next lap
+    void release(const size_type pos)
+    {
+        cell_type& cell = m_buffer[pos & m_mask];
+        cell.m_skipped = false;
+        cell.m_sequence.store(pos + m_capacity, barriers::release);
+    }
+    static size_type calcCapacity(size_type capacity)
+    {
+        size_type result = 1;
+        while (result < capacity)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    // claims up to count consecutive cells which sequence number is equal to pos + lag,
+    // lag is 0 for producers and 1 for consumers.
+    // at exit count holds number of claimed cells, the result is the first claimed position
+    size_type claim(position_type& position, const size_type lag, size_type& count)
+    {
+        size_type pos = position.m_pos.load(barriers::relaxed);
+        for (;;)
+        {
+            const size_type seq = m_buffer[pos & m_mask].m_sequence.load(
+                    barriers::acquire);
+            const difference_type diff = static_cast<difference_type>(seq)
+                    - static_cast<difference_type>(pos + lag);
+            if (diff < 0)
+            {
+                // the ring is full (empty)
+                count = 0;
+                return pos;
+            }
+            if (diff > 0)
+            {
+                // the position has been claimed by an other thread
+                pos = position.m_pos.load(barriers::relaxed);
+                continue;
+            }
+
+            // the cell at pos is ready, find out how many cells are ready after it
+            size_type ready = 1;
+            const size_type limit = std::min(count, m_capacity);
+            while (ready < limit
+                    && m_buffer[(pos + ready) & m_mask].m_sequence.load(
+                            barriers::acquire) == pos + ready + lag)
+            {
+                ++ready;
+            }
+            if (position.m_pos.atomic_cas(pos, pos + ready))
+            {
+                count = ready;
+                return pos;
+            }
+            pos = position.m_pos.load(barriers::relaxed);
+        }
+    }
+private:
+    // read only data
+    const size_type m_capacity;
+    const size_type m_mask;
+    cell_type* m_buffer;
+    cell_allocator_type m_cellAllocator;
+    data_allocator_type m_dataAllocator;
+
+    pad_4_cache_line(m_pad);
+    position_type m_enqueuePos;
+    position_type m_dequeuePos;
+};
+
+}
+
+#endif /* INCLUDE_QUEUE_MPMC_RING_HPP_ */
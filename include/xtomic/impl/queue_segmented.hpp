@@ -0,0 +1,478 @@
+/*
+ * queue_segmented.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: masha
+ */
+
+#ifndef INCLUDE_QUEUE_SEGMENTED_HPP_
+#define INCLUDE_QUEUE_SEGMENTED_HPP_
+
+#include "aba_ptr.hpp"
+#include "dynamic_buffer.hpp"
+#include <xtomic/aux/cppbasics.hpp>
+#include <xtomic/quantum.hpp>
+
+#include <memory>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+
+namespace xtomic
+{
+
+//
+// Unbounded many producers many consumers queue built from a linked list of
+// fixed size segments.
+//
+// Each segment is an array of cells with its own enqueue and dequeue indexes.
+// A producer claims a cell by fetch_add on the enqueue index of the tail segment,
+// a consumer does the same with the dequeue index of the head segment. A consumer
+// that comes to a cell before its producer abandons the cell, the producer then
+// claims the next one. Cells are used once, when the tail segment is exhausted
+// a new segment is linked after it.
+//
+// Segments are taken from and returned to a pool (dynamic_buffer) so in the steady
+// state the queue does not call allocator at all.
+//
+// A segment is recycled when neither head nor tail points to it and no thread
+// works with it. To track that the head and tail pointers count acquisitions
+// (aba_ptr counter) and each segment counts releases:
+//  - m_refs starts with 2 * BIAS, one BIAS for the head and one for the tail
+//  - each release decrements m_refs
+//  - when head (tail) moves to the next segment the number of acquisitions
+//    minus BIAS is added to m_refs of the previous one
+// m_refs reaches zero when both pointers left the segment and all acquisitions
+// have been released.
+//
+template<typename T, typename Allocator = std::allocator<T>,
+        std::size_t SegmentSize = 1024>
+class queue_segmented
+{
+public:
+    static const bool many_producers = true;
+    static const bool many_consumers = true;
+    static const bool fixed_size = false;
+    static const bool wait_free = false;
+
+public:
+    typedef T value_type;
+    typedef std::size_t size_type;
+
+private:
+    typedef queue_segmented<T, Allocator, SegmentSize> this_class;
+
+    // cell states
+    enum
+    {
+        empty,      // initial state
+        writing,    // a producer is constructing data
+        full,       // data is ready
+        taken,      // data has been consumed or the cell has been abandoned
+    };
+
+    struct cell_type
+    {
+        xtomic::quantum<size_type> m_state;
+        char m_data[sizeof(T)] align_as(T);
+
+        T* getData()
+        {
+            return reinterpret_cast<T*>(m_data);
+        }
+    };
+
+    struct segment_type
+    {
+        static const size_type BIAS = static_cast<size_type>(1)
+                << (sizeof(size_type) * 8 - 2);
+
+        xtomic::quantum<size_type> m_enqueueIdx;
+        pad_4_cache_line(m_pad1);
+        xtomic::quantum<size_type> m_dequeueIdx;
+        pad_4_cache_line(m_pad2);
+        xtomic::quantum<size_type> m_refs;
+        pad_4_cache_line(m_pad3);
+        xtomic::quantum<segment_type*> m_next;
+        size_type m_id;
+        pad_4_cache_line(m_pad4);
+        cell_type m_cells[SegmentSize];
+
+        segment_type() :
+                m_enqueueIdx(0),
+                m_dequeueIdx(0),
+                m_refs(2 * BIAS),
+                m_next(nullptr),
+                m_id(0)
+        {
+            for (size_type i = 0; i < SegmentSize; ++i)
+            {
+                m_cells[i].m_state.store(empty, barriers::relaxed);
+            }
+        }
+    };
+
+    typedef dynamic_buffer<segment_type, Allocator> pool_type;
+    typedef typename pool_type::node_type pool_node_type;
+    typedef aba_ptr<segment_type> segment_ptr;
+    typedef Allocator data_allocator_type;
+
+    struct end_type
+    {
+        volatile segment_ptr m_ptr;
+        pad_4_cache_line(m_pad);
+    };
+
+private:
+    queue_segmented(const this_class&);
+    this_class& operator=(const this_class&);
+
+public:
+    queue_segmented(size_type initialCapacity) :
+            m_pool(initialCapacity / SegmentSize + 1)
+    {
+        segment_type* seg = newSegment(0);
+        m_head.m_ptr.m_ptr = seg;
+        m_tail.m_ptr.m_ptr = seg;
+    }
+
+    ~queue_segmented()
+    {
+        // the tail might lag behind the head, move it to the end so the segments
+        // behind the head are recycled
+        segment_type* seg = m_tail.m_ptr.m_ptr;
+        for (segment_type* next = seg->m_next.load(barriers::relaxed); next;
+                next = seg->m_next.load(barriers::relaxed))
+        {
+            advance(m_tail, seg, next);
+            seg = next;
+        }
+
+        seg = m_head.m_ptr.m_ptr;
+        while (seg)
+        {
+            for (size_type i = 0; i < SegmentSize; ++i)
+            {
+                cell_type& cell = seg->m_cells[i];
+                if (cell.m_state.load(barriers::relaxed) == full)
+                {
+                    m_dataAllocator.destroy(cell.getData());
+                }
+            }
+            segment_type* next = seg->m_next.load(barriers::relaxed);
+            recycle(seg);
+            seg = next;
+        }
+    }
+
+#if XTOMIC_USE_CPP11
+    template<typename ... Args>
+    bool push(Args&&... data)
+#else
+    bool push(const value_type& data)
+#endif
+    {
+        for (;;)
+        {
+            segment_type* seg = acquire(m_tail);
+            const size_type idx = seg->m_enqueueIdx.fetch_add(1,
+                    barriers::relaxed);
+            if (idx < SegmentSize)
+            {
+                cell_type& cell = seg->m_cells[idx];
+                if (cell.m_state.atomic_cas(empty, writing))
+                {
+                    try
+                    {
+                        m_dataAllocator.construct(cell.getData(),
+                                std_forward(Args, data));
+                    }
+                    catch (...)
+                    {
+                        cell.m_state.store(taken, barriers::release);
+                        release(seg);
+                        throw;
+                    }
+                    cell.m_state.store(full, barriers::release);
+                    release(seg);
+                    return true;
+                }
+                // the cell has been abandoned by a consumer
+            }
+            else
+            {
+                appendSegment(seg);
+            }
+            release(seg);
+        }
+    }
+    bool pop(T & val)
+    {
+        for (;;)
+        {
+            segment_type* seg = acquire(m_head);
+            const size_type deq = seg->m_dequeueIdx.load(barriers::acquire);
+            if (deq < SegmentSize)
+            {
+                if (deq >= seg->m_enqueueIdx.load(barriers::acquire))
+                {
+                    // nothing has been pushed after deq so there is no next segment
+                    release(seg);
+                    return false;
+                }
+                const size_type idx = seg->m_dequeueIdx.fetch_add(1,
+                        barriers::relaxed);
+                if (idx < SegmentSize)
+                {
+                    cell_type& cell = seg->m_cells[idx];
+                    bool res = takeCell(cell);
+                    if (res)
+                    {
+                        val = std_move(*cell.getData());
+                        m_dataAllocator.destroy(cell.getData());
+                        cell.m_state.store(taken, barriers::relaxed);
+                    }
+                    release(seg);
+                    if (res)
+                    {
+                        return true;
+                    }
+                    continue;
+                }
+            }
+            // the segment is exhausted
+            segment_type* next = seg->m_next.load(barriers::acquire);
+            if (next)
+            {
+                advance(m_head, seg, next);
+            }
+            release(seg);
+            if (!next)
+            {
+                return false;
+            }
+        }
+    }
+    // a range of cells is claimed by a single fetch_add per segment
+    template<typename ForwardIterator>
+    size_type push_bulk(ForwardIterator first, ForwardIterator last)
+    {
+        const size_type count = static_cast<size_type>(std::distance(first,
+                last));
+        size_type pushed = 0;
+        while (pushed < count)
+        {
+            segment_type* seg = acquire(m_tail);
+            const size_type wanted = count - pushed;
+            const size_type idx = seg->m_enqueueIdx.fetch_add(wanted,
+                    barriers::relaxed);
+            const size_type end = std::min<size_type>(idx + wanted, SegmentSize);
+            for (size_type i = idx; i < end; ++i)
+            {
+                cell_type& cell = seg->m_cells[i];
+                if (!cell.m_state.atomic_cas(empty, writing))
+                {
+                    // the cell has been abandoned by a consumer
+                    continue;
+                }
+                try
+                {
+                    m_dataAllocator.construct(cell.getData(), *first);
+                }
+                catch (...)
+                {
+                    cell.m_state.store(taken, barriers::release);
+                    release(seg);
+                    throw;
+                }
+                cell.m_state.store(full, barriers::release);
+                ++first;
+                ++pushed;
+            }
+            if (idx + wanted > SegmentSize)
+            {
+                appendSegment(seg);
+            }
+            release(seg);
+        }
+        return count;
+    }
+    // a range of cells is claimed by a single fetch_add per segment
+    template<typename OutputIterator>
+    size_type pop_bulk(OutputIterator out, size_type max)
+    {
+        size_type popped = 0;
+        while (popped < max)
+        {
+            segment_type* seg = acquire(m_head);
+            const size_type deq = seg->m_dequeueIdx.load(barriers::acquire);
+            if (deq < SegmentSize)
+            {
+                const size_type enq = std::min<size_type>(
+                        seg->m_enqueueIdx.load(barriers::acquire),
+                        SegmentSize);
+                if (deq >= enq)
+                {
+                    release(seg);
+                    break;
+                }
+                const size_type wanted = std::min(max - popped, enq - deq);
+                const size_type idx = seg->m_dequeueIdx.fetch_add(wanted,
+                        barriers::relaxed);
+                const size_type end = std::min<size_type>(idx + wanted, SegmentSize);
+                for (size_type i = idx; i < end; ++i)
+                {
+                    cell_type& cell = seg->m_cells[i];
+                    if (takeCell(cell))
+                    {
+                        *out = std_move(*cell.getData());
+                        ++out;
+                        m_dataAllocator.destroy(cell.getData());
+                        cell.m_state.store(taken, barriers::relaxed);
+                        ++popped;
+                    }
+                }
+                release(seg);
+                continue;
+            }
+            // the segment is exhausted
+            segment_type* next = seg->m_next.load(barriers::acquire);
+            if (next)
+            {
+                advance(m_head, seg, next);
+            }
+            release(seg);
+            if (!next)
+            {
+                break;
+            }
+        }
+        return popped;
+    }
+    // approximate number of items: cells claimed by producers but not
+    // claimed by consumers yet
+    size_type size() const
+    {
+        this_class& This = const_cast<this_class&>(*this);
+        segment_type* tail = This.acquire(This.m_tail);
+        segment_type* head = This.acquire(This.m_head);
+        const size_type enq = tail->m_id * SegmentSize
+                + std::min<size_type>(tail->m_enqueueIdx.load(barriers::relaxed),
+                        SegmentSize);
+        const size_type deq = head->m_id * SegmentSize
+                + std::min<size_type>(head->m_dequeueIdx.load(barriers::relaxed),
+                        SegmentSize);
+        This.release(head);
+        This.release(tail);
+        return enq > deq ? enq - deq : 0;
+    }
+    size_type getCapacity() const
+    {
+        return size_type();
+    }
+private:
+    segment_type* newSegment(size_type id)
+    {
+        pool_node_type* node = m_pool.newNode();
+        segment_type* seg = node->getData();
+        seg->m_id = id;
+        return seg;
+    }
+    void recycle(segment_type* seg)
+    {
+        m_pool.freeNode(pool_node_type::recover(seg));
+    }
+    segment_type* acquire(end_type& end)
+    {
+        segment_ptr expected;
+        segment_ptr next;
+        do
+        {
+            expected = end.m_ptr;
+            next.m_ptr = expected.m_ptr;
+            next.m_counter = expected.m_counter + 1;
+        }
+        while (!end.m_ptr.atomic_cas(expected, next));
+        return expected.m_ptr;
+    }
+    void release(segment_type* seg)
+    {
+        if (--seg->m_refs == 0)
+        {
+            recycle(seg);
+        }
+    }
+    // moves head (tail) from seg to next, the caller must hold seg
+    void advance(end_type& end, segment_type* seg, segment_type* next)
+    {
+        segment_ptr expected;
+        const segment_ptr newptr(next, 0);
+        for (;;)
+        {
+            expected = end.m_ptr;
+            if (expected.m_ptr != seg)
+            {
+                // somebody else has already moved it
+                return;
+            }
+            if (end.m_ptr.atomic_cas(expected, newptr))
+            {
+                break;
+            }
+        }
+        const size_type delta = expected.m_counter - segment_type::BIAS;
+        if (seg->m_refs.fetch_add(delta, barriers::release) + delta == 0)
+        {
+            thread_fence(barriers::acquire);
+            recycle(seg);
+        }
+    }
+    // links a new segment after exhausted seg and moves the tail to it,
+    // the caller must hold seg
+    void appendSegment(segment_type* seg)
+    {
+        segment_type* next = seg->m_next.load(barriers::acquire);
+        if (!next)
+        {
+            segment_type* fresh = newSegment(seg->m_id + 1);
+            segment_type* expected = nullptr;
+            if (seg->m_next.atomic_cas(expected, fresh))
+            {
+                next = fresh;
+            }
+            else
+            {
+                recycle(fresh);
+                next = seg->m_next.load(barriers::acquire);
+            }
+        }
+        advance(m_tail, seg, next);
+    }
+    // returns true if the cell holds data, false if the cell has been abandoned
+    static bool takeCell(cell_type& cell)
+    {
+        size_type state = cell.m_state.load(barriers::acquire);
+        if (state == empty && cell.m_state.atomic_cas(empty, taken))
+        {
+            // the producer has not come yet
+            return false;
+        }
+        // wait for the producer if it is constructing data
+        state = cell.m_state.load(barriers::acquire);
+        while (state == writing)
+        {
+            state = cell.m_state.load(barriers::acquire);
+        }
+        return state == full;
+    }
+private:
+    pool_type m_pool;
+    data_allocator_type m_dataAllocator;
+    pad_4_cache_line(m_pad);
+    end_type m_head;
+    end_type m_tail;
+};
+
+}
+
+#endif /* INCLUDE_QUEUE_SEGMENTED_HPP_ */
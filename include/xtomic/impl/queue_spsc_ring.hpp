@@ -0,0 +1,258 @@
+/*
+ * queue_spsc_ring.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: masha
+ */
+
+#ifndef INCLUDE_QUEUE_SPSC_RING_HPP_
+#define INCLUDE_QUEUE_SPSC_RING_HPP_
+
+#include <xtomic/aux/cppbasics.hpp>
+#include <xtomic/quantum.hpp>
+
+#include <memory>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+
+namespace xtomic
+{
+
+//
+// Single producer single consumer ring buffer.
+//
+// Unlike queue_spscfs the class does not have any counter that is modified by
+// both sides. The producer owns the head index, the consumer owns the tail index
+// and each index lives in its own cache line. Each side also keeps a private copy
+// of the opposite index and refreshes it only when the copy says the ring is
+// full (producer) or empty (consumer). So in the steady state the cache line
+// with the head travels from the producer to the consumer and the cache line with
+// the tail travels back, nothing else is shared.
+//
+// Both indexes are free running counters, the difference between them is the
+// number of items in the ring. Positions in the buffer are tracked separately
+// to avoid division in the hot path.
+//
+template<typename T, typename Allocator = std::allocator<T> >
+class queue_spsc_ring
+{
+public:
+    static const bool many_producers = false;
+    static const bool many_consumers = false;
+    static const bool fixed_size = true;
+    static const bool wait_free = true;
+
+public:
+    typedef T value_type;
+    typedef std::size_t size_type;
+private:
+    typedef queue_spsc_ring<T, Allocator> this_class;
+
+    struct node_type
+    {
+        T* getData()
+        {
+            return reinterpret_cast<T*>(m_data);
+        }
+        char m_data[sizeof(T)] align_as(T);
+    };
+
+    typedef Allocator data_allocator_type;
+    typedef typename Allocator::template rebind<node_type>::other node_allocator_type;
+
+    // the data modified by one side only
+    struct end_type
+    {
+        xtomic::quantum<size_type> m_index;  // own index, published for the other side
+        size_type m_position;                // own position in the buffer
+        size_type m_cachedIndex;             // last seen index of the other side
+        pad_4_cache_line(m_pad);
+
+        end_type() :
+                m_index(0),
+                m_position(0),
+                m_cachedIndex(0)
+        {
+        }
+    };
+
+private:
+    queue_spsc_ring(const this_class&);
+    this_class& operator=(const this_class&);
+
+public:
+    queue_spsc_ring(size_type capacity) :
+            m_capacity(capacity),
+            m_buffer(nullptr)
+    {
+        m_buffer = m_nodeAllocator.allocate(capacity);
+    }
+
+    ~queue_spsc_ring()
+    {
+        node_type* p = raw_pop();
+        while (p)
+        {
+            m_dataAllocator.destroy(p->getData());
+            commit_pop();
+            p = raw_pop();
+        }
+        m_nodeAllocator.deallocate(m_buffer, m_capacity);
+    }
+
+#if XTOMIC_USE_CPP11
+    template<typename ... Args>
+    bool push(Args&&... data)
+#else
+    bool push(const value_type& data)
+#endif
+    {
+        node_type* p = raw_push();
+        if (!p)
+        {
+            return false;
+        }
+        m_dataAllocator.construct(p->getData(), std_forward(Args, data));
+        commit_push();
+        return true;
+    }
+    bool pop(T & val)
+    {
+        node_type* p = raw_pop();
+        if (!p)
+        {
+            return false;
+        }
+        val = std_move(*p->getData());
+        m_dataAllocator.destroy(p->getData());
+        commit_pop();
+        return true;
+    }
+    // the whole range is published by a single store
+    template<typename ForwardIterator>
+    size_type push_bulk(ForwardIterator first, ForwardIterator last)
+    {
+        size_type count = static_cast<size_type>(std::distance(first, last));
+        const size_type head = m_producer.m_index.load(barriers::relaxed);
+        if (m_capacity - (head - m_producer.m_cachedIndex) < count)
+        {
+            m_producer.m_cachedIndex = m_consumer.m_index.load(barriers::acquire);
+            count = std::min(count, m_capacity - (head - m_producer.m_cachedIndex));
+        }
+        size_type constructed = 0;
+        try
+        {
+            for (; constructed < count; ++constructed, ++first)
+            {
+                node_type* p = m_buffer + m_producer.m_position;
+                m_dataAllocator.construct(p->getData(), *first);
+                if (++m_producer.m_position == m_capacity)
+                {
+                    m_producer.m_position = 0;
+                }
+            }
+        }
+        catch (...)
+        {
+            // publish what has been constructed
+            m_producer.m_index.store(head + constructed, barriers::release);
+            throw;
+        }
+        m_producer.m_index.store(head + count, barriers::release);
+        return count;
+    }
+    // the whole range is consumed by a single store
+    template<typename OutputIterator>
+    size_type pop_bulk(OutputIterator out, size_type max)
+    {
+        const size_type tail = m_consumer.m_index.load(barriers::relaxed);
+        if (m_consumer.m_cachedIndex - tail < max)
+        {
+            m_consumer.m_cachedIndex = m_producer.m_index.load(barriers::acquire);
+        }
+        const size_type count = std::min(max, m_consumer.m_cachedIndex - tail);
+        for (size_type i = 0; i < count; ++i)
+        {
+            node_type* p = m_buffer + m_consumer.m_position;
+            *out = std_move(*p->getData());
+            ++out;
+            m_dataAllocator.destroy(p->getData());
+            if (++m_consumer.m_position == m_capacity)
+            {
+                m_consumer.m_position = 0;
+            }
+        }
+        m_consumer.m_index.store(tail + count, barriers::release);
+        return count;
+    }
+    size_type size() const
+    {
+        // the tail is loaded first so the result never underflows
+        const size_type tail = m_consumer.m_index.load(barriers::acquire);
+        const size_type head = m_producer.m_index.load(barriers::acquire);
+        return head - tail;
+    }
+    size_type getCapacity() const
+    {
+        return m_capacity;
+    }
+private:
+    node_type* raw_push()
+    {
+        const size_type head = m_producer.m_index.load(barriers::relaxed);
+        if (head - m_producer.m_cachedIndex == m_capacity)
+        {
+            m_producer.m_cachedIndex = m_consumer.m_index.load(barriers::acquire);
+            if (head - m_producer.m_cachedIndex == m_capacity)
+            {
+                return nullptr;
+            }
+        }
+        return m_buffer + m_producer.m_position;
+    }
+    void commit_push()
+    {
+        if (++m_producer.m_position == m_capacity)
+        {
+            m_producer.m_position = 0;
+        }
+        const size_type head = m_producer.m_index.load(barriers::relaxed);
+        m_producer.m_index.store(head + 1, barriers::release);
+    }
+    node_type* raw_pop()
+    {
+        const size_type tail = m_consumer.m_index.load(barriers::relaxed);
+        if (tail == m_consumer.m_cachedIndex)
+        {
+            m_consumer.m_cachedIndex = m_producer.m_index.load(barriers::acquire);
+            if (tail == m_consumer.m_cachedIndex)
+            {
+                return nullptr;
+            }
+        }
+        return m_buffer + m_consumer.m_position;
+    }
+    void commit_pop()
+    {
+        if (++m_consumer.m_position == m_capacity)
+        {
+            m_consumer.m_position = 0;
+        }
+        const size_type tail = m_consumer.m_index.load(barriers::relaxed);
+        m_consumer.m_index.store(tail + 1, barriers::release);
+    }
+private:
+    // read only data shared by both sides
+    const size_type m_capacity;
+    node_type* m_buffer;
+    node_allocator_type m_nodeAllocator;
+    data_allocator_type m_dataAllocator;
+
+    pad_4_cache_line(m_pad);
+    end_type m_producer;
+    end_type m_consumer;
+};
+}
+
+#endif /* INCLUDE_QUEUE_SPSC_RING_HPP_ */
@@ -8,25 +8,69 @@
 #ifndef INCLUDE_RAW_HASH_TABLE_HPP_
 #define INCLUDE_RAW_HASH_TABLE_HPP_
 
+#include "indexing.hpp"
+#include "control_bytes.hpp"
+#include "sharded_counter.hpp"
 #include <xtomic/quantum.hpp>
 #include <cstddef>
 
 namespace xtomic
 {
 
-template<typename Node>
+template<typename Node, indexing::type Indexing = default_indexing::value>
 struct hash_data_table
 {
     typedef Node node_type;
     typedef std::size_t size_type;
+    typedef xtomic::quantum<int> chunk_type;
+    typedef table_indexing<Indexing> indexing_type;
 
     node_type* m_table;
+    unsigned char* m_control;               // control bytes of the slots if the table uses them
     size_type m_capacity;
+    unsigned int m_bits;                    // log2(m_capacity) for power of two indexing
     size_type m_highWatermark;
-    xtomic::quantum<size_type> m_size;
-    xtomic::quantum<size_type> m_used;
+    sharded_counter m_size;                 // items
+    sharded_counter m_used;                 // slots that are not unused
+
+    // incremental rehashing, the fields are used while items move to m_next
+    xtomic::quantum<hash_data_table*> m_next;
+    chunk_type* m_chunks;                   // state of each chunk of home slots
+    size_type m_chunkCount;
+    xtomic::quantum<size_type> m_claimed;   // chunks taken by helpers
+    xtomic::quantum<size_type> m_migrated;  // chunks moved to m_next
+
+    // the slot probing sequence of the hash starts from
+    size_type homeSlot(const size_type hash) const
+    {
+        return indexing_type::homeSlot(hash, m_capacity, m_bits);
+    }
 };
 
+// incremental rehashing moves items by chunks of home slots, the home slot
+// of an item is the slot its probing sequence starts from
+template<typename Table>
+inline bool is_home_slot(const Table& table,
+                         const std::size_t hash,
+                         const std::size_t first,
+                         const std::size_t last)
+{
+    const std::size_t home = table.homeSlot(hash);
+    return home >= first && home < last;
+}
+
+// the home slot of the hash and its control byte are fetched into the cache
+template<typename Table>
+inline void prefetch_home_slot(const Table& table, const std::size_t hash)
+{
+    const std::size_t home = table.homeSlot(hash);
+    __builtin_prefetch(table.m_table + home);
+    if (Table::indexing_type::CONTROL_BYTES)
+    {
+        __builtin_prefetch(table.m_control + home);
+    }
+}
+
 }
 
 #endif /* INCLUDE_RAW_HASH_TABLE_HPP_ */
@@ -0,0 +1,35 @@
+/*
+ * reclamation.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: masha
+ */
+
+#ifndef INCLUDE_RECLAMATION_HPP_
+#define INCLUDE_RECLAMATION_HPP_
+
+#include "xtraits.hpp"
+
+namespace xtomic
+{
+
+struct reclamation
+{
+    enum type
+    {
+        // readers count references to the nodes they visit, a node is freed when nobody holds it
+        ref_count,
+        // readers enter an epoch, a node is retired and freed when the readers have left (see epoch.hpp)
+        epoch,
+    };
+};
+
+struct default_reclamation: public integral_const<reclamation::type,
+        reclamation::ref_count>
+{
+
+};
+
+}
+
+#endif /* INCLUDE_RECLAMATION_HPP_ */
@@ -0,0 +1,35 @@
+/*
+ * rehashing.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: masha
+ */
+
+#ifndef INCLUDE_REHASHING_HPP_
+#define INCLUDE_REHASHING_HPP_
+
+#include "xtraits.hpp"
+
+namespace xtomic
+{
+
+struct rehashing
+{
+    enum type
+    {
+        // one thread moves the whole table while writers wait
+        stop_the_world,
+        // the new table is published at once, writers move items chunk by chunk
+        incremental,
+    };
+};
+
+struct default_rehashing: public integral_const<rehashing::type,
+        rehashing::stop_the_world>
+{
+
+};
+
+}
+
+#endif /* INCLUDE_REHASHING_HPP_ */
@@ -0,0 +1,178 @@
+/*
+ * sharded_counter.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: masha
+ */
+
+#ifndef INCLUDE_SHARDED_COUNTER_HPP_
+#define INCLUDE_SHARDED_COUNTER_HPP_
+
+#include "thread_slot.hpp"
+#include <xtomic/quantum.hpp>
+#include <xtomic/aux/cppbasics.hpp>
+
+#include <cstddef>
+#include <memory>
+
+namespace xtomic
+{
+
+//
+// Counter for many writers and rare readers.
+//
+// The counter has a slot per processor, SLOTS at most. A thread counts in the
+// slot thread_slot() modulo the number of slots, so threads do not share a cache
+// line unless they share a slot. The slots are allocated out of the counter object
+// and only while the batch is greater than 1. A slot keeps less than the batch in
+// either direction: as soon as it reaches the batch, the whole amount is moved
+// to the shared total. So the shared total is written once per batch changes of
+// a slot, and it differs from the exact value by less than error().
+//
+// approximate() reads the total only, exact() adds up all slots. Neither of them
+// is a snapshot while the counter is changed concurrently, a change that is moved
+// to the total may be counted twice by exact() but never missed.
+//
+// With the batch of 1 every change goes to the total and approximate() is exact.
+//
+class sharded_counter
+{
+public:
+    typedef std::size_t count_type;
+    typedef std::ptrdiff_t signed_type;
+
+    static const std::size_t SLOTS = 16;
+
+private:
+    struct slot_type
+    {
+        // the changes of the slot's threads that have not been moved to the total
+        xtomic::quantum<count_type> m_count;
+        pad_4_cache_line(m_pad);
+    };
+
+    typedef std::allocator<slot_type> slot_allocator_type;
+
+    sharded_counter(const sharded_counter&); // = delete;
+    sharded_counter& operator=(const sharded_counter&); // = delete;
+
+public:
+    sharded_counter(const count_type batch = 1) :
+            m_total(0),
+            m_batch(1),
+            m_mask(thread_slot_count(SLOTS) - 1),
+            m_slotAllocator(),
+            m_slots(nullptr)
+    {
+        reset(batch);
+    }
+    ~sharded_counter()
+    {
+        freeSlots();
+    }
+    // nobody may change the counter at the moment
+    void reset(const count_type batch)
+    {
+        m_total.store(0, barriers::relaxed);
+        if (batch > 1 && !m_slots)
+        {
+            m_slots = m_slotAllocator.allocate(m_mask + 1);
+        }
+        else if (batch == 1)
+        {
+            freeSlots();
+        }
+        for (std::size_t i = 0; m_slots && i <= m_mask; ++i)
+        {
+            ::new (static_cast<void*>(m_slots + i)) slot_type();
+        }
+        m_batch = batch;
+    }
+    void add(const count_type delta)
+    {
+        if (m_batch == 1)
+        {
+            m_total.fetch_add(delta, barriers::relaxed);
+            return;
+        }
+        xtomic::quantum<count_type>& count =
+                m_slots[thread_slot() & m_mask].m_count;
+        const signed_type value = static_cast<signed_type>(count.fetch_add(
+                delta, barriers::relaxed) + delta);
+        const signed_type batch = static_cast<signed_type>(m_batch);
+        if (value >= batch || value <= -batch)
+        {
+            // the total goes first, so exact() may count the amount twice
+            // but never misses it
+            m_total.fetch_add(static_cast<count_type>(value), barriers::relaxed);
+            count.fetch_sub(static_cast<count_type>(value), barriers::release);
+        }
+    }
+    void sub(const count_type delta)
+    {
+        add(0 - delta);
+    }
+    sharded_counter& operator++()
+    {
+        add(1);
+        return *this;
+    }
+    sharded_counter& operator--()
+    {
+        sub(1);
+        return *this;
+    }
+    // apart from changes in progress the value is less than error() away
+    // from the exact one
+    count_type approximate() const
+    {
+        return clamp(m_total.load(barriers::relaxed));
+    }
+    count_type exact() const
+    {
+        // the slots are read before the total, an amount being moved is
+        // either still in its slot or already in the total
+        count_type sum = 0;
+        for (std::size_t i = 0; m_slots && i <= m_mask; ++i)
+        {
+            sum += m_slots[i].m_count.load(barriers::acquire);
+        }
+        return clamp(sum + m_total.load(barriers::acquire));
+    }
+    count_type error() const
+    {
+        return getSlots() * (m_batch - 1);
+    }
+    std::size_t getSlots() const
+    {
+        return m_mask + 1;
+    }
+    count_type getBatch() const
+    {
+        return m_batch;
+    }
+private:
+    void freeSlots()
+    {
+        if (m_slots)
+        {
+            m_slotAllocator.deallocate(m_slots, m_mask + 1);
+            m_slots = nullptr;
+        }
+    }
+    // a decrement may be seen before the increment it follows
+    static count_type clamp(const count_type value)
+    {
+        return static_cast<signed_type>(value) < 0 ? 0 : value;
+    }
+private:
+    xtomic::quantum<count_type> m_total;
+    count_type m_batch;
+    const std::size_t m_mask;
+    slot_allocator_type m_slotAllocator;
+    slot_type* m_slots;
+};
+
+}
+
+#endif /* INCLUDE_SHARDED_COUNTER_HPP_ */
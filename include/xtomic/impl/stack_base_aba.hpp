@@ -52,6 +52,21 @@ public:
         }
         while (!success);
     }
+    // pushes the chain first->...->last with a single CAS
+    void atomic_push(node_type* first, node_type* last)
+    {
+        bool success;
+        node_ptr expected;
+        node_ptr newhead(first);
+        do
+        {
+            expected = m_head;
+            newhead.m_counter = expected.m_counter + 1;
+            last->m_next = expected.m_ptr;
+            success = m_head.atomic_cas(expected, newhead);
+        }
+        while (!success);
+    }
     void atomic_setHead(node_type* p)
     {
         bool success;
@@ -84,6 +99,69 @@ public:
         while (!success);
         return expected.m_ptr;
     }
+    // pops up to count nodes with a single CAS
+    // at exit count holds number of popped nodes, the chain is terminated by nullptr
+    node_type* atomic_pop(std::size_t& count)
+    {
+        bool success;
+        node_ptr expected;
+        node_ptr newhead;
+        node_type* last;
+        std::size_t popped;
+        do
+        {
+            expected = m_head;
+            if (!expected.m_ptr)
+            {
+                count = 0;
+                return nullptr;
+            }
+            last = expected.m_ptr;
+            popped = 1;
+            while (popped < count && last->m_next)
+            {
+                last = last->m_next;
+                ++popped;
+            }
+            newhead.m_ptr = last->m_next;
+            newhead.m_counter = expected.m_counter + 1;
+            success = m_head.atomic_cas(expected, newhead);
+        }
+        while (!success);
+        last->m_next = nullptr;
+        count = popped;
+        return expected.m_ptr;
+    }
+    // single attempt versions for callers that back off on contention
+    bool try_push(node_type* p)
+    {
+        node_ptr expected;
+        node_ptr newhead(p);
+        expected = m_head;
+        newhead.m_counter = expected.m_counter + 1;
+        p->m_next = expected.m_ptr;
+        return m_head.atomic_cas(expected, newhead);
+    }
+    // returns false if the CAS failed, otherwise p holds popped node or nullptr if the stack is empty
+    bool try_pop(node_type*& p)
+    {
+        node_ptr expected;
+        node_ptr newhead;
+        expected = m_head;
+        p = expected.m_ptr;
+        if (!p)
+        {
+            return true;
+        }
+        newhead.m_ptr = p->m_next;
+        newhead.m_counter = expected.m_counter + 1;
+        if (m_head.atomic_cas(expected, newhead))
+        {
+            return true;
+        }
+        p = nullptr;
+        return false;
+    }
     void push(node_type* p)
     {
         p->m_next = m_head.m_ptr;
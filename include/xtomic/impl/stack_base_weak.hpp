@@ -51,6 +51,18 @@ public:
         }
         while (!success);
     }
+    // pushes the chain first->...->last with a single CAS
+    void atomic_push(node_type* first, node_type* last)
+    {
+        bool success;
+        do
+        {
+            node_type* expected = m_head.load(barriers::relaxed);
+            last->m_next = expected;
+            success = m_head.atomic_cas(expected, first);
+        }
+        while (!success);
+    }
     node_type* atomic_pop()
     {
         bool success;
@@ -0,0 +1,46 @@
+/*
+ * thread_slot.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: masha
+ */
+
+#ifndef INCLUDE_THREAD_SLOT_HPP_
+#define INCLUDE_THREAD_SLOT_HPP_
+
+#include <xtomic/quantum.hpp>
+
+#include <cstddef>
+#include <unistd.h>
+
+namespace xtomic
+{
+
+// returns a small number unique for the calling thread, starts from 1
+inline std::size_t thread_slot()
+{
+    static xtomic::quantum<std::size_t> s_counter(0);
+    static __thread std::size_t slot = 0;
+    if (!slot)
+    {
+        slot = ++s_counter;
+    }
+    return slot;
+}
+
+// returns the number of per thread slots worth having: a power of two not less
+// than the number of processors, maxCount at most
+inline std::size_t thread_slot_count(const std::size_t maxCount)
+{
+    static const long s_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    std::size_t count = 1;
+    while (count < maxCount && static_cast<long>(count) < s_cpus)
+    {
+        count <<= 1;
+    }
+    return count;
+}
+
+}
+
+#endif /* INCLUDE_THREAD_SLOT_HPP_ */
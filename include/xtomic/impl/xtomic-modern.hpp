@@ -21,6 +21,16 @@ inline void thread_fence(const barriers::eacquire)
     __atomic_thread_fence(__ATOMIC_ACQUIRE);
 }
 
+inline void thread_fence(const barriers::efull)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+inline void cpu_relax()
+{
+    asm volatile("pause" : : : "memory");
+}
+
 template<typename T>
 inline void quantum<T>::store(const T val, barriers::erelaxed)
 {
@@ -23,6 +23,16 @@ inline void thread_fence(const barriers::eacquire)
     asm volatile("" : : : "memory");
 }
 
+inline void thread_fence(const barriers::efull)
+{
+    __sync_synchronize();
+}
+
+inline void cpu_relax()
+{
+    asm volatile("pause" : : : "memory");
+}
+
 template<typename T>
 inline void quantum<T>::store(const T val, barriers::erelaxed)
 {
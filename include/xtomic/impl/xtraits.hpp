@@ -11,6 +11,10 @@
 #include <xtomic/config.hpp>
 #include <xtomic/aux/inttypes.hpp>
 
+#if XTOMIC_USE_CPP11
+#include <type_traits>
+#endif
+
 namespace xtomic
 {
 
@@ -121,6 +125,21 @@ struct is_integral: public integral_const<bool,
 {
 };
 
+// a copy of the type may be made while it is being modified,
+// such a copy is discarded unless it is validated afterwards
+#if XTOMIC_USE_CPP11
+template<typename T>
+struct is_trivially_copyable: public integral_const<bool,
+        std::is_trivially_copyable<T>::value>
+{
+};
+#else
+template<typename T>
+struct is_trivially_copyable: public integral_const<bool, is_integral<T>::value>
+{
+};
+#endif
+
 }
 
 #endif /* INCLUDE_XTRAITS_HPP_ */
@@ -72,6 +72,16 @@ inline void thread_fence(const barriers::erelease);
 ///
 inline void thread_fence(const barriers::eacquire);
 
+///
+/// \brief The function implements full barrier.
+///
+inline void thread_fence(const barriers::efull);
+
+///
+/// \brief The function hints CPU that the caller spins in a busy-wait loop.
+///
+inline void cpu_relax();
+
 ///
 /// \brief The class implements atomic variables of specified type. The class mimics std::atomic<>
 /// from C++11 but it works even with compilers that do not support C++11 features, e.g. g++ v4.3.
@@ -16,12 +16,15 @@
 /// \cond HIDDEN_SYMBOLS
 
 #include "impl/queue_base.hpp"
-#include "impl/queue_spscfs.hpp"
+#include "impl/queue_spsc_ring.hpp"
+#include "impl/queue_mpmc_ring.hpp"
+#include "impl/queue_segmented.hpp"
 #include "impl/buffer_traits.hpp"
 #include "impl/xtraits.hpp"
 #include "aux/cppbasics.hpp"
 
 #include <utility>
+#include <iterator>
 
 /// \endcond
 
@@ -40,6 +43,11 @@ struct Queue
     {
         ManyProducers, OneProducer, ManyConsumers, OneConsumer,
     };
+
+    enum EEngine
+    {
+        NodeBased, ArrayBased,
+    };
 };
 
 namespace
@@ -112,7 +120,9 @@ struct are_many_consumers<Queue::OneConsumer> : public integral_const<bool,
 /// - single producer.
 /// - single consumer.
 /// - fixed size.
-/// In this case wait-free implementation is used.
+/// In this case wait-free implementation is used. The producer and the consumer do not share
+/// any counter: each side owns its index in a separate cache line and re-reads the index of the
+/// other side only when the queue looks full (producer) or empty (consumer).
 ///
 /// @param T type of element.
 /// @param SizeType specifies if fixed size queue is used or not. Default is FixedSize.
@@ -121,6 +131,23 @@ struct are_many_consumers<Queue::OneConsumer> : public integral_const<bool,
 /// @param NumConsumers specifies how many consumers may consume data from the same queue
 ///        concurrently. Default is ManyConsumers.
 /// @param Allocator specifies type of allocator. Default is std::allocator<T>.
+/// @param Engine specifies how items are stored. Default is NodeBased.
+///        - NodeBased: items are kept in linked nodes taken from a pool of free nodes.
+///        - ArrayBased: fixed sized queue keeps items in a ring of sequence-stamped cells,
+///          capacity is rounded up to a power of two. Each push/pop is a single CAS on
+///          the producers' (consumers') position and there is no pointer chasing.
+///          Dynamic sized queue keeps items in a list of fixed size segments (1024 cells),
+///          drained segments are recycled so the allocator is called only when the queue
+///          grows beyond its previous size.
+/// @param Policy specifies how free nodes of NodeBased queues are kept. Default is Buffer::Shared.
+///        - Shared: every push/pop takes (returns) a node from (to) the shared free list.
+///        - ThreadCached: each thread has a small cache of free nodes, the cache exchanges
+///          nodes with the shared free list in batches.
+///        - NumaLocal: there is a pool of free nodes per NUMA node, threads take nodes
+///          allocated on the node they run on.
+///
+/// Bursts of items might be transferred by push_bulk() and pop_bulk(). These methods pay for
+/// atomic operations once per burst rather than once per item.
 ///
 /// There are helper templates that allows to instantiate special cases of the queues:
 /// - make_fixed_size_queue
@@ -129,12 +156,15 @@ struct are_many_consumers<Queue::OneConsumer> : public integral_const<bool,
 template<typename T, Queue::ESize SizeType = Queue::FixedSize,
         Queue::EMultiplicity NumProducers = Queue::ManyProducers,
         Queue::EMultiplicity NumConsumers = Queue::ManyConsumers,
-        typename Allocator = std::allocator<T> >
+        typename Allocator = std::allocator<T>,
+        Queue::EEngine Engine = Queue::NodeBased,
+        Buffer::EPolicy Policy = Buffer::Shared>
 class queue
 {
 public:
     /// \cond HIDDEN_SYMBOLS
-    typedef buffer_traits<T, Allocator, is_queue_fixed_size<SizeType>::value> traits_type;
+    typedef buffer_traits<T, Allocator, is_queue_fixed_size<SizeType>::value,
+            Policy> traits_type;
     typedef typename traits_type::type buffer_type;
     typedef queue_base<T, are_many_producers<NumProducers>::value,
             are_many_consumers<NumConsumers>::value> queue_type;
@@ -149,7 +179,8 @@ public:
     static const bool many_consumers = queue_type::many_consumers;  ///< true if many consumers may eat data simultaneously.
     static const bool wait_free = false;                            ///< true if wait-free implementation is used.
 private:
-    typedef queue<T, SizeType, NumProducers, NumConsumers, Allocator> this_class;
+    typedef queue<T, SizeType, NumProducers, NumConsumers, Allocator, Engine,
+            Policy> this_class;
     typedef typename buffer_type::node_type node_type;
 
 private:
@@ -229,6 +260,100 @@ public:
         return true;
     }
 
+    ///
+    /// \brief The method inserts a range of items into the queue.
+    ///
+    /// Nodes for all items are taken from the buffer at once, linked locally and published
+    /// by a single atomic operation. The items are inserted in the same order as if push()
+    /// was called for each of them.
+    ///
+    /// @param first specifies the beginning of the range.
+    /// @param last specifies the end of the range.
+    /// @return number of inserted items. Fixed sized queue inserts as many items from the
+    ///         beginning of the range as it has free capacity for. Dynamic sized queue always
+    ///         inserts the whole range.
+    ///
+    template<typename ForwardIterator>
+    size_type push_bulk(ForwardIterator first, ForwardIterator last)
+    {
+        size_type count = static_cast<size_type>(std::distance(first, last));
+        if (!count)
+        {
+            return 0;
+        }
+        node_type* p = m_buff.reserveNodes(count);
+        if (!p)
+        {
+            return 0;
+        }
+        node_type* head = nullptr; // the last inserted item
+        node_type* tail = p;       // the first inserted item
+        try
+        {
+            while (p)
+            {
+                node_type* next = p->m_next;
+                m_buff.constructData(p, *first);
+                ++first;
+                p->m_next = head;
+                head = p;
+                p = next;
+            }
+        }
+        catch (...)
+        {
+            if (head)
+            {
+                m_buff.freeNodes(head, tail);
+            }
+            node_type* end = p;
+            while (end->m_next)
+            {
+                end = end->m_next;
+            }
+            m_buff.releaseNodes(p, end);
+            throw;
+        }
+        m_queue.atomic_push(head, tail);
+        m_size.fetch_add(count, barriers::release);
+        return count;
+    }
+
+    ///
+    /// \brief The method extracts up to specified number of items from the queue.
+    ///
+    /// All the items are detached from the queue and returned to the buffer by a single
+    /// atomic operation each.
+    ///
+    /// @param out specifies an output iterator to receive extracted values.
+    /// @param max specifies maximum number of items to extract.
+    /// @return number of extracted items, `0` if the queue was empty.
+    ///
+    template<typename OutputIterator>
+    size_type pop_bulk(OutputIterator out, size_type max)
+    {
+        if (!max)
+        {
+            return 0;
+        }
+        std::size_t count = max;
+        node_type* first = m_queue.atomic_pop(count);
+        if (!first)
+        {
+            return 0;
+        }
+        node_type* last = first;
+        for (node_type* p = first; p; p = p->m_next)
+        {
+            *out = std_move(*p->getData());
+            ++out;
+            last = p;
+        }
+        m_buff.freeNodes(first, last);
+        m_size.fetch_sub(count, barriers::release);
+        return static_cast<size_type>(count);
+    }
+
     ///
     /// \brief The method returns capacity of the queue. For fixed sized queues the value limits maximum
     /// number of elements that can be inserted.
@@ -256,14 +381,15 @@ private:
 };
 
 /// \cond HIDDEN_SYMBOLS
-template<typename T, typename Allocator>
+template<typename T, typename Allocator, Queue::EEngine Engine,
+        Buffer::EPolicy Policy>
 class queue<T, Queue::FixedSize, Queue::OneProducer, Queue::OneConsumer,
-        Allocator>
+        Allocator, Engine, Policy>
 {
 public:
     typedef queue<T, Queue::FixedSize, Queue::OneProducer, Queue::OneConsumer,
-            Allocator> this_class;
-    typedef queue_spscfs<T, Allocator> queue_type;
+            Allocator, Engine, Policy> this_class;
+    typedef queue_spsc_ring<T, Allocator> queue_type;
     typedef typename queue_type::value_type value_type;
     typedef typename queue_type::size_type size_type;
 private:
@@ -293,6 +419,20 @@ public:
     {
         return m_queue.pop(val);
     }
+    template<typename ForwardIterator>
+    size_type push_bulk(ForwardIterator first, ForwardIterator last)
+    {
+        return m_queue.push_bulk(first, last);
+    }
+    template<typename OutputIterator>
+    size_type pop_bulk(OutputIterator out, size_type max)
+    {
+        return m_queue.pop_bulk(out, max);
+    }
+    size_type getCapacity() const
+    {
+        return m_queue.getCapacity();
+    }
     size_type size() const
     {
         return m_queue.size();
@@ -300,6 +440,147 @@ public:
 private:
     queue_type m_queue;
 };
+
+// the ring of sequence-stamped cells
+template<typename T, Queue::EMultiplicity NumProducers,
+        Queue::EMultiplicity NumConsumers, typename Allocator,
+        Buffer::EPolicy Policy>
+class queue<T, Queue::FixedSize, NumProducers, NumConsumers, Allocator,
+        Queue::ArrayBased, Policy>
+{
+public:
+    typedef queue<T, Queue::FixedSize, NumProducers, NumConsumers, Allocator,
+            Queue::ArrayBased, Policy> this_class;
+    typedef queue_mpmc_ring<T, Allocator> queue_type;
+    typedef typename queue_type::value_type value_type;
+    typedef typename queue_type::size_type size_type;
+private:
+    queue(const this_class&);
+    this_class& operator=(const this_class&);
+public:
+    static const bool fixed_size = true;
+    static const bool many_producers = queue_type::many_producers;
+    static const bool many_consumers = queue_type::many_consumers;
+    static const bool wait_free = false;
+public:
+    queue(size_type sz) :
+            m_queue(sz)
+    {
+    }
+
+#if XTOMIC_USE_CPP11
+    template<typename ... Args>
+    bool push(Args&&... data)
+#else
+    bool push(const value_type& data)
+#endif
+    {
+        return m_queue.push(std_forward(Args, data));
+    }
+    bool pop(T & val)
+    {
+        return m_queue.pop(val);
+    }
+    template<typename ForwardIterator>
+    size_type push_bulk(ForwardIterator first, ForwardIterator last)
+    {
+        return m_queue.push_bulk(first, last);
+    }
+    template<typename OutputIterator>
+    size_type pop_bulk(OutputIterator out, size_type max)
+    {
+        return m_queue.pop_bulk(out, max);
+    }
+    size_type getCapacity() const
+    {
+        return m_queue.getCapacity();
+    }
+    size_type size() const
+    {
+        return m_queue.size();
+    }
+private:
+    queue_type m_queue;
+};
+
+// the list of recycled segments
+template<typename T, Queue::EMultiplicity NumProducers,
+        Queue::EMultiplicity NumConsumers, typename Allocator,
+        Buffer::EPolicy Policy>
+class queue<T, Queue::DynamicSize, NumProducers, NumConsumers, Allocator,
+        Queue::ArrayBased, Policy>
+{
+public:
+    typedef queue<T, Queue::DynamicSize, NumProducers, NumConsumers, Allocator,
+            Queue::ArrayBased, Policy> this_class;
+    typedef queue_segmented<T, Allocator> queue_type;
+    typedef typename queue_type::value_type value_type;
+    typedef typename queue_type::size_type size_type;
+private:
+    queue(const this_class&);
+    this_class& operator=(const this_class&);
+public:
+    static const bool fixed_size = false;
+    static const bool many_producers = queue_type::many_producers;
+    static const bool many_consumers = queue_type::many_consumers;
+    static const bool wait_free = false;
+public:
+    queue(size_type sz) :
+            m_queue(sz)
+    {
+    }
+
+#if XTOMIC_USE_CPP11
+    template<typename ... Args>
+    bool push(Args&&... data)
+#else
+    bool push(const value_type& data)
+#endif
+    {
+        return m_queue.push(std_forward(Args, data));
+    }
+    bool pop(T & val)
+    {
+        return m_queue.pop(val);
+    }
+    template<typename ForwardIterator>
+    size_type push_bulk(ForwardIterator first, ForwardIterator last)
+    {
+        return m_queue.push_bulk(first, last);
+    }
+    template<typename OutputIterator>
+    size_type pop_bulk(OutputIterator out, size_type max)
+    {
+        return m_queue.pop_bulk(out, max);
+    }
+    size_type getCapacity() const
+    {
+        return m_queue.getCapacity();
+    }
+    size_type size() const
+    {
+        return m_queue.size();
+    }
+private:
+    queue_type m_queue;
+};
+
+// single producer single consumer queue is wait-free regardless of the engine
+template<typename T, typename Allocator, Buffer::EPolicy Policy>
+class queue<T, Queue::FixedSize, Queue::OneProducer, Queue::OneConsumer,
+        Allocator, Queue::ArrayBased, Policy> : public queue<T, Queue::FixedSize,
+        Queue::OneProducer, Queue::OneConsumer, Allocator, Queue::NodeBased, Policy>
+{
+public:
+    typedef queue<T, Queue::FixedSize, Queue::OneProducer, Queue::OneConsumer,
+            Allocator, Queue::NodeBased, Policy> base_type;
+    typedef typename base_type::size_type size_type;
+public:
+    queue(size_type sz) :
+            base_type(sz)
+    {
+    }
+};
 /// \endcond
 
 ///
@@ -323,12 +604,14 @@ struct make_wait_free_queue
 /// \brief The template implements a shortcut to instantiate a fixed sized queue for an
 /// arbitrary number of producers and consumers.  See details [queue](@ref queue)
 ///
-template<typename T, typename Allocator = std::allocator<T> >
+template<typename T, typename Allocator = std::allocator<T>,
+        Queue::EEngine Engine = Queue::NodeBased,
+        Buffer::EPolicy Policy = Buffer::Shared>
 struct make_fixed_size_queue
 {
     /// fixed sized queue type.
     typedef queue<T, Queue::FixedSize, Queue::ManyProducers,
-            Queue::ManyConsumers, Allocator> type;
+            Queue::ManyConsumers, Allocator, Engine, Policy> type;
 };
 
 ///
@@ -337,12 +620,14 @@ struct make_fixed_size_queue
 /// \brief The template implements a shortcut to instantiate a dynamic sized queue for an
 /// arbitrary number of producers and consumers.  See details [queue](@ref queue)
 ///
-template<typename T, typename Allocator = std::allocator<T> >
+template<typename T, typename Allocator = std::allocator<T>,
+        Queue::EEngine Engine = Queue::NodeBased,
+        Buffer::EPolicy Policy = Buffer::Shared>
 struct make_dynamic_size_queue
 {
     /// dynamic sized queue type.
     typedef queue<T, Queue::DynamicSize, Queue::ManyProducers,
-            Queue::ManyConsumers, Allocator> type;
+            Queue::ManyConsumers, Allocator, Engine, Policy> type;
 };
 
 }
@@ -0,0 +1,433 @@
+/*
+ * sharded_hash_map.hpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: masha
+ */
+
+///
+/// @file sharded_hash_map.hpp
+///
+/// @brief `sharded_hash_map<>`, a hash map split into independent shards.
+///
+
+#ifndef INCLUDE_SHARDED_HASH_MAP_HPP_
+#define INCLUDE_SHARDED_HASH_MAP_HPP_
+
+/// \cond HIDDEN_SYMBOLS
+
+#include "hash_map.hpp"
+#include "impl/indexing.hpp"
+#include "impl/meta_utils.hpp"
+
+#include <cstddef>
+#include <functional>
+
+/// \endcond
+
+namespace xtomic
+{
+
+/// \cond HIDDEN_SYMBOLS
+template<std::size_t Count>
+struct get_shard_bits
+{
+    static constexpr unsigned int value = get_shard_bits<(Count >> 1)>::value
+            + 1;
+};
+
+template<>
+struct get_shard_bits<1>
+{
+    static constexpr unsigned int value = 0;
+};
+
+template<>
+struct get_shard_bits<0>
+{
+    static constexpr unsigned int value = 0;
+};
+/// \endcond
+
+/// \class sharded_hash_map
+///
+/// \brief The class is a thread-safe associative container made of `Shards` independent
+/// [hash_map](@ref hash_map) instances.
+///
+/// A key is routed to a shard by the high bits of its scrambled hash, the table of
+/// the shard indexes the key by the other bits. Each shard has its own table, its own
+/// watermarks and its own reclamation, so:
+///
+/// * a resize moves and allocates about 1/Shards of the items, other shards go on
+///   with inserts and erases meanwhile;
+/// * writers of different shards do not share any cache line.
+///
+/// Operations on a single key have the same guarantees as ones of `hash_map`.
+/// [size](@ref size), [getCapacity](@ref getCapacity) and [getSnapshot](@ref getSnapshot)
+/// visit the shards one by one, they are not atomic if other threads modify the
+/// container at the moment.
+///
+/// The key is hashed twice: to choose the shard and by the shard itself.
+///
+/// Every shard has the per processor slots of a `hash_map`, so an empty container costs
+/// `Shards` times as much as an empty `hash_map`, e.g. about 60 KB for 16 shards on a
+/// 16 processor machine.
+///
+/// @param Key type of key.
+/// @param Value type of mapped value.
+/// @param Shards number of shards, a power of two. Default value is 16.
+/// @param Hash type of hash function, std::hash<Key> is used by default.
+/// @param Pred type of equal function, std::equal_to<Key> is used by default.
+/// @param Allocator type of allocator, by default std::allocator<Value>.
+/// @param MemModel memory model of shards, see [hash_map](@ref hash_map).
+/// @param Rehashing rehashing of shards, see [hash_map](@ref hash_map).
+/// @param Indexing indexing of shards, see [hash_map](@ref hash_map).
+///
+template<typename Key, typename Value, std::size_t Shards = 16,
+        typename Hash = typename make_hash<Key>::type,
+        typename Pred = std::equal_to<Key>, typename Allocator = std::allocator<
+                Value>, memory_model::type MemModel =
+                default_memory_model::value, rehashing::type Rehashing =
+                default_rehashing::value, indexing::type Indexing =
+                default_indexing::value>
+class sharded_hash_map
+{
+public:
+
+    /// \cond HIDDEN_SYMBOLS
+    typedef sharded_hash_map<Key, Value, Shards, Hash, Pred, Allocator,
+            MemModel, Rehashing, Indexing> this_type;
+    /// \endcond
+
+    typedef hash_map<Key, Value, Hash, Pred, Allocator, MemModel, Rehashing,
+            Indexing> shard_type;                                               ///< type of a shard.
+    typedef typename shard_type::key_type key_type;                             ///< key type.
+    typedef typename shard_type::mapped_type mapped_type;                       ///< mapped value type.
+    typedef typename shard_type::hash_func_type hash_func_type;                 ///< hash function type.
+    typedef typename shard_type::equal_predicate_type equal_predicate_type;     ///< equal predicate type.
+    typedef typename shard_type::allocator_type allocator_type;                 ///< allocator type.
+    typedef typename shard_type::size_type size_type;                           ///< size type.
+    typedef typename shard_type::value_type value_type;                         ///< key:mapped-value pair.
+    typedef typename shard_type::snapshot_type snapshot_type;                   ///< vector of key:mapped-value pairs.
+
+    static constexpr bool INTEGRAL_KEY = shard_type::INTEGRAL_KEY;              ///< true if key type is treated as integral type.
+    static constexpr bool INTEGRAL_VALUE = shard_type::INTEGRAL_VALUE;          ///< true if mapped type is treated as integral type.
+    static constexpr bool INTEGRAL_KEYVALUE = shard_type::INTEGRAL_KEYVALUE;    ///< true if the whole pair key:mapped-value is treated as integral type.
+    static constexpr memory_model::type MEMORY_MODEL = MemModel;                ///< used memory model: greedy or wise.
+    static constexpr rehashing::type REHASHING = Rehashing;                     ///< used rehashing: stop the world or incremental.
+    static constexpr indexing::type INDEXING = Indexing;                        ///< used indexing: modulo, power of two or control bytes.
+    static constexpr std::size_t SHARDS = Shards;                               ///< number of shards.
+
+private:
+    typedef typename allocator_type::template rebind<shard_type>::other shard_allocator_type;
+
+    static constexpr unsigned int SHARD_BITS = get_shard_bits<Shards>::value;
+    static constexpr unsigned int HASH_BITS = sizeof(std::size_t) * 8;
+
+    // the number of shards must be a power of two
+    typedef simple_static_assert<(Shards > 0 && (Shards & (Shards - 1)) == 0)>
+            shards_check_type;
+
+    enum
+    {
+        SHARDS_CHECK = sizeof(shards_check_type)
+    };
+
+    sharded_hash_map(const this_type&); // = delete;
+    this_type& operator=(const this_type&); // = delete;
+
+public:
+
+    ///
+    /// \brief Constructor.
+    ///
+    /// @param initialCapacity initial capacity of the container, it is split evenly
+    ///        between the shards. Default value is 0.
+    ///
+    sharded_hash_map(const size_type initialCapacity = 0) :
+            m_hash_func(),
+            m_shardAllocator(),
+            m_shards(m_shardAllocator.allocate(Shards))
+    {
+        const size_type capacity = (initialCapacity + Shards - 1) / Shards;
+        std::size_t i = 0;
+        try
+        {
+            for (; i < Shards; ++i)
+            {
+                ::new (static_cast<void*>(m_shards + i)) shard_type(capacity);
+            }
+        }
+        catch (...)
+        {
+            // the shards built so far
+            while (i > 0)
+            {
+                m_shardAllocator.destroy(m_shards + --i);
+            }
+            m_shardAllocator.deallocate(m_shards, Shards);
+            throw;
+        }
+    }
+    ~sharded_hash_map()
+    {
+        for (std::size_t i = 0; i < Shards; ++i)
+        {
+            m_shardAllocator.destroy(m_shards + i);
+        }
+        m_shardAllocator.deallocate(m_shards, Shards);
+    }
+
+    ///
+    /// \brief The method generates snapshot of the map as vector of pairs key_type - mapped_type.
+    ///
+    /// The snapshot of each shard is consistent, the snapshot of the whole container
+    /// is not if other threads modify it at the moment.
+    ///
+    /// @param snapshot receives snapshot as vector of key:mapped-value pairs.
+    ///
+    void getSnapshot(snapshot_type & snapshot) const
+    {
+        snapshot_type tmp;
+        snapshot_type part;
+        tmp.reserve(size());
+        for (std::size_t i = 0; i < Shards; ++i)
+        {
+            m_shards[i].getSnapshot(part);
+            tmp.insert(tmp.end(), part.begin(), part.end());
+        }
+        snapshot.swap(tmp);
+    }
+
+    /// @name Find
+    /// @{
+
+    ///
+    /// @brief The operation finds value associated with specified key.
+    ///
+    /// @param key specifies key to find.
+    /// @param value receives a value associated with the specified key.
+    ///
+    /// @return
+    /// - `true` if the association was found otherwise `false`.
+    ///
+    bool find(const key_type & key, mapped_type & value) const
+    {
+        return getShard(key).find(key, value);
+    }
+
+    ///
+    /// @brief The operation finds value associated with specified key.
+    ///
+    /// @param key specifies key to find.
+    ///
+    /// @return
+    /// - value associated with the key if found otherwise default value `mapped_type()`.
+    ///
+    const mapped_type find(const key_type & key) const
+    {
+        return getShard(key).find(key);
+    }
+    /// @}
+
+    /// @name Insert
+    /// @{
+
+    ///
+    /// The method inserts a new key-value pair. The method does nothing if
+    /// the key already has associated value.
+    ///
+    /// @param key specifies a key
+    /// @param val specifies a mapped-value
+    /// @return
+    /// - `true` if a new association was inserted.
+    /// - `false` if the container already had a value associated with the specified key.
+    ///    The old value remains unchanged.
+    ///
+#if XTOMIC_USE_CPP11
+    template<typename ... Args>
+    bool insert(const key_type & key, Args&&... val)
+#else
+    bool insert(const key_type & key, const mapped_type& val)
+#endif
+    {
+        return getShard(key).insert(key, std_forward(Args, val));
+    }
+
+    ///
+    /// The method inserts a new key-value pair or updates existing one.
+    ///
+    /// @param key specifies a key.
+    /// @param val specifies a mapped-value.
+    ///
+#if XTOMIC_USE_CPP11
+    template<typename ... Args>
+    void insertOrUpdate(const key_type & key, Args&&... val)
+#else
+    void insertOrUpdate(const key_type & key, const mapped_type& val)
+#endif
+    {
+        getShard(key).insertOrUpdate(key, std_forward(Args, val));
+    }
+
+    ///
+    /// The method inserts a new key-value pair or finds the value associated with the key,
+    /// see [hash_map::find_or_insert](@ref hash_map::find_or_insert).
+    ///
+    /// @param key specifies a key.
+    /// @param value specifies a mapped-value to insert, receives the value associated
+    ///        with the key if the container already had it.
+    /// @return
+    /// - `true` if a new association was inserted.
+    ///
+    bool find_or_insert(const key_type & key, mapped_type & value)
+    {
+        return getShard(key).find_or_insert(key, value);
+    }
+
+    /// @}
+
+    /// @name Update
+    /// @{
+
+    ///
+    /// The method modifies the value associated with the specified key in place,
+    /// see [hash_map::update](@ref hash_map::update).
+    ///
+    /// @param key specifies a key.
+    /// @param func specifies a functor `void func(mapped_type & value)`.
+    /// @return
+    /// - `true` if the value was updated.
+    ///
+    template<typename Functor>
+    bool update(const key_type & key, Functor func)
+    {
+        return getShard(key).update(key, func);
+    }
+
+    ///
+    /// The method atomically adds `delta` to the value associated with the specified key,
+    /// see [hash_map::fetch_add](@ref hash_map::fetch_add).
+    ///
+    /// @param key specifies a key.
+    /// @param delta specifies a value to add.
+    /// @return
+    /// - the value associated with the key before the operation, `mapped_type()` if the
+    ///   key was inserted.
+    ///
+    mapped_type fetch_add(const key_type & key, const mapped_type & delta)
+    {
+        return getShard(key).fetch_add(key, delta);
+    }
+
+    /// @}
+
+    ///
+    /// The method erases an existing association for specified key.
+    ///
+    /// @param key specifies a key.
+    /// @return
+    /// - `true` if an association for specified key was found. The operation always erases the association.
+    /// - `false` if the container did not have value associated with specified key.
+    ///
+    bool erase(const key_type & key)
+    {
+        return getShard(key).erase(key);
+    }
+
+    ///
+    /// The method returns actual number of elements in the container, the sum of
+    /// sizes of the shards.
+    ///
+    /// @return size of the container.
+    ///
+    size_type size() const
+    {
+        size_type sum = 0;
+        for (std::size_t i = 0; i < Shards; ++i)
+        {
+            sum += m_shards[i].size();
+        }
+        return sum;
+    }
+
+    ///
+    /// The method return capacity of the container, the sum of capacities of the shards.
+    ///
+    /// *Note:* a shard grows when it reaches its own capacity, so the container may
+    /// start rehashing a shard before the total capacity is achieved.
+    ///
+    /// @return capacity of the container.
+    ///
+    size_type getCapacity() const
+    {
+        size_type sum = 0;
+        for (std::size_t i = 0; i < Shards; ++i)
+        {
+            sum += m_shards[i].getCapacity();
+        }
+        return sum;
+    }
+
+    ///
+    /// The method moves the items of mostly empty shards to smaller tables,
+    /// see [hash_map::shrink_to_fit](@ref hash_map::shrink_to_fit).
+    ///
+    void shrink_to_fit()
+    {
+        for (std::size_t i = 0; i < Shards; ++i)
+        {
+            m_shards[i].shrink_to_fit();
+        }
+    }
+
+    ///
+    /// The method returns the low watermark of the shards, see setLowWatermark().
+    ///
+    /// @return the low watermark in percents of the capacity.
+    ///
+    unsigned int getLowWatermark() const
+    {
+        return m_shards[0].getLowWatermark();
+    }
+
+    ///
+    /// The method sets the low watermark of all shards, see
+    /// [hash_map::setLowWatermark](@ref hash_map::setLowWatermark).
+    ///
+    /// @param percent specifies the watermark in percents of the capacity, 0 disables
+    ///        shrinking on erase.
+    ///
+    void setLowWatermark(const unsigned int percent)
+    {
+        for (std::size_t i = 0; i < Shards; ++i)
+        {
+            m_shards[i].setLowWatermark(percent);
+        }
+    }
+
+private:
+    std::size_t getShardIndex(const key_type & key) const
+    {
+        // two shifts, a single shard would shift by the width of the hash
+        return hash_scrambler<>::scramble(m_hash_func(key))
+                >> (HASH_BITS - SHARD_BITS - 1) >> 1;
+    }
+    shard_type & getShard(const key_type & key)
+    {
+        return m_shards[getShardIndex(key)];
+    }
+    const shard_type & getShard(const key_type & key) const
+    {
+        return m_shards[getShardIndex(key)];
+    }
+
+private:
+    hash_func_type m_hash_func;
+    shard_allocator_type m_shardAllocator;
+    shard_type* const m_shards;
+};
+
+}
+
+#endif /* INCLUDE_SHARDED_HASH_MAP_HPP_ */
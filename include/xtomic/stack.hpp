@@ -16,6 +16,7 @@
 /// \cond HIDDEN_SYMBOLS
 #include <xtomic/quantum.hpp>
 #include "impl/stack_base_aba.hpp"
+#include "impl/elimination_array.hpp"
 #include "impl/buffer_traits.hpp"
 #include "aux/cppbasics.hpp"
 #include <utility>
@@ -30,31 +31,44 @@ namespace xtomic
 ///
 /// The class implements optimization for stacks of fixed size.
 ///
+/// Stacks used by many threads at once may enable elimination: a push and a pop that fail
+/// to update the head at the same time exchange the item directly through an elimination
+/// array and do not retry on the head. The size of the array adapts to the contention.
+///
+/// With `Buffer::ThreadCached` policy each thread takes free nodes from its own small cache
+/// and exchanges them with the shared free list in batches, so push and pop touch only
+/// the head of the stack. With `Buffer::NumaLocal` policy threads take nodes from a pool
+/// allocated on their own NUMA node.
+///
 /// @param T specifies items' type.
 /// @param FixedSize specifies whether or not stack of fixed size is needed. Default value is `true`.
 /// @param Allocator specifies allocator type. Default value is std::allocator<T>.
+/// @param Elimination specifies whether or not elimination back-off is used. Default value is `false`.
+/// @param Policy specifies how free nodes are kept. Default value is `Buffer::Shared`.
 ///
 template<typename T, bool FixedSize = true, typename Allocator = std::allocator<
-        T> >
+        T>, bool Elimination = false, Buffer::EPolicy Policy = Buffer::Shared>
 class stack
 {
 public:
     /// \cond HIDDEN_SYMBOLS
-    typedef buffer_traits<T, Allocator, FixedSize> traits_type;
+    typedef buffer_traits<T, Allocator, FixedSize, Policy> traits_type;
     typedef typename traits_type::type buffer_type;
     typedef stack_base_aba<T> stack_type;
+    typedef typename stack_type::node_type node_type;
+    typedef typename elimination_traits<node_type, Elimination>::type elimination_type;
     /// \endcond
 
     typedef T value_type;                               ///< type of stack's items.
     typedef typename buffer_type::size_type size_type;  ///< size type.
 private:
-    typedef stack<T, FixedSize, Allocator> this_class;
-    typedef typename buffer_type::node_type node_type;
+    typedef stack<T, FixedSize, Allocator, Elimination, Policy> this_class;
 
 public:
     static const bool fixed_size = buffer_type::fixed_size;        ///< true if fixed sized stack is used.
     static const bool many_producers = stack_type::many_producers; ///< true if many producers may push to the same stack simultaneously. The value is always true and supported for future use.
     static const bool many_consumers = stack_type::many_consumers; ///< true if many consumers may consume data from the same stack simultaneously. The value is always true and supported for future use.
+    static const bool elimination = Elimination;                   ///< true if elimination back-off is used.
 private:
     stack(const this_class&);
     this_class& operator=(const this_class&);
@@ -102,7 +116,7 @@ public:
         {
             return false;
         }
-        m_stack.atomic_push(p);
+        pushNode(p);
         ++m_size;
         return true;
     }
@@ -117,7 +131,7 @@ public:
     ///
     bool pop(T & val)
     {
-        node_type* p = m_stack.atomic_pop();
+        node_type* p = popNode();
         if (!p)
         {
             return false;
@@ -149,9 +163,35 @@ public:
         return m_size.load(barriers::relaxed);
     }
 
+private:
+    void pushNode(node_type* p)
+    {
+        if (!Elimination)
+        {
+            m_stack.atomic_push(p);
+            return;
+        }
+        while (!m_stack.try_push(p) && !m_elimination.exchangePush(p))
+        {
+        }
+    }
+    node_type* popNode()
+    {
+        if (!Elimination)
+        {
+            return m_stack.atomic_pop();
+        }
+        node_type* p = nullptr;
+        while (!m_stack.try_pop(p) && !(p = m_elimination.exchangePop()))
+        {
+        }
+        return p;
+    }
+
 private:
     buffer_type m_buff;
     stack_type m_stack;
+    elimination_type m_elimination;
     xtomic::quantum<size_type> m_size;
 };
 
@@ -0,0 +1,360 @@
+/*
+ * work_stealing_deque.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: masha
+ */
+
+/// \file work_stealing_deque.hpp
+///
+/// @brief Work-stealing deque.
+///
+
+#ifndef INCLUDE_WORK_STEALING_DEQUE_HPP_
+#define INCLUDE_WORK_STEALING_DEQUE_HPP_
+
+/// \cond HIDDEN_SYMBOLS
+#include <xtomic/quantum.hpp>
+#include "impl/buffer_traits.hpp"
+#include "aux/cppbasics.hpp"
+#include <cstddef>
+#include <memory>
+#include <utility>
+/// \endcond
+
+namespace xtomic
+{
+
+///
+/// \brief The class represents Chase-Lev work-stealing deque. The deque has an owner, the only
+/// thread that may call push() and pop(), and any number of thieves that call steal().
+///
+/// The owner works with the bottom end of the deque (LIFO), thieves take items from the top
+/// end (FIFO). The owner operations do not use CAS unless the deque has a single item and
+/// the owner races with thieves for it. A thief claims an item with a single CAS.
+///
+/// The deque keeps pointers to nodes in a circular array, the nodes are taken from
+/// the same buffers as stack and queue use. Nodes popped by the owner are kept in a private
+/// cache and reused by next pushes, so a push/pop pair of the owner does not touch
+/// the shared free list at all.
+///
+/// Fixed sized deque never grows. Dynamic sized deque doubles the array when it is full,
+/// old arrays are kept until the deque is destroyed because a thief might still read them.
+///
+/// @param T specifies items' type.
+/// @param FixedSize specifies whether or not deque of fixed size is needed. Default value is `true`.
+/// @param Allocator specifies allocator type. Default value is std::allocator<T>.
+///
+template<typename T, bool FixedSize = true, typename Allocator = std::allocator<
+        T> >
+class work_stealing_deque
+{
+public:
+    /// \cond HIDDEN_SYMBOLS
+    typedef buffer_traits<T, Allocator, FixedSize> traits_type;
+    typedef typename traits_type::type buffer_type;
+    /// \endcond
+
+    typedef T value_type;                               ///< type of deque's items.
+    typedef typename buffer_type::size_type size_type;  ///< size type.
+private:
+    typedef work_stealing_deque<T, FixedSize, Allocator> this_class;
+    typedef typename buffer_type::node_type node_type;
+    typedef std::ptrdiff_t index_type;
+    typedef xtomic::quantum<node_type*> item_type;
+
+    struct array_type
+    {
+        size_type m_capacity;
+        size_type m_mask;
+        item_type* m_items;
+        array_type* m_prev; // the array replaced by this one
+    };
+
+    typedef typename Allocator::template rebind<array_type>::other array_allocator_type;
+    typedef typename Allocator::template rebind<item_type>::other item_allocator_type;
+
+    /// \cond HIDDEN_SYMBOLS
+    enum
+    {
+        MIN_CAPACITY = 16,
+        CACHE_REFILL = 32,  // number of nodes the owner reserves at once
+    };
+    /// \endcond
+
+public:
+    static const bool fixed_size = buffer_type::fixed_size; ///< true if fixed sized deque is used.
+private:
+    work_stealing_deque(const this_class&);
+    this_class& operator=(const this_class&);
+
+public:
+
+    ///
+    ///\brief Constructor.
+    ///
+    /// @param capacity specifies initial capacity of the deque.
+    ///
+    work_stealing_deque(size_type capacity) :
+            m_buff(capacity),
+            m_cache(nullptr),
+            m_array(nullptr),
+            m_top(0),
+            m_bottom(0)
+    {
+        m_array.store(allocateArray(calcCapacity(capacity)), barriers::relaxed);
+    }
+
+    ~work_stealing_deque()
+    {
+        value_type val;
+        while (pop(val))
+        {
+        }
+        while (m_cache)
+        {
+            node_type* p = m_cache;
+            m_cache = p->m_next;
+            m_buff.releaseNodes(p, p);
+        }
+        array_type* a = m_array.load(barriers::relaxed);
+        while (a)
+        {
+            array_type* prev = a->m_prev;
+            deallocateArray(a);
+            a = prev;
+        }
+    }
+
+    ///
+    /// \brief The method inserts new item at the bottom of the deque. Only the owner may call it.
+    ///
+    /// @param val
+    ///    - *C++11*: initializer list to construct a new item to insert.
+    ///    - *Dinosourus C*++: specifies a value of a new item.
+    /// @return true if new item was inserted successfully.
+    ///
+#if XTOMIC_USE_CPP11
+    template<typename ... Args>
+    bool push(Args&&... val)
+#else
+    bool push(const value_type& val)
+#endif
+    {
+        const index_type b = m_bottom.load(barriers::relaxed);
+        const index_type t = m_top.load(barriers::acquire);
+        array_type* a = m_array.load(barriers::relaxed);
+        if (b - t >= static_cast<index_type>(a->m_capacity))
+        {
+            if (fixed_size)
+            {
+                return false;
+            }
+            a = grow(a, t, b);
+        }
+
+        node_type* p = reserveNode();
+        if (!p)
+        {
+            return false;
+        }
+        try
+        {
+            m_buff.constructData(p, std_forward(Args, val));
+        }
+        catch (...)
+        {
+            p->m_next = m_cache;
+            m_cache = p;
+            throw;
+        }
+
+        a->m_items[b & a->m_mask].store(p, barriers::relaxed);
+        thread_fence(barriers::release);
+        m_bottom.store(b + 1, barriers::relaxed);
+        return true;
+    }
+
+    ///
+    /// \brief The method extracts the item from the bottom of the deque (the last pushed one).
+    /// Only the owner may call it.
+    ///
+    /// @param val specifies reference to a variable to hold extracted value.
+    /// @return
+    /// * `false` if the deque was empty and nothing was extracted.
+    /// * `true` if value was successfully extracted.
+    ///
+    bool pop(T & val)
+    {
+        const index_type b = m_bottom.load(barriers::relaxed) - 1;
+        array_type* a = m_array.load(barriers::relaxed);
+        m_bottom.store(b, barriers::relaxed);
+        thread_fence(barriers::full);
+        index_type t = m_top.load(barriers::relaxed);
+
+        node_type* p = nullptr;
+        if (t <= b)
+        {
+            p = a->m_items[b & a->m_mask].load(barriers::relaxed);
+            if (t == b)
+            {
+                // the last item, race with thieves
+                if (!m_top.atomic_cas(t, t + 1))
+                {
+                    p = nullptr;
+                }
+                m_bottom.store(b + 1, barriers::relaxed);
+            }
+        }
+        else
+        {
+            m_bottom.store(b + 1, barriers::relaxed);
+        }
+        if (!p)
+        {
+            return false;
+        }
+        val = std_move(*p->getData());
+        m_buff.destroyData(p);
+        p->m_next = m_cache;
+        m_cache = p;
+        return true;
+    }
+
+    ///
+    /// \brief The method extracts the item from the top of the deque (the first pushed one).
+    /// Any thread may call it.
+    ///
+    /// @param val specifies reference to a variable to hold extracted value.
+    /// @return
+    /// * `false` if the deque was empty and nothing was extracted.
+    /// * `true` if value was successfully extracted.
+    ///
+    bool steal(T & val)
+    {
+        for (;;)
+        {
+            index_type t = m_top.load(barriers::acquire);
+            thread_fence(barriers::full);
+            const index_type b = m_bottom.load(barriers::acquire);
+            if (t >= b)
+            {
+                return false;
+            }
+            array_type* a = m_array.load(barriers::acquire);
+            node_type* p = a->m_items[t & a->m_mask].load(barriers::relaxed);
+            if (m_top.atomic_cas(t, t + 1))
+            {
+                val = std_move(*p->getData());
+                m_buff.freeNode(p);
+                return true;
+            }
+        }
+    }
+
+    ///
+    /// \brief The method returns capacity of the deque. For fixed sized deques the value limits maximum
+    /// number of elements that can be inserted.
+    ///
+    /// @return current capacity of the container.
+    ///
+    size_type getCapacity() const
+    {
+        return m_buff.getCapacity();
+    }
+
+    ///
+    /// \brief The method returns number of elements in the deque.
+    ///
+    /// @return number of elements in the deque.
+    ///
+    size_type size() const
+    {
+        const index_type t = m_top.load(barriers::acquire);
+        const index_type b = m_bottom.load(barriers::acquire);
+        return b > t ? static_cast<size_type>(b - t) : 0;
+    }
+
+private:
+    static size_type calcCapacity(size_type capacity)
+    {
+        size_type result = MIN_CAPACITY;
+        while (result < capacity)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+    node_type* reserveNode()
+    {
+        if (!m_cache)
+        {
+            size_type count = CACHE_REFILL;
+            m_cache = m_buff.reserveNodes(count);
+            if (!m_cache)
+            {
+                return nullptr;
+            }
+        }
+        node_type* p = m_cache;
+        m_cache = p->m_next;
+        return p;
+    }
+    array_type* allocateArray(size_type capacity)
+    {
+        array_type* a = m_arrayAllocator.allocate(1);
+        try
+        {
+            a->m_items = m_itemAllocator.allocate(capacity);
+        }
+        catch (...)
+        {
+            m_arrayAllocator.deallocate(a, 1);
+            throw;
+        }
+        a->m_capacity = capacity;
+        a->m_mask = capacity - 1;
+        a->m_prev = nullptr;
+        for (size_type i = 0; i < capacity; ++i)
+        {
+            ::new (static_cast<void*>(a->m_items + i)) item_type(nullptr);
+        }
+        return a;
+    }
+    void deallocateArray(array_type* a)
+    {
+        m_itemAllocator.deallocate(a->m_items, a->m_capacity);
+        m_arrayAllocator.deallocate(a, 1);
+    }
+    // doubles the array, the old one is retired but not freed
+    array_type* grow(array_type* a, index_type t, index_type b)
+    {
+        array_type* bigger = allocateArray(a->m_capacity * 2);
+        for (index_type i = t; i < b; ++i)
+        {
+            bigger->m_items[i & bigger->m_mask].store(
+                    a->m_items[i & a->m_mask].load(barriers::relaxed),
+                    barriers::relaxed);
+        }
+        bigger->m_prev = a;
+        m_array.store(bigger, barriers::release);
+        return bigger;
+    }
+private:
+    buffer_type m_buff;
+    array_allocator_type m_arrayAllocator;
+    item_allocator_type m_itemAllocator;
+    // owner's data
+    node_type* m_cache;
+    xtomic::quantum<array_type*> m_array;
+    // shared data
+    pad_4_cache_line(m_pad1);
+    xtomic::quantum<index_type> m_top;
+    pad_4_cache_line(m_pad2);
+    xtomic::quantum<index_type> m_bottom;
+    pad_4_cache_line(m_pad3);
+};
+
+}
+
+#endif /* INCLUDE_WORK_STEALING_DEQUE_HPP_ */
@@ -0,0 +1,39 @@
+/*
+ * affinity.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: masha
+ */
+
+#include "affinity.hpp"
+#include "cmdlineparser.hpp"
+
+#include <pthread.h>
+#include <sched.h>
+#include <iostream>
+
+namespace xtomic
+{
+namespace perftest
+{
+
+void pinThread(unsigned int index)
+{
+    const CommandLineParser::cpus_type & cpus = CommandLineParser::getCpus();
+    if (cpus.empty())
+    {
+        return;
+    }
+    const int cpu = cpus[index % cpus.size()];
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+    {
+        std::cerr << "cannot pin thread to CPU " << cpu << std::endl;
+    }
+}
+
+}
+}
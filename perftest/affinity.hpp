@@ -0,0 +1,23 @@
+/*
+ * affinity.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: masha
+ */
+
+#ifndef PERFTEST_AFFINITY_HPP_
+#define PERFTEST_AFFINITY_HPP_
+
+namespace xtomic
+{
+namespace perftest
+{
+
+// pins the calling thread to the index-th CPU of the list given by --cpus,
+// does nothing if the list is empty
+void pinThread(unsigned int index);
+
+}
+}
+
+#endif /* PERFTEST_AFFINITY_HPP_ */
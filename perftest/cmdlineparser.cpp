@@ -19,6 +19,8 @@
 #include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <cstdlib>
+#include <sched.h>
 
 namespace xtomic
 {
@@ -160,7 +162,47 @@ static void parseList(const char* val,
     }
 }
 
+static bool parseCpus(const char* val, CommandLineParser::cpus_type & cpus)
+{
+    std::set<std::string> items;
+    bool invert = false;
+    parseList(val, items, invert);
+    if (invert || items.empty())
+    {
+        return false;
+    }
+    for (std::set<std::string>::const_iterator i = items.begin();
+            i != items.end(); ++i)
+    {
+        char* end = nullptr;
+        const long first = strtol(i->c_str(), &end, 0);
+        long last = first;
+        if (*end == '-')
+        {
+            const char* next = end + 1;
+            last = strtol(next, &end, 0);
+            if (end == next)
+            {
+                return false;
+            }
+        }
+        if (end == i->c_str() || *end || first < 0 || last < first
+                || last >= CPU_SETSIZE)
+        {
+            return false;
+        }
+        for (long cpu = first; cpu <= last; ++cpu)
+        {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return true;
+}
+
 int CommandLineParser::m_duration = 10;
+CommandLineParser::cpus_type CommandLineParser::m_cpus;
 
 CommandLineParser::Command CommandLineParser::parse(const int argc,
                                                     const char** argv,
@@ -201,6 +243,17 @@ CommandLineParser::Command CommandLineParser::parse(const int argc,
             }
             m_duration = val;
         }
+        else if (pair.first == "--cpus")
+        {
+            m_cpus.clear();
+            if (!parseCpus(pair.second, m_cpus))
+            {
+                std::cerr << "invalid option: " << argv[i]
+                        << ", comma separated list of CPUs is expected" << std::endl;
+                i = argc;
+                break;
+            }
+        }
         else
         {
             std::cerr << "invalid or unexpected parameter: " << argv[i]
@@ -227,11 +280,15 @@ CommandLineParser::Command CommandLineParser::parse(const int argc,
 void CommandLineParser::showHelp(const char* arg0)
 {
     std::cout << "Usage:" << std::endl << arg0
-            << " [--duration=<duration>] run "
+            << " [--duration=<duration>] [--cpus=<cpus>] run "
             << "[--objects=[-]<objects>] [--groups=[-]<groups>] [--filter=[-]<filters>]"
             << std::endl << "or" << std::endl << arg0 << " list-tests"
             << std::endl << "or" << std::endl << arg0 << " --help" << std::endl
             << "where:" << std::endl << "    run - executes tests" << std::endl
+            << "    <cpus> - comma separated list of CPUs or ranges of CPUs (e.g. 0,2,4-7) to pin test threads to."
+            << std::endl
+            << "             The first thread (producer) goes to the first CPU, the second (consumer) to the second and so on."
+            << std::endl
             << "    <objects> - comma separated list of objects' names to test. Wild cards are supported."
             << std::endl
             << "    <groups> - comma separated list of objects' groups to run. Wild cards are supported."
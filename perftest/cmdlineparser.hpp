@@ -10,6 +10,8 @@
 
 #include "testtypes.hpp"
 
+#include <vector>
+
 namespace xtomic
 {
 namespace perftest
@@ -24,6 +26,8 @@ public:
         cmdShowHelp, cmdListTests, cmdRunTests, cmdError
     };
 
+    typedef std::vector<int> cpus_type;
+
     static Command parse(const int argc, const char** argv, ids_type & tests);
 
     static void showHelp(const char* arg0);
@@ -32,6 +36,12 @@ public:
     {
         return m_duration;
     }
+
+    // CPUs to pin test threads to, empty if threads are not pinned
+    static const cpus_type & getCpus()
+    {
+        return m_cpus;
+    }
 private:
     static Command onRunTests(const int argc,
                               const char** argv,
@@ -39,6 +49,7 @@ private:
 
 private:
     static int m_duration;
+    static cpus_type m_cpus;
 };
 
 }
@@ -0,0 +1,62 @@
+/*
+ * dequetest.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: masha
+ */
+
+#include "dequetest.hpp"
+#include "testaveragetime.hpp"
+#include "testfactory.hpp"
+#include <xtomic/work_stealing_deque.hpp>
+#include <xtomic/stack.hpp>
+#include <xtomic/aux/inttypes.hpp>
+
+namespace xtomic
+{
+namespace perftest
+{
+namespace deques
+{
+
+static const unsigned int NANOSECONDS_PER_SEC = static_cast<unsigned int>(1e9);
+
+typedef xtomic::uint64_t item_type;
+
+typedef xtomic::work_stealing_deque<item_type> fixed_deque_type;
+typedef xtomic::work_stealing_deque<item_type, false> dynamic_deque_type;
+typedef adapter::stack_deque<xtomic::stack<item_type> > stack_type;
+typedef adapter::stack_deque<
+        xtomic::stack<item_type, true, std::allocator<item_type>, false,
+                xtomic::Buffer::ThreadCached> > thread_cached_stack_type;
+
+template<typename Deque>
+class Registrar
+{
+private:
+    typedef Deque deque_type;
+    typedef OwnerOpTester<deque_type> owner_tester_type;
+    typedef AverageOpTimeTest<owner_tester_type, NANOSECONDS_PER_SEC> owner_test_type;
+    typedef StealBandwithTester<deque_type> steal_test_type;
+    typedef PerfTestFactoryImpl<owner_test_type> owner_factory_type;
+    typedef PerfTestFactoryImpl<steal_test_type> steal_factory_type;
+public:
+    Registrar(const char* name) :
+            m_owner("deques", name, "average owner push/pop time", "ns/op"),
+            m_steal("deques", name, "steal bandwith", "MItems/sec")
+    {
+
+    }
+private:
+    owner_factory_type m_owner;
+    steal_factory_type m_steal;
+};
+
+static Registrar<fixed_deque_type> s_fwsd("fixed size work-stealing deque");
+static Registrar<dynamic_deque_type> s_dwsd("dynamic size work-stealing deque");
+static Registrar<stack_type> s_stack("lock free stack");
+static Registrar<thread_cached_stack_type> s_tcstack("lock free thread cached stack");
+
+}
+}
+}
@@ -0,0 +1,233 @@
+/*
+ * dequetest.hpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: masha
+ */
+
+#ifndef PERFTEST_DEQUES_DEQUETEST_HPP_
+#define PERFTEST_DEQUES_DEQUETEST_HPP_
+
+#include "timeutils.hpp"
+#include "performancetest.hpp"
+#include "cmdlineparser.hpp"
+#include "affinity.hpp"
+
+#include <pthread.h>
+
+namespace xtomic
+{
+namespace perftest
+{
+namespace deques
+{
+
+static const unsigned int TYPICAL_SIZE = static_cast<unsigned int>(1000);
+static const unsigned int NUMBER_OF_REPETITIONS = static_cast<unsigned int>(10e6);
+
+namespace adapter
+{
+
+// per worker stack as it is used by schedulers without a deque:
+// the owner and thieves take items from the same end
+template<typename Stack>
+class stack_deque
+{
+private:
+    typedef stack_deque<Stack> this_type;
+
+public:
+    typedef Stack collection_type;
+    typedef typename collection_type::value_type value_type;
+    typedef typename collection_type::size_type size_type;
+
+public:
+    stack_deque(size_type capacity) :
+            m_coll(capacity)
+    {
+    }
+
+    bool push(const value_type& v)
+    {
+        return m_coll.push(v);
+    }
+    bool pop(value_type& v)
+    {
+        return m_coll.pop(v);
+    }
+    bool steal(value_type& v)
+    {
+        return m_coll.pop(v);
+    }
+    size_type size() const
+    {
+        return m_coll.size();
+    }
+private:
+    stack_deque(const this_type&);
+    this_type& operator=(const this_type&);
+private:
+    collection_type m_coll;
+};
+
+}
+
+// the owner pushes a burst of items and takes them back
+template<typename Deque, unsigned int Repetitions = NUMBER_OF_REPETITIONS>
+class OwnerOpTester
+{
+public:
+    static const unsigned int count = Repetitions;
+    static const unsigned int burst = 64;
+
+    typedef Deque collection_type;
+    typedef typename collection_type::value_type value_type;
+
+public:
+    OwnerOpTester() :
+            m_coll(burst)
+    {
+    }
+
+    void operator()()
+    {
+        value_type v = value_type();
+        for (unsigned int i = 0; i < count; i += burst * 2)
+        {
+            for (unsigned int j = 0; j < burst; ++j)
+            {
+                m_coll.push(v);
+            }
+            for (unsigned int j = 0; j < burst; ++j)
+            {
+                m_coll.pop(v);
+            }
+        }
+    }
+private:
+    collection_type m_coll;
+};
+
+// the owner keeps the deque filled, a thief steals
+template<typename Deque>
+class StealBandwithTester: public IPerformanceTest
+{
+private:
+    typedef StealBandwithTester<Deque> this_type;
+
+public:
+    static const unsigned int maxSize = TYPICAL_SIZE;
+    static const unsigned quietTime = 1;
+
+    typedef Deque collection_type;
+
+    typedef typename collection_type::value_type value_type;
+    typedef typename collection_type::size_type size_type;
+
+public:
+    StealBandwithTester() :
+            m_coll(maxSize * 2),
+            m_run(false),
+            m_stop(false),
+            m_stealCount(0)
+    {
+    }
+    // overrides
+private:
+    virtual double doTest()
+    {
+        m_run = false;
+        m_stop = false;
+
+        pthread_t thief = 0;
+        pthread_t owner = 0;
+        void* arg = reinterpret_cast<void*>(this);
+
+        pthread_create(&owner, 0, &ownerFunc, arg);
+        pthread_create(&thief, 0, &thiefFunc, arg);
+
+        timespec quiet =
+        { quietTime, 0 };
+
+        timespec runtime =
+        { CommandLineParser::getDuration(), 0 };
+
+        nanosleep(&quiet, nullptr);
+
+        timespec start, end;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+
+        m_run = true;
+        nanosleep(&runtime, nullptr);
+
+        m_stop = true;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        pthread_join(thief, 0);
+        pthread_join(owner, 0);
+
+        timespec diff = end - start;
+        double duration = seconds(diff);
+        double count = static_cast<double>(m_stealCount);
+        return count / duration / 1.e6;
+    }
+private:
+    static void* thiefFunc(void* arg)
+    {
+        this_type* pThis = reinterpret_cast<this_type*>(arg);
+        pinThread(1); // thief
+
+        std::size_t stealCount = 0;
+        // wait for start
+        while (!pThis->m_run)
+            ;
+
+        while (!pThis->m_stop)
+        {
+            value_type v;
+            if (pThis->m_coll.steal(v))
+            {
+                ++stealCount;
+            }
+        }
+        pThis->m_stealCount = stealCount;
+        return 0;
+    }
+
+    static void* ownerFunc(void* arg)
+    {
+        this_type* pThis = reinterpret_cast<this_type*>(arg);
+        pinThread(0); // owner
+
+        // wait for start
+        while (!pThis->m_run)
+            ;
+
+        value_type v = value_type();
+        while (!pThis->m_stop)
+        {
+            if (pThis->m_coll.size() >= maxSize)
+            {
+                continue;
+            }
+            pThis->m_coll.push(v);
+        }
+        return 0;
+    }
+private:
+    StealBandwithTester(const this_type&);
+    this_type& operator=(const this_type&);
+
+private:
+    collection_type m_coll;
+    volatile bool m_run;
+    volatile bool m_stop;
+    volatile std::size_t m_stealCount;
+};
+
+}
+}
+}
+
+#endif /* PERFTEST_DEQUES_DEQUETEST_HPP_ */
@@ -9,6 +9,7 @@
 #define PERFTEST_MAPS_LFMAPS_HPP_
 
 #include <xtomic/hash_map.hpp>
+#include <xtomic/sharded_hash_map.hpp>
 #include <xtomic/hash_trie.hpp>
 #include <xtomic/aux/xfunctional.hpp>
 
@@ -24,13 +25,15 @@ namespace adapter
 template<typename Key, typename Value,
         typename Hash = typename make_hash<Key>::type,
         typename Allocator = std::allocator<Value>,
-        xtomic::memory_model::type MemModel = xtomic::default_memory_model::value
+        xtomic::memory_model::type MemModel = xtomic::default_memory_model::value,
+        xtomic::rehashing::type Rehashing = xtomic::default_rehashing::value,
+        xtomic::indexing::type Indexing = xtomic::default_indexing::value
         >
 class hash_map
 {
 public:
     typedef std::equal_to<Key> equal_to_type;
-    typedef xtomic::hash_map<Key, Value, Hash, equal_to_type, Allocator, MemModel> collection_type;
+    typedef xtomic::hash_map<Key, Value, Hash, equal_to_type, Allocator, MemModel, Rehashing, Indexing> collection_type;
     typedef typename collection_type::key_type key_type;
     typedef typename collection_type::mapped_type mapped_type;
     typedef typename collection_type::size_type size_type;
@@ -40,7 +43,7 @@ public:
 
     typedef Allocator allocator_type;
     typedef counted_allocator<allocator_type> counted_allocator_type;
-    typedef hash_map<Key, Value, Hash, counted_allocator_type, MemModel> counted_map_type;
+    typedef hash_map<Key, Value, Hash, counted_allocator_type, MemModel, Rehashing, Indexing> counted_map_type;
 
 public:
     hash_map(size_type reserve = 0) :
@@ -86,6 +89,84 @@ struct make_greedy_hash_map
     typedef hash_map<Key, Value, Hash, Allocator, xtomic::memory_model::greedy> type;
 };
 
+template<typename Key, typename Value,
+        typename Hash = typename make_hash<Key>::type,
+        typename Allocator = std::allocator<Value>
+        >
+struct make_incremental_hash_map
+{
+    typedef hash_map<Key, Value, Hash, Allocator, xtomic::memory_model::greedy,
+            xtomic::rehashing::incremental> type;
+};
+
+template<typename Key, typename Value,
+        typename Hash = typename make_hash<Key>::type,
+        typename Allocator = std::allocator<Value>
+        >
+struct make_power_of_two_hash_map
+{
+    typedef hash_map<Key, Value, Hash, Allocator, xtomic::memory_model::greedy,
+            xtomic::rehashing::stop_the_world, xtomic::indexing::power_of_two> type;
+};
+
+template<typename Key, typename Value,
+        typename Hash = typename make_hash<Key>::type,
+        typename Allocator = std::allocator<Value>
+        >
+struct make_control_bytes_hash_map
+{
+    typedef hash_map<Key, Value, Hash, Allocator, xtomic::memory_model::greedy,
+            xtomic::rehashing::stop_the_world, xtomic::indexing::control_bytes> type;
+};
+
+template<typename Key, typename Value,
+        typename Hash = typename make_hash<Key>::type,
+        typename Allocator = std::allocator<Value>,
+        std::size_t Shards = 16
+        >
+class sharded_hash_map
+{
+public:
+    typedef std::equal_to<Key> equal_to_type;
+    typedef xtomic::sharded_hash_map<Key, Value, Shards, Hash, equal_to_type, Allocator,
+            xtomic::memory_model::greedy> collection_type;
+    typedef typename collection_type::key_type key_type;
+    typedef typename collection_type::mapped_type mapped_type;
+    typedef typename collection_type::size_type size_type;
+
+    static constexpr bool RESERVE_IMPLEMENTED = true;
+    static constexpr bool ALLOCATOR_IMPLEMENTED = true;
+
+    typedef Allocator allocator_type;
+    typedef counted_allocator<allocator_type> counted_allocator_type;
+    typedef sharded_hash_map<Key, Value, Hash, counted_allocator_type, Shards> counted_map_type;
+
+public:
+    sharded_hash_map(size_type reserve = 0) :
+            m_coll(reserve)
+    {
+
+    }
+
+    bool insert(const key_type & key, const mapped_type & val)
+    {
+        return m_coll.insert(key, val);
+    }
+
+    bool find(const key_type & key, mapped_type & val) const
+    {
+        return m_coll.find(key, val);
+    }
+    bool erase(const key_type & key)
+    {
+        return m_coll.erase(key);
+    }
+
+private:
+    collection_type m_coll;
+
+};
+
 template<typename Key, typename Value, int BFactor,
         typename Allocator = std::allocator<Value> >
 class hash_trie
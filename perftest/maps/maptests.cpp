@@ -195,6 +195,36 @@ typedef adapter::make_greedy_hash_map<long long, slow_int_type>::type ikey_hash_
 typedef adapter::make_greedy_hash_map<long long, long long>::type ival_hash_map_type;
 typedef adapter::make_greedy_hash_map<long long, int>::type ipair_hash_map_type;
 }
+namespace incremental
+{
+typedef adapter::make_incremental_hash_map<slow_int_type, slow_int_type,
+        dummy_hash<slow_int_type::type> >::type generic_hash_map_type;
+typedef adapter::make_incremental_hash_map<long long, slow_int_type>::type ikey_hash_map_type;
+typedef adapter::make_incremental_hash_map<long long, long long>::type ival_hash_map_type;
+typedef adapter::make_incremental_hash_map<long long, int>::type ipair_hash_map_type;
+}
+namespace power_of_two
+{
+typedef adapter::make_power_of_two_hash_map<slow_int_type, slow_int_type,
+        dummy_hash<slow_int_type::type> >::type generic_hash_map_type;
+typedef adapter::make_power_of_two_hash_map<long long, slow_int_type>::type ikey_hash_map_type;
+typedef adapter::make_power_of_two_hash_map<long long, long long>::type ival_hash_map_type;
+typedef adapter::make_power_of_two_hash_map<long long, int>::type ipair_hash_map_type;
+}
+namespace control_bytes
+{
+// integral keys are compared in place and do not use control bytes
+typedef adapter::make_control_bytes_hash_map<slow_int_type, slow_int_type,
+        dummy_hash<slow_int_type::type> >::type generic_hash_map_type;
+}
+namespace sharded
+{
+typedef adapter::sharded_hash_map<slow_int_type, slow_int_type,
+        dummy_hash<slow_int_type::type> > generic_hash_map_type;
+typedef adapter::sharded_hash_map<long long, slow_int_type> ikey_hash_map_type;
+typedef adapter::sharded_hash_map<long long, long long> ival_hash_map_type;
+typedef adapter::sharded_hash_map<long long, int> ipair_hash_map_type;
+}
 
 typedef adapter::hash_trie<int, int, 16> hash_trie_type;
 typedef adapter::stdmap<int, int, false> map_type;
@@ -226,6 +256,42 @@ static registrar<ival_hash_map_type> r3("memory_model::greedy",
 static registrar<ipair_hash_map_type> r4("memory_model::greedy",
         "hash_map<int64_t, int>");
 }
+
+namespace incremental
+{
+static registrar<generic_hash_map_type> r1("rehashing::incremental", "hash_map<generic, generic>");
+static registrar<ikey_hash_map_type> r2("rehashing::incremental",
+        "hash_map<int64_t, generic>");
+static registrar<ival_hash_map_type> r3("rehashing::incremental",
+        "hash_map<int64_t, int64_t>");
+static registrar<ipair_hash_map_type> r4("rehashing::incremental",
+        "hash_map<int64_t, int>");
+}
+
+namespace power_of_two
+{
+static registrar<generic_hash_map_type> r1("indexing::power_of_two", "hash_map<generic, generic>");
+static registrar<ikey_hash_map_type> r2("indexing::power_of_two",
+        "hash_map<int64_t, generic>");
+static registrar<ival_hash_map_type> r3("indexing::power_of_two",
+        "hash_map<int64_t, int64_t>");
+static registrar<ipair_hash_map_type> r4("indexing::power_of_two",
+        "hash_map<int64_t, int>");
+}
+namespace control_bytes
+{
+static registrar<generic_hash_map_type> r1("indexing::control_bytes", "hash_map<generic, generic>");
+}
+namespace sharded
+{
+static registrar<generic_hash_map_type> r1("sharded", "sharded_hash_map<generic, generic>");
+static registrar<ikey_hash_map_type> r2("sharded",
+        "sharded_hash_map<int64_t, generic>");
+static registrar<ival_hash_map_type> r3("sharded",
+        "sharded_hash_map<int64_t, int64_t>");
+static registrar<ipair_hash_map_type> r4("sharded",
+        "sharded_hash_map<int64_t, int>");
+}
 namespace reference
 {
 static registrar<map_type> r1("std", "map");
@@ -7,6 +7,7 @@
 
 
 #include <xtomic/queue.hpp>
+#include <xtomic/impl/queue_spscfs.hpp>
 #include <xtomic/aux/inttypes.hpp>
 
 #include <vector>
@@ -27,12 +28,36 @@ typedef xtomic::uint64_t item_type;
 typedef xtomic::queue<item_type, xtomic::Queue::FixedSize,
         xtomic::Queue::OneProducer, xtomic::Queue::OneConsumer> wait_free_queue_type;
 
+// previous wait-free implementation with the counter shared by both ends
+typedef xtomic::queue_spscfs<item_type> wait_free_shared_counter_queue_type;
+
 typedef xtomic::queue<item_type, xtomic::Queue::FixedSize,
         xtomic::Queue::ManyProducers, xtomic::Queue::OneConsumer> lock_free_one_consumer_queue_type;
 
 typedef xtomic::queue<item_type, xtomic::Queue::FixedSize,
         xtomic::Queue::ManyProducers, xtomic::Queue::ManyConsumers> lock_free_many_consumers_queue_type;
 
+typedef xtomic::queue<item_type, xtomic::Queue::FixedSize,
+        xtomic::Queue::ManyProducers, xtomic::Queue::ManyConsumers,
+        std::allocator<item_type>, xtomic::Queue::NodeBased,
+        xtomic::Buffer::ThreadCached> lock_free_thread_cached_queue_type;
+
+typedef xtomic::queue<item_type, xtomic::Queue::FixedSize,
+        xtomic::Queue::ManyProducers, xtomic::Queue::ManyConsumers,
+        std::allocator<item_type>, xtomic::Queue::NodeBased,
+        xtomic::Buffer::NumaLocal> lock_free_numa_local_queue_type;
+
+typedef xtomic::queue<item_type, xtomic::Queue::FixedSize,
+        xtomic::Queue::ManyProducers, xtomic::Queue::ManyConsumers,
+        std::allocator<item_type>, xtomic::Queue::ArrayBased> lock_free_ring_queue_type;
+
+typedef xtomic::queue<item_type, xtomic::Queue::DynamicSize,
+        xtomic::Queue::ManyProducers, xtomic::Queue::ManyConsumers> lock_free_dynamic_queue_type;
+
+typedef xtomic::queue<item_type, xtomic::Queue::DynamicSize,
+        xtomic::Queue::ManyProducers, xtomic::Queue::ManyConsumers,
+        std::allocator<item_type>, xtomic::Queue::ArrayBased> lock_free_segmented_queue_type;
+
 typedef adapter::stdqueue<item_type> stl_queue_type;
 
 template<typename Queue>
@@ -53,8 +78,14 @@ private:
 };
 
 static Registrar<wait_free_queue_type> s_wfq("wait free queue");
+static Registrar<wait_free_shared_counter_queue_type> s_wfscq("wait free queue with shared counter");
 static Registrar<lock_free_one_consumer_queue_type> s_lfscq("lock free single consumer queue");
 static Registrar<lock_free_many_consumers_queue_type> s_lfmcq("lock free many consumers queue");
+static Registrar<lock_free_thread_cached_queue_type> s_lftcq("lock free many consumers thread cached queue");
+static Registrar<lock_free_numa_local_queue_type> s_lfnlq("lock free many consumers numa local queue");
+static Registrar<lock_free_ring_queue_type> s_lfrq("lock free many consumers ring queue");
+static Registrar<lock_free_dynamic_queue_type> s_lfdq("lock free dynamic size queue");
+static Registrar<lock_free_segmented_queue_type> s_lfsq("lock free dynamic size segmented queue");
 static Registrar<stl_queue_type> s_stdq("std::queue");
 
 }
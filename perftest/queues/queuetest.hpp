@@ -11,6 +11,7 @@
 #include "timeutils.hpp"
 #include "performancetest.hpp"
 #include "cmdlineparser.hpp"
+#include "affinity.hpp"
 
 #include <pthread.h>
 #include <math.h>
@@ -113,6 +114,7 @@ private:
     static void* popFunc(void* arg)
     {
         this_type* pThis = reinterpret_cast<this_type*>(arg);
+        pinThread(1); // consumer
 
         std::size_t popCount = 0;
         // wait for start
@@ -134,6 +136,7 @@ private:
     static void* pushFunc(void* arg)
     {
         this_type* pThis = reinterpret_cast<this_type*>(arg);
+        pinThread(0); // producer
 
         // wait for start
         while (!pThis->m_run)
@@ -6,6 +6,7 @@
  */
 
 #include "cmdlineparser.hpp"
+#include "affinity.hpp"
 
 #include <algorithm>
 #include <ctime>
@@ -26,7 +27,7 @@ MultiThreadTest::Inserter::Inserter(const volatile flags_type & flags,
 
 void MultiThreadTest::Inserter::operator()(IThreadTest* impl)
 {
-    ARGS args(&m_flags, impl);
+    ARGS args(&m_flags, impl, static_cast<unsigned int>(m_threads.size()));
     m_threads.push_back(std::make_pair(pthread_t(), args));
 }
 
@@ -68,6 +69,7 @@ void* MultiThreadTest::runner(void* raw_args)
 {
     ARGS* args = reinterpret_cast<ARGS*>(raw_args);
 
+    pinThread(args->index);
     args->impl->execute(*args->flags, args->results.count,
             args->results.duration);
     pthread_exit(nullptr);
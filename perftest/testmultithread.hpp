@@ -11,6 +11,7 @@
 #include "performancetest.hpp"
 #include <vector>
 #include <utility>
+#include <pthread.h>
 
 namespace xtomic
 {
@@ -79,10 +80,12 @@ public:
     {
         const volatile flags_type * flags;
         IThreadTest * impl;
+        unsigned int index; // position of the thread, see pinThread()
         RESULT results;
-        ARGS(const volatile flags_type* f, IThreadTest* i) :
+        ARGS(const volatile flags_type* f, IThreadTest* i, unsigned int n) :
                 flags(f),
-                impl(i)
+                impl(i),
+                index(n)
         {
 
         }
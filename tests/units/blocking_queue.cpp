@@ -0,0 +1,202 @@
+/*
+ * blocking_queue.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: masha
+ */
+
+#include "gtest/gtest.h"
+
+#include <xtomic/blocking_queue.hpp>
+
+#include <vector>
+#include <ctime>
+#include <pthread.h>
+
+namespace
+{
+
+double elapsed(const timespec& start)
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec - start.tv_sec) * 1000.
+            + (ts.tv_nsec - start.tv_nsec) / 1000000.;
+}
+
+void sleep_ms(long ms)
+{
+    timespec ts = { ms / 1000, (ms % 1000) * 1000000 };
+    nanosleep(&ts, 0);
+}
+
+typedef xtomic::blocking_queue<xtomic::make_fixed_size_queue<int>::type> fixed_queue_type;
+typedef xtomic::blocking_queue<
+        xtomic::make_dynamic_size_queue<int, std::allocator<int>, xtomic::Queue::ArrayBased>::type> dynamic_queue_type;
+
+template<typename Queue>
+struct delayed_push
+{
+    Queue* m_queue;
+    int m_value;
+
+    static void* run(void* arg)
+    {
+        delayed_push* p = reinterpret_cast<delayed_push*>(arg);
+        sleep_ms(50);
+        p->m_queue->push(p->m_value);
+        return 0;
+    }
+};
+
+template<typename Queue>
+struct delayed_pop
+{
+    Queue* m_queue;
+    int m_value;
+
+    static void* run(void* arg)
+    {
+        delayed_pop* p = reinterpret_cast<delayed_pop*>(arg);
+        sleep_ms(50);
+        p->m_queue->pop(p->m_value);
+        return 0;
+    }
+};
+
+template<typename Queue, int Size>
+struct many_items
+{
+    Queue* m_queue;
+    xtomic::quantum<int> m_sum;
+
+    static void* produce(void* arg)
+    {
+        many_items* p = reinterpret_cast<many_items*>(arg);
+        for (int i = 1; i <= Size; ++i)
+        {
+            p->m_queue->push_wait(i);
+        }
+        return 0;
+    }
+    static void* consume(void* arg)
+    {
+        many_items* p = reinterpret_cast<many_items*>(arg);
+        int val = 0;
+        for (int i = 1; i <= Size; ++i)
+        {
+            p->m_queue->pop_wait(val);
+            p->m_sum.fetch_add(val, xtomic::barriers::relaxed);
+        }
+        return 0;
+    }
+};
+
+}
+
+TEST(BlockingQueue, traits)
+{
+    EXPECT_TRUE(fixed_queue_type::fixed_size);
+    EXPECT_TRUE(fixed_queue_type::many_producers);
+    EXPECT_TRUE(fixed_queue_type::many_consumers);
+    EXPECT_FALSE(dynamic_queue_type::fixed_size);
+}
+
+TEST(BlockingQueue, nowait)
+{
+    int val = 0;
+    fixed_queue_type q(2);
+
+    EXPECT_TRUE(q.push(1));
+    EXPECT_TRUE(q.push_wait(2, 0));
+    EXPECT_FALSE(q.push(3));
+    EXPECT_EQ(q.size(), 2);
+    EXPECT_TRUE(q.pop_wait(val, 0));
+    EXPECT_TRUE(q.pop(val));
+    EXPECT_FALSE(q.pop(val));
+}
+
+TEST(BlockingQueue, pop_timeout)
+{
+    int val = 0;
+    dynamic_queue_type q(0);
+
+    timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    EXPECT_FALSE(q.pop_wait(val, 30));
+    EXPECT_GE(elapsed(start), 30.);
+}
+
+TEST(BlockingQueue, push_timeout)
+{
+    fixed_queue_type q(1);
+
+    EXPECT_TRUE(q.push(1));
+
+    timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    EXPECT_FALSE(q.push_wait(2, 30));
+    EXPECT_GE(elapsed(start), 30.);
+    EXPECT_EQ(q.size(), 1);
+}
+
+TEST(BlockingQueue, pop_wakeup)
+{
+    int val = 0;
+    dynamic_queue_type q(0);
+    delayed_push<dynamic_queue_type> arg = { &q, 5 };
+
+    pthread_t producer = 0;
+    pthread_create(&producer, 0, &delayed_push<dynamic_queue_type>::run, &arg);
+    q.pop_wait(val);
+    pthread_join(producer, 0);
+
+    EXPECT_EQ(val, 5);
+}
+
+TEST(BlockingQueue, push_wakeup)
+{
+    int val = 0;
+    fixed_queue_type q(1);
+    delayed_pop<fixed_queue_type> arg = { &q, 0 };
+
+    EXPECT_TRUE(q.push(1));
+
+    pthread_t consumer = 0;
+    pthread_create(&consumer, 0, &delayed_pop<fixed_queue_type>::run, &arg);
+    q.push_wait(2);
+    pthread_join(consumer, 0);
+
+    EXPECT_EQ(arg.m_value, 1);
+    EXPECT_TRUE(q.pop(val));
+    EXPECT_EQ(val, 2);
+}
+
+TEST(MT_BlockingQueue, manyProducers_manyConsumers)
+{
+    enum
+    {
+        Size = 10000,
+        Threads = 2,
+    };
+    typedef many_items<fixed_queue_type, Size> test_type;
+
+    fixed_queue_type q(16);
+    test_type test;
+    test.m_queue = &q;
+
+    pthread_t threads[Threads * 2];
+    for (int i = 0; i < Threads; ++i)
+    {
+        pthread_create(&threads[i * 2], 0, &test_type::consume, &test);
+        pthread_create(&threads[i * 2 + 1], 0, &test_type::produce, &test);
+    }
+    for (int i = 0; i < Threads * 2; ++i)
+    {
+        pthread_join(threads[i], 0);
+    }
+
+    EXPECT_EQ(test.m_sum.load(xtomic::barriers::relaxed),
+            Threads * (Size * (Size + 1) / 2));
+    EXPECT_EQ(q.size(), 0);
+}
@@ -9,6 +9,37 @@
 
 #include <xtomic/impl/fixed_buffer.hpp>
 #include <xtomic/impl/dynamic_buffer.hpp>
+#include <xtomic/impl/magazine_buffer.hpp>
+#include <xtomic/impl/numa_buffer.hpp>
+
+#include <pthread.h>
+
+namespace
+{
+
+template<typename Buffer, int Count>
+void* allocate_all(void* arg)
+{
+    typedef typename Buffer::node_type node_type;
+
+    Buffer* buff = reinterpret_cast<Buffer*>(arg);
+    node_type* nodes[Count];
+    for (int i = 0; i < Count; ++i)
+    {
+        nodes[i] = buff->newNode(i);
+        if (!nodes[i])
+        {
+            return 0;
+        }
+    }
+    for (int i = 0; i < Count; ++i)
+    {
+        buff->freeNode(nodes[i]);
+    }
+    return buff;
+}
+
+}
 
 TEST(fixed_buffer, allocfree)
 {
@@ -118,3 +149,209 @@ TEST(dynamic_buffer, reuse_node)
     buff.freeNode(node2);
     buff.freeNode(node3);
 }
+
+TEST(fixed_buffer, reserve_nodes)
+{
+    typedef xtomic::fixed_buffer<int, std::allocator<int> > buffer_type;
+    typedef buffer_type::node_type node_type;
+    typedef buffer_type::size_type size_type;
+
+    buffer_type buff(3);
+
+    size_type count = 2;
+    node_type* first = buff.reserveNodes(count);
+    EXPECT_EQ(count, 2);
+    EXPECT_NE(first, static_cast<node_type*>(0));
+    node_type* last = first->m_next;
+    EXPECT_EQ(last->m_next, static_cast<node_type*>(0));
+
+    count = 2;
+    node_type* rest = buff.reserveNodes(count);
+    EXPECT_EQ(count, 1);
+    EXPECT_EQ(buff.newNode(0), static_cast<node_type*>(0));
+
+    buff.releaseNodes(rest, rest);
+    buff.constructData(first, 1);
+    buff.constructData(last, 2);
+    buff.freeNodes(first, last);
+
+    count = 5;
+    first = buff.reserveNodes(count);
+    EXPECT_EQ(count, 3);
+}
+
+TEST(dynamic_buffer, reserve_nodes)
+{
+    typedef xtomic::dynamic_buffer<int, std::allocator<int> > buffer_type;
+    typedef buffer_type::node_type node_type;
+    typedef buffer_type::size_type size_type;
+
+    buffer_type buff(1);
+
+    size_type count = 3;
+    node_type* first = buff.reserveNodes(count);
+    EXPECT_EQ(count, 3);
+
+    node_type* last = first;
+    for (int i = 0; i < 3; ++i, last = last->m_next)
+    {
+        EXPECT_NE(last, static_cast<node_type*>(0));
+        buff.constructData(last, i);
+        if (!last->m_next)
+        {
+            break;
+        }
+    }
+    EXPECT_EQ(last->m_next, static_cast<node_type*>(0));
+    buff.freeNodes(first, last);
+}
+
+TEST(magazine_buffer, fixed_allocfree)
+{
+    typedef xtomic::fixed_buffer<int, std::allocator<int> > base_type;
+    typedef xtomic::magazine_buffer<base_type> buffer_type;
+    typedef buffer_type::node_type node_type;
+
+    EXPECT_TRUE(buffer_type::fixed_size);
+
+    buffer_type buff(3);
+    EXPECT_EQ(buff.getCapacity(), 3);
+
+    node_type* node1 = buff.newNode(1);
+    node_type* node2 = buff.newNode(2);
+    node_type* node3 = buff.newNode(3);
+    EXPECT_NE(node1, static_cast<node_type*>(0));
+    EXPECT_NE(node2, static_cast<node_type*>(0));
+    EXPECT_NE(node3, static_cast<node_type*>(0));
+    EXPECT_EQ(*node3->getData(), 3);
+    EXPECT_EQ(buff.newNode(4), static_cast<node_type*>(0));
+
+    // the node goes to the magazine of this thread and comes back
+    buff.freeNode(node2);
+    node_type* node4 = buff.newNode(4);
+    EXPECT_EQ(node4, node2);
+    EXPECT_EQ(*node4->getData(), 4);
+
+    buff.freeNode(node1);
+    buff.freeNode(node3);
+    buff.freeNode(node4);
+}
+
+TEST(magazine_buffer, fixed_scavenge)
+{
+    typedef xtomic::fixed_buffer<int, std::allocator<int> > base_type;
+    typedef xtomic::magazine_buffer<base_type> buffer_type;
+
+    enum
+    {
+        Capacity = 100,
+    };
+
+    buffer_type buff(Capacity);
+
+    // all nodes end up in the magazine of this thread
+    EXPECT_EQ((allocate_all<buffer_type, Capacity>(&buff)), &buff);
+
+    // another thread still gets all of them
+    pthread_t thread;
+    void* result = 0;
+    pthread_create(&thread, 0, &allocate_all<buffer_type, Capacity>, &buff);
+    pthread_join(thread, &result);
+    EXPECT_EQ(result, &buff);
+}
+
+TEST(magazine_buffer, dynamic_reuse_node)
+{
+    typedef xtomic::dynamic_buffer<int, std::allocator<int> > base_type;
+    typedef xtomic::magazine_buffer<base_type> buffer_type;
+    typedef buffer_type::node_type node_type;
+
+    EXPECT_FALSE(buffer_type::fixed_size);
+
+    buffer_type buff(0);
+
+    node_type* node1 = buff.newNode(1);
+    EXPECT_NE(node1, static_cast<node_type*>(0));
+    buff.freeNode(node1);
+
+    node_type* node2 = buff.newNode(2);
+    EXPECT_EQ(node2, node1);
+    EXPECT_EQ(*node2->getData(), 2);
+    buff.freeNode(node2);
+
+    // more than a magazine can hold
+    EXPECT_EQ((allocate_all<buffer_type, 1000>(&buff)), &buff);
+}
+
+TEST(numa_buffer, topology)
+{
+    EXPECT_GE(xtomic::numa::nodeCount(), 1);
+    EXPECT_LT(xtomic::numa::currentNode(), xtomic::numa::nodeCount());
+}
+
+TEST(numa_buffer, fixed_allocfree)
+{
+    typedef xtomic::numa_buffer<int, std::allocator<int>, true> buffer_type;
+    typedef buffer_type::node_type node_type;
+    typedef buffer_type::size_type size_type;
+
+    EXPECT_TRUE(buffer_type::fixed_size);
+
+    buffer_type buff(3);
+    EXPECT_EQ(buff.getCapacity(), 3);
+
+    node_type* node1 = buff.newNode(1);
+    node_type* node2 = buff.newNode(2);
+    node_type* node3 = buff.newNode(3);
+    EXPECT_NE(node1, static_cast<node_type*>(0));
+    EXPECT_NE(node2, static_cast<node_type*>(0));
+    EXPECT_NE(node3, static_cast<node_type*>(0));
+    EXPECT_EQ(*node2->getData(), 2);
+    EXPECT_EQ(buff.newNode(4), static_cast<node_type*>(0));
+
+    buff.freeNode(node2);
+    node_type* node4 = buff.newNode(4);
+    EXPECT_EQ(node4, node2);
+
+    // the chain is returned to the pools in one go
+    node1->m_next = node3;
+    node3->m_next = node4;
+    buff.freeNodes(node1, node4);
+
+    size_type count = 5;
+    node_type* first = buff.reserveNodes(count);
+    EXPECT_NE(first, static_cast<node_type*>(0));
+    EXPECT_GE(count, 1);
+    EXPECT_LE(count, 3);
+}
+
+TEST(numa_buffer, dynamic_reserve_nodes)
+{
+    typedef xtomic::numa_buffer<int, std::allocator<int>, false> buffer_type;
+    typedef buffer_type::node_type node_type;
+    typedef buffer_type::size_type size_type;
+
+    EXPECT_FALSE(buffer_type::fixed_size);
+
+    buffer_type buff(1);
+
+    size_type count = 3;
+    node_type* first = buff.reserveNodes(count);
+    EXPECT_EQ(count, 3);
+
+    node_type* last = first;
+    for (int i = 0; i < 3; ++i)
+    {
+        EXPECT_NE(last, static_cast<node_type*>(0));
+        buff.constructData(last, i);
+        if (!last->m_next)
+        {
+            break;
+        }
+        last = last->m_next;
+    }
+    EXPECT_EQ(last->m_next, static_cast<node_type*>(0));
+    buff.freeNodes(first, last);
+
+    EXPECT_EQ((allocate_all<buffer_type, 1000>(&buff)), &buff);
+}
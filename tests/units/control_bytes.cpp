@@ -0,0 +1,146 @@
+/*
+ * control_bytes.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: masha
+ */
+
+#include <gtest/gtest.h>
+
+#include <xtomic/impl/control_bytes.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace
+{
+// the hash is the home slot, the tag is the low 7 bits of the hash
+struct control_table
+{
+    typedef std::size_t size_type;
+
+    static const size_type CAPACITY = 64;
+
+    int m_table[CAPACITY];
+    unsigned char m_control[CAPACITY];
+    size_type m_capacity;
+
+    control_table() :
+            m_capacity(CAPACITY)
+    {
+        std::fill(m_control, m_control + CAPACITY, xtomic::CONTROL_EMPTY);
+    }
+    size_type homeSlot(const size_type hash) const
+    {
+        return hash % CAPACITY;
+    }
+    void fill(const size_type first, const size_type last,
+              const unsigned char tag)
+    {
+        for (size_type i = first; i < last; ++i)
+        {
+            m_control[i] = tag;
+        }
+    }
+};
+
+std::vector<std::size_t> probe(const control_table& table,
+                               const std::size_t hash)
+{
+    std::vector<std::size_t> slots;
+    xtomic::control_probe<control_table> p(table, hash);
+    for (std::size_t i; p.next(i);)
+    {
+        slots.push_back(i);
+    }
+    slots.push_back(p.emptySlot());
+    return slots;
+}
+}
+
+TEST(ControlBytes, match)
+{
+    unsigned char group[xtomic::CONTROL_GROUP];
+    std::fill(group, group + xtomic::CONTROL_GROUP, xtomic::CONTROL_EMPTY);
+    group[0] = 5;
+    group[7] = 5;
+    group[15] = 5;
+    group[8] = 6;
+
+    EXPECT_EQ(0x8081u, xtomic::control_match(group, 5));
+    EXPECT_EQ(0x0100u, xtomic::control_match(group, 6));
+    EXPECT_EQ(0x7e7eu, xtomic::control_match(group, xtomic::CONTROL_EMPTY));
+    EXPECT_EQ(0u, xtomic::control_match(group, 7));
+}
+
+TEST(ControlBytes, claim)
+{
+    control_table table;
+
+    EXPECT_TRUE(xtomic::control_claim(table.m_control, 3, 0x185));
+    EXPECT_EQ(xtomic::control_tag(0x185), table.m_control[3]);
+    EXPECT_EQ(0x05, table.m_control[3]);
+    EXPECT_FALSE(xtomic::control_claim(table.m_control, 3, 0x185));
+}
+
+TEST(ControlBytes, probe)
+{
+    control_table table;
+    const std::size_t hash = 20;
+
+    // slots before the home slot are not visited
+    table.fill(16, 20, xtomic::control_tag(hash));
+    table.fill(20, 35, xtomic::control_tag(hash + 1));
+    table.m_control[22] = xtomic::control_tag(hash);
+    table.m_control[33] = xtomic::control_tag(hash);
+
+    std::vector<std::size_t> expected;
+    expected.push_back(20);
+    expected.push_back(22);
+    expected.push_back(33);
+    expected.push_back(35); // the empty slot
+    table.m_control[20] = xtomic::control_tag(hash);
+
+    EXPECT_EQ(expected, probe(table, hash));
+}
+
+TEST(ControlBytes, probeWrapsAround)
+{
+    control_table table;
+    const std::size_t hash = 52;
+
+    table.fill(48, 64, xtomic::control_tag(hash));
+    table.fill(0, 3, xtomic::control_tag(hash));
+
+    std::vector<std::size_t> expected;
+    for (std::size_t i = 52; i < 64; ++i)
+    {
+        expected.push_back(i);
+    }
+    expected.push_back(0);
+    expected.push_back(1);
+    expected.push_back(2);
+    expected.push_back(3); // the empty slot
+
+    EXPECT_EQ(expected, probe(table, hash));
+}
+
+TEST(ControlBytes, probeReturnsToHomeGroup)
+{
+    control_table table;
+    const std::size_t hash = 20;
+
+    // the only empty slot precedes the home slot in the home group
+    table.fill(0, 64, xtomic::control_tag(hash + 1));
+    table.m_control[17] = xtomic::CONTROL_EMPTY;
+    table.m_control[16] = xtomic::control_tag(hash);
+    table.m_control[40] = xtomic::control_tag(hash);
+
+    std::vector<std::size_t> expected;
+    expected.push_back(40);
+    expected.push_back(16);
+    expected.push_back(17); // the empty slot
+
+    EXPECT_EQ(expected, probe(table, hash));
+}
@@ -0,0 +1,135 @@
+/*
+ * epoch.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: masha
+ */
+
+#include <gtest/gtest.h>
+
+#include <xtomic/impl/epoch.hpp>
+
+namespace
+{
+struct retired_node: public xtomic::epoch_hook
+{
+    bool m_freed;
+
+    retired_node() :
+            m_freed(false)
+    {
+    }
+};
+
+struct node_deleter
+{
+    int m_count;
+
+    void operator()(retired_node* node)
+    {
+        node->m_freed = true;
+        ++m_count;
+    }
+};
+}
+
+TEST(EpochDomain, advance)
+{
+    xtomic::epoch_domain domain;
+
+    const xtomic::epoch_domain::epoch_type epoch = domain.getEpoch();
+
+    EXPECT_TRUE(domain.tryAdvance());
+    EXPECT_EQ(domain.getEpoch(), epoch + 1);
+
+    // the reader of epoch + 1 does not block the next advance
+    xtomic::epoch_domain::token_type token = domain.enter();
+    EXPECT_TRUE(domain.tryAdvance());
+    EXPECT_EQ(domain.getEpoch(), epoch + 2);
+
+    // but it blocks the one after
+    EXPECT_FALSE(domain.tryAdvance());
+    EXPECT_EQ(domain.getEpoch(), epoch + 2);
+
+    domain.leave(token);
+    EXPECT_TRUE(domain.tryAdvance());
+    EXPECT_EQ(domain.getEpoch(), epoch + 3);
+}
+
+TEST(EpochDomain, guard)
+{
+    xtomic::epoch_domain domain;
+
+    {
+        xtomic::epoch_guard guard(domain);
+        EXPECT_TRUE(domain.tryAdvance());
+        EXPECT_FALSE(domain.tryAdvance());
+    }
+    EXPECT_TRUE(domain.tryAdvance());
+}
+
+TEST(EpochRetireList, collect)
+{
+    xtomic::epoch_domain domain;
+    xtomic::epoch_retire_list<retired_node, 1> retired;
+    node_deleter deleter = { 0 };
+
+    retired_node node;
+    retired.retire(domain, &node);
+    EXPECT_FALSE(retired.empty());
+
+    // a reader could have seen the node
+    xtomic::epoch_domain::token_type token = domain.enter();
+    retired.collect(domain, deleter);
+    retired.collect(domain, deleter);
+    retired.collect(domain, deleter);
+    EXPECT_FALSE(node.m_freed);
+    EXPECT_EQ(deleter.m_count, 0);
+
+    domain.leave(token);
+    retired.collect(domain, deleter);
+    retired.collect(domain, deleter);
+    EXPECT_TRUE(node.m_freed);
+    EXPECT_EQ(deleter.m_count, 1);
+    EXPECT_TRUE(retired.empty());
+}
+
+TEST(EpochRetireList, batch)
+{
+    xtomic::epoch_domain domain;
+    xtomic::epoch_retire_list<retired_node, 4> retired;
+    node_deleter deleter = { 0 };
+
+    retired_node nodes[4];
+    for (int i = 0; i < 3; ++i)
+    {
+        retired.retire(domain, &nodes[i]);
+        retired.collect(domain, deleter);
+        retired.collect(domain, deleter);
+    }
+    // the batch is not full
+    EXPECT_EQ(deleter.m_count, 0);
+
+    retired.retire(domain, &nodes[3]);
+    retired.collect(domain, deleter);
+    retired.collect(domain, deleter);
+    EXPECT_EQ(deleter.m_count, 4);
+    EXPECT_TRUE(retired.empty());
+}
+
+TEST(EpochRetireList, clear)
+{
+    xtomic::epoch_domain domain;
+    xtomic::epoch_retire_list<retired_node> retired;
+    node_deleter deleter = { 0 };
+
+    retired_node nodes[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        retired.retire(domain, &nodes[i]);
+    }
+    xtomic::epoch_guard guard(domain);
+    retired.clear(deleter);
+    EXPECT_EQ(deleter.m_count, 3);
+    EXPECT_TRUE(retired.empty());
+}
@@ -11,6 +11,12 @@
 #include <utils/my-int-wrapper.hpp>
 #include "uniform_hash_map_test.hpp"
 
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <pthread.h>
+
 typedef xtomic::my::int_wrapper<int> key_type;
 typedef xtomic::my::int_wrapper<int> mapped_type;
 
@@ -18,3 +24,409 @@ typedef make_map_uniform_tests<key_type, mapped_type, map_type::Generic> test_ma
 
 MAKE_ALL_TESTS_FOR_MAP(test_maker_type, Generic)
 
+
+namespace
+{
+struct allocation_counters
+{
+    static std::size_t s_allocated;
+    static std::size_t s_live;
+};
+
+std::size_t allocation_counters::s_allocated = 0;
+std::size_t allocation_counters::s_live = 0;
+
+// the allocator counts bytes allocated by all its rebinds
+template<typename T>
+class counting_allocator: public std::allocator<T>
+{
+public:
+    typedef std::allocator<T> base_type;
+    typedef typename base_type::size_type size_type;
+    typedef typename base_type::pointer pointer;
+
+    template<typename U>
+    struct rebind
+    {
+        typedef counting_allocator<U> other;
+    };
+
+    counting_allocator()
+    {
+    }
+    template<typename U>
+    counting_allocator(const counting_allocator<U>&)
+    {
+    }
+
+    pointer allocate(size_type n)
+    {
+        allocation_counters::s_allocated += n * sizeof(T);
+        allocation_counters::s_live += n * sizeof(T);
+        return base_type::allocate(n);
+    }
+    void deallocate(pointer p, size_type n)
+    {
+        allocation_counters::s_live -= n * sizeof(T);
+        base_type::deallocate(p, n);
+    }
+};
+}
+
+TEST(GreedyHashMap, ReclaimRetiredTables)
+{
+    typedef xtomic::hash_map<int, int, std::hash<int>, std::equal_to<int>,
+            counting_allocator<int>, xtomic::memory_model::greedy> map_type;
+    typedef allocation_counters counter_type;
+
+    const int size = 100000;
+
+    counter_type::s_allocated = 0;
+    counter_type::s_live = 0;
+    {
+        map_type hm;
+        for (int i = 0; i < size; ++i)
+        {
+            EXPECT_TRUE(hm.insert(i, i));
+        }
+        // let writers free the tables retired recently
+        for (int i = 0; i < 1000; ++i)
+        {
+            EXPECT_TRUE(hm.erase(i));
+            EXPECT_TRUE(hm.insert(i, i));
+        }
+        // old tables took as much memory as the current one without reclamation
+        EXPECT_GT(counter_type::s_allocated * 2, counter_type::s_live * 3);
+
+        int val = 0;
+        for (int i = 0; i < size; ++i)
+        {
+            EXPECT_TRUE(hm.find(i, val));
+            EXPECT_EQ(i, val);
+        }
+    }
+    EXPECT_EQ(0U, counter_type::s_live);
+}
+
+TEST(WiseHashMap, FreeOldTables)
+{
+    typedef xtomic::hash_map<int, int, std::hash<int>, std::equal_to<int>,
+            counting_allocator<int>, xtomic::memory_model::wise> map_type;
+    typedef allocation_counters counter_type;
+
+    const int size = 100000;
+
+    counter_type::s_allocated = 0;
+    counter_type::s_live = 0;
+    {
+        map_type hm;
+        for (int i = 0; i < size; ++i)
+        {
+            EXPECT_TRUE(hm.insert(i, i));
+        }
+        // the old tables are freed by the resize that replaces them
+        EXPECT_GT(counter_type::s_allocated * 2, counter_type::s_live * 3);
+
+        int val = 0;
+        for (int i = 0; i < size; ++i)
+        {
+            EXPECT_TRUE(hm.find(i, val));
+            EXPECT_EQ(i, val);
+        }
+    }
+    EXPECT_EQ(0U, counter_type::s_live);
+}
+
+TEST(GenericHashMap, NonTrivialValue)
+{
+    // std::string values are copied under the reference lock of the node
+    typedef xtomic::hash_map<std::string, std::string> map_type;
+
+    map_type hm;
+    std::string val;
+
+    EXPECT_TRUE(hm.insert("1", "one"));
+    EXPECT_FALSE(hm.insert("1", "uno"));
+    EXPECT_TRUE(hm.find("1", val));
+    EXPECT_EQ(val, "one");
+
+    hm.insertOrUpdate("1", "uno");
+    EXPECT_TRUE(hm.find("1", val));
+    EXPECT_EQ(val, "uno");
+
+    EXPECT_TRUE(hm.erase("1"));
+    EXPECT_FALSE(hm.find("1", val));
+    EXPECT_TRUE(hm.insert("1", "eins"));
+    EXPECT_TRUE(hm.find("1", val));
+    EXPECT_EQ(val, "eins");
+}
+
+namespace
+{
+// the fields are always updated together
+struct paired_value
+{
+    long long m_first;
+    long long m_second;
+};
+
+struct optimistic_readers
+{
+    typedef xtomic::hash_map<std::string, paired_value> map_type;
+
+    enum
+    {
+        Readers = 3,
+        Keys = 16,
+        Rounds = 200000,
+    };
+
+    map_type m_map;
+    std::string m_keys[Keys];
+    xtomic::quantum<bool> m_done;
+    xtomic::quantum<int> m_errors;
+
+    optimistic_readers() :
+            m_done(false),
+            m_errors(0)
+    {
+        for (int i = 0; i < Keys; ++i)
+        {
+            m_keys[i] = std::string(1, static_cast<char>('a' + i));
+        }
+    }
+    static void* writer(void* param)
+    {
+        optimistic_readers* self = static_cast<optimistic_readers*>(param);
+        for (int r = 0; r < Rounds; ++r)
+        {
+            const paired_value val = { r, -r };
+            const std::string& key = self->m_keys[r % Keys];
+            if (r % 7 == 0)
+            {
+                self->m_map.erase(key);
+            }
+            self->m_map.insertOrUpdate(key, val);
+        }
+        self->m_done.store(true, xtomic::barriers::release);
+        return nullptr;
+    }
+    static void* reader(void* param)
+    {
+        optimistic_readers* self = static_cast<optimistic_readers*>(param);
+        while (!self->m_done.load(xtomic::barriers::acquire))
+        {
+            for (int key = 0; key < Keys; ++key)
+            {
+                paired_value val;
+                if (self->m_map.find(self->m_keys[key], val)
+                        && val.m_first != -val.m_second)
+                {
+                    ++self->m_errors;
+                }
+            }
+        }
+        return nullptr;
+    }
+    void run()
+    {
+        pthread_t writerThread;
+        pthread_t readerThreads[Readers];
+
+        pthread_create(&writerThread, nullptr, writer, this);
+        for (int i = 0; i < Readers; ++i)
+        {
+            pthread_create(&readerThreads[i], nullptr, reader, this);
+        }
+        pthread_join(writerThread, nullptr);
+        for (int i = 0; i < Readers; ++i)
+        {
+            pthread_join(readerThreads[i], nullptr);
+        }
+    }
+};
+}
+
+TEST(MT_GenericHashMap, OptimisticReadsAreNotTorn)
+{
+    optimistic_readers test;
+
+    test.run();
+
+    EXPECT_EQ(test.m_errors.load(xtomic::barriers::relaxed), 0);
+}
+
+namespace
+{
+// the predicate counts comparisons of keys
+struct counting_equal_to
+{
+    static int s_calls;
+
+    bool operator()(const std::string& a, const std::string& b) const
+    {
+        ++s_calls;
+        return a == b;
+    }
+};
+
+int counting_equal_to::s_calls = 0;
+}
+
+template<typename Map>
+void testCompareHashBeforeKey()
+{
+    typedef Map map_type;
+    typedef typename map_type::mapped_type value_type;
+
+    const int size = 1000;
+
+    map_type hm;
+    counting_equal_to::s_calls = 0;
+    for (int i = 0; i < size; ++i)
+    {
+        EXPECT_TRUE(hm.insert(std::to_string(i), value_type(i)));
+    }
+    // all keys have different hashes so colliding keys are never compared
+    EXPECT_EQ(counting_equal_to::s_calls, 0);
+
+    value_type val;
+    for (int i = 0; i < size; ++i)
+    {
+        EXPECT_TRUE(hm.find(std::to_string(i), val));
+        EXPECT_EQ(val, value_type(i));
+    }
+    EXPECT_EQ(counting_equal_to::s_calls, size);
+    EXPECT_FALSE(hm.find(std::to_string(size), val));
+    EXPECT_EQ(counting_equal_to::s_calls, size);
+}
+
+TEST(GenericHashMap, CompareHashBeforeKey)
+{
+    testCompareHashBeforeKey<
+            xtomic::hash_map<std::string, int, std::hash<std::string>,
+                    counting_equal_to> >();
+    testCompareHashBeforeKey<
+            xtomic::hash_map<std::string, mapped_type, std::hash<std::string>,
+                    counting_equal_to> >();
+}
+
+namespace
+{
+// copying of a negative value throws once armed
+struct throwing_value
+{
+    static bool s_armed;
+
+    int m_value;
+
+    throwing_value() :
+            m_value(0)
+    {
+    }
+    explicit throwing_value(const int value) :
+            m_value(value)
+    {
+    }
+    throwing_value(const throwing_value& other) :
+            m_value(other.m_value)
+    {
+        if (s_armed && m_value < 0)
+        {
+            throw std::runtime_error("throwing_value");
+        }
+    }
+    throwing_value& operator=(const throwing_value& other)
+    {
+        m_value = other.m_value;
+        return *this;
+    }
+};
+
+bool throwing_value::s_armed = false;
+
+int makeKey(const int i, int*)
+{
+    return i;
+}
+
+std::string makeKey(const int i, std::string*)
+{
+    return std::to_string(i);
+}
+}
+
+template<typename Map>
+void testThrowingValue()
+{
+    typedef Map map_type;
+    typedef typename map_type::key_type key_type;
+    typedef typename map_type::size_type size_type;
+    typedef std::vector<std::pair<key_type, throwing_value> > items_type;
+
+    const int size = 100000;
+    const int bad = 12345;
+    const key_type badKey = makeKey(bad, static_cast<key_type*>(nullptr));
+
+    items_type items;
+    throwing_value::s_armed = false;
+    for (int i = 0; i < size; ++i)
+    {
+        // every partition of the bulk load meets a throwing value
+        const int value = i % (size / 8) == bad ? -1 : i;
+        items.push_back(
+                std::make_pair(makeKey(i, static_cast<key_type*>(nullptr)),
+                        throwing_value(value)));
+    }
+    throwing_value::s_armed = true;
+    EXPECT_THROW(
+            {
+                map_type loaded(items.begin(), items.end(), 4);
+            },
+            std::runtime_error);
+
+    map_type hm;
+    EXPECT_THROW(hm.insert_range(items.begin(), items.end()),
+            std::runtime_error);
+
+    // the failed keys are absent, the map stays consistent
+    throwing_value val;
+    size_type found = 0;
+    for (int i = 0; i < size; ++i)
+    {
+        if (hm.find(makeKey(i, static_cast<key_type*>(nullptr)), val))
+        {
+            EXPECT_EQ(i, val.m_value);
+            ++found;
+        }
+    }
+    EXPECT_EQ(found, hm.size());
+    EXPECT_FALSE(hm.find(badKey, val));
+    EXPECT_THROW(hm.insert(badKey, throwing_value(-1)),
+            std::runtime_error);
+    EXPECT_FALSE(hm.find(badKey, val));
+    EXPECT_TRUE(hm.insert(badKey, throwing_value(bad)));
+    EXPECT_TRUE(hm.find(badKey, val));
+    EXPECT_EQ(bad, val.m_value);
+
+    // failed update leaves the key erased
+    const size_type before = hm.size();
+    EXPECT_THROW(hm.insertOrUpdate(badKey, throwing_value(-1)),
+            std::runtime_error);
+    EXPECT_FALSE(hm.find(badKey, val));
+    EXPECT_EQ(before - 1, hm.size());
+    hm.insertOrUpdate(badKey, throwing_value(bad));
+    EXPECT_TRUE(hm.find(badKey, val));
+    EXPECT_EQ(before, hm.size());
+    throwing_value::s_armed = false;
+}
+
+TEST(GenericHashMap, ThrowingValue)
+{
+    testThrowingValue<xtomic::hash_map<std::string, throwing_value> >();
+}
+
+TEST(IntegralKeyHashMap, ThrowingValue)
+{
+    testThrowingValue<xtomic::hash_map<int, throwing_value> >();
+}
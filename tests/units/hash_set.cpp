@@ -10,7 +10,51 @@
 #include "gtest/gtest.h"
 #include "uniform_hash_set_test.hpp"
 
+#include <string>
+
 typedef xtomic::my::int_wrapper<int> key_type;
 
 MAKE_ALL_TESTS_FOR_SET(key_type, Generic)
 
+
+namespace
+{
+// the predicate counts comparisons of keys
+struct counting_equal_to
+{
+    static int s_calls;
+
+    bool operator()(const std::string& a, const std::string& b) const
+    {
+        ++s_calls;
+        return a == b;
+    }
+};
+
+int counting_equal_to::s_calls = 0;
+}
+
+TEST(GenericHashSet, CompareHashBeforeKey)
+{
+    typedef xtomic::hash_set<std::string, std::hash<std::string>,
+            counting_equal_to> set_type;
+
+    const int size = 1000;
+
+    set_type hs;
+    counting_equal_to::s_calls = 0;
+    for (int i = 0; i < size; ++i)
+    {
+        EXPECT_TRUE(hs.insert(std::to_string(i)));
+    }
+    // all keys have different hashes so colliding keys are never compared
+    EXPECT_EQ(counting_equal_to::s_calls, 0);
+
+    for (int i = 0; i < size; ++i)
+    {
+        EXPECT_TRUE(hs.find(std::to_string(i)));
+    }
+    EXPECT_EQ(counting_equal_to::s_calls, size);
+    EXPECT_FALSE(hs.find(std::to_string(size)));
+    EXPECT_EQ(counting_equal_to::s_calls, size);
+}
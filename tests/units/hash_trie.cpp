@@ -9,6 +9,8 @@
 
 #include <xtomic/hash_trie.hpp>
 
+#include <pthread.h>
+
 struct BadHashFunc
 {
     std::size_t operator()(int v) const
@@ -379,3 +381,163 @@ TEST(HashTrie, eraseChain)
     EXPECT_EQ(size, 0);
     EXPECT_EQ(ht.dbgCountBranches(), 1);
 }
+
+TEST(HashTrie, epochFindBranch)
+{
+    typedef int key_type;
+    typedef int value_type;
+
+    typedef xtomic::hash_trie<key_type, value_type, 16, BadHashFunc,
+            std::equal_to<key_type>, std::allocator<value_type>,
+            xtomic::reclamation::epoch> hash_trie;
+
+    hash_trie ht;
+
+    bool res = false;
+
+    ht.insert(0, 0);
+    ht.insert(1, 1);
+    ht.insert(-2, -2);
+    EXPECT_GT(ht.dbgCountBranches(), 1);
+
+    value_type v = -1;
+    res = ht.find(0, v);
+    EXPECT_TRUE(res);
+    EXPECT_EQ(v, 0);
+    EXPECT_FALSE(ht.dbgCheckRefrences());
+
+    res = ht.find(1, v);
+    EXPECT_TRUE(res);
+    EXPECT_EQ(v, 1);
+
+    res = ht.find(-2, v);
+    EXPECT_TRUE(res);
+    EXPECT_EQ(v, -2);
+
+    res = ht.find(-1, v);
+    EXPECT_FALSE(res);
+    EXPECT_EQ(v, -2);
+    EXPECT_FALSE(ht.dbgCheckRefrences());
+}
+
+TEST(HashTrie, epochEraseBranch)
+{
+    typedef int key_type;
+    typedef int value_type;
+
+    typedef xtomic::hash_trie<key_type, value_type, 16, BadHashFunc,
+            std::equal_to<key_type>, std::allocator<value_type>,
+            xtomic::reclamation::epoch> hash_trie;
+    typedef hash_trie::size_type size_type;
+
+    hash_trie ht;
+
+    // each round builds and tears down the branches
+    for (int i = 0; i < 100; ++i)
+    {
+        ht.insert(0, 0);
+        ht.insert(1, 1);
+        ht.insert(-2, -2);
+
+        value_type v = -1;
+        EXPECT_TRUE(ht.find(1, v));
+        EXPECT_EQ(v, 1);
+
+        EXPECT_TRUE(ht.erase(0));
+        EXPECT_TRUE(ht.erase(1));
+        EXPECT_TRUE(ht.erase(-2));
+        EXPECT_FALSE(ht.find(1, v));
+        EXPECT_EQ(ht.size(), static_cast<size_type>(0));
+        EXPECT_EQ(ht.dbgCountBranches(), 1);
+    }
+    EXPECT_FALSE(ht.dbgCheckRefrences());
+}
+
+namespace
+{
+template<typename HashTrie>
+struct trie_readers_writers
+{
+    typedef HashTrie hash_trie_type;
+
+    enum
+    {
+        Readers = 3,
+        Keys = 64,
+        Rounds = 20000,
+    };
+
+    hash_trie_type& m_trie;
+    xtomic::quantum<bool> m_done;
+    xtomic::quantum<int> m_errors;
+
+    trie_readers_writers(hash_trie_type& trie) :
+            m_trie(trie),
+            m_done(false),
+            m_errors(0)
+    {
+    }
+    static void* writer(void* param)
+    {
+        trie_readers_writers* self = static_cast<trie_readers_writers*>(param);
+        for (int r = 0; r < Rounds; ++r)
+        {
+            const int key = r % Keys;
+            self->m_trie.insert(key, key);
+            self->m_trie.erase((r + Keys / 2) % Keys);
+        }
+        self->m_done.store(true, xtomic::barriers::release);
+        return nullptr;
+    }
+    static void* reader(void* param)
+    {
+        trie_readers_writers* self = static_cast<trie_readers_writers*>(param);
+        while (!self->m_done.load(xtomic::barriers::acquire))
+        {
+            for (int key = 0; key < Keys; ++key)
+            {
+                int val = -1;
+                if (self->m_trie.find(key, val) && val != key)
+                {
+                    ++self->m_errors;
+                }
+            }
+        }
+        return nullptr;
+    }
+    void run()
+    {
+        pthread_t writerThread;
+        pthread_t readerThreads[Readers];
+
+        pthread_create(&writerThread, nullptr, writer, this);
+        for (int i = 0; i < Readers; ++i)
+        {
+            pthread_create(&readerThreads[i], nullptr, reader, this);
+        }
+        pthread_join(writerThread, nullptr);
+        for (int i = 0; i < Readers; ++i)
+        {
+            pthread_join(readerThreads[i], nullptr);
+        }
+    }
+};
+}
+
+TEST(MT_HashTrie, epochReadersWriter)
+{
+    typedef int key_type;
+    typedef int value_type;
+
+    typedef xtomic::hash_trie<key_type, value_type, 16, BadHashFunc,
+            std::equal_to<key_type>, std::allocator<value_type>,
+            xtomic::reclamation::epoch> hash_trie;
+
+    hash_trie ht;
+    trie_readers_writers<hash_trie> test(ht);
+
+    test.run();
+
+    EXPECT_EQ(test.m_errors.load(xtomic::barriers::relaxed), 0);
+    EXPECT_FALSE(ht.dbgCheckRefrences());
+}
@@ -0,0 +1,116 @@
+/*
+ * huge_page_allocator.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: masha
+ */
+
+#include "gtest/gtest.h"
+
+#include <xtomic/huge_page_allocator.hpp>
+#include <xtomic/queue.hpp>
+#include <xtomic/hash_map.hpp>
+
+#include <cstring>
+#include <vector>
+
+TEST(HugePageAllocator, heap)
+{
+    typedef xtomic::huge_page_allocator<int> allocator_type;
+
+    allocator_type a;
+    int* p = a.allocate(10);
+    EXPECT_NE(p, static_cast<int*>(0));
+    p[0] = 1;
+    p[9] = 2;
+    a.deallocate(p, 10);
+}
+
+TEST(HugePageAllocator, mapped)
+{
+    typedef xtomic::huge_page_allocator<char> allocator_type;
+    typedef allocator_type::size_type size_type;
+
+    const size_type size = 3 * allocator_type::HUGE_PAGE_SIZE + 1;
+
+    allocator_type a;
+    char* p = a.allocate(size);
+    EXPECT_NE(p, static_cast<char*>(0));
+    // either explicit or transparent huge page alignment
+    EXPECT_EQ(reinterpret_cast<size_type>(p) % allocator_type::HUGE_PAGE_SIZE, 0);
+    memset(p, 0x5a, size);
+    EXPECT_EQ(p[size - 1], 0x5a);
+    a.deallocate(p, size);
+}
+
+TEST(HugePageAllocator, flags)
+{
+    typedef xtomic::huge_page_allocator<long, xtomic::HugePages::Transparent> allocator_type;
+    typedef allocator_type::rebind<char>::other char_allocator_type;
+
+    const std::size_t size = 1024 * 1024;
+
+    char_allocator_type a = allocator_type();
+    char* p = a.allocate(size);
+    // memory is zeroed by the kernel
+    EXPECT_EQ(p[0], 0);
+    EXPECT_EQ(p[size - 1], 0);
+    a.deallocate(p, size);
+
+    EXPECT_FALSE(xtomic::parallel_first_touch<allocator_type>::value);
+    EXPECT_FALSE(xtomic::parallel_first_touch<std::allocator<int> >::value);
+    EXPECT_TRUE((xtomic::parallel_first_touch<
+            xtomic::huge_page_allocator<int,
+                    xtomic::HugePages::Default | xtomic::HugePages::ParallelInit> >::value));
+}
+
+TEST(HugePageAllocator, queue)
+{
+    typedef xtomic::huge_page_allocator<int> allocator_type;
+    typedef xtomic::make_fixed_size_queue<int, allocator_type>::type queue_type;
+    typedef xtomic::make_wait_free_queue<int, allocator_type>::type wait_free_queue_type;
+
+    enum
+    {
+        Capacity = 100000,
+    };
+
+    int val = 0;
+    queue_type q(Capacity);
+    wait_free_queue_type wfq(Capacity);
+    for (int i = 0; i < Capacity; ++i)
+    {
+        EXPECT_TRUE(q.push(i));
+        EXPECT_TRUE(wfq.push(i));
+    }
+    EXPECT_FALSE(q.push(0));
+    EXPECT_FALSE(wfq.push(0));
+    EXPECT_TRUE(q.pop(val));
+    EXPECT_TRUE(wfq.pop(val));
+    EXPECT_EQ(val, 0);
+}
+
+TEST(HugePageAllocator, hash_map_parallel_init)
+{
+    typedef xtomic::huge_page_allocator<int,
+            xtomic::HugePages::Default | xtomic::HugePages::ParallelInit> allocator_type;
+    typedef xtomic::hash_map<int, int, std::hash<int>, std::equal_to<int>,
+            allocator_type> map_type;
+
+    enum
+    {
+        Size = 2000000,
+    };
+
+    map_type m(Size);
+
+    for (int i = 0; i < Size; i += 7)
+    {
+        EXPECT_TRUE(m.insert(i, i * 2));
+    }
+    int val = 0;
+    EXPECT_TRUE(m.find(7000, val));
+    EXPECT_EQ(val, 14000);
+    EXPECT_FALSE(m.find(7001, val));
+    EXPECT_EQ(m.size(), (Size + 6) / 7);
+}
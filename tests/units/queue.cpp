@@ -9,6 +9,11 @@
 
 #include <xtomic/queue.hpp>
 
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+
 TEST(FixedSizeQueue, pop)
 {
     int val;
@@ -171,3 +176,454 @@ TEST(WaitFreeQueue, sequence)
     EXPECT_EQ(val, 3);
     EXPECT_FALSE(q.pop(val));
 }
+
+TEST(WaitFreeQueue, wraparound)
+{
+    int val = 0;
+    typedef xtomic::make_wait_free_queue<int>::type queue_type;
+
+    queue_type q(3);
+
+    EXPECT_EQ(q.getCapacity(), 3);
+    for (int i = 0; i < 10; ++i)
+    {
+        EXPECT_TRUE(q.push(i));
+        EXPECT_TRUE(q.push(i + 100));
+        EXPECT_EQ(q.size(), 2);
+        EXPECT_TRUE(q.pop(val));
+        EXPECT_EQ(val, i);
+        EXPECT_TRUE(q.pop(val));
+        EXPECT_EQ(val, i + 100);
+        EXPECT_EQ(q.size(), 0);
+        EXPECT_FALSE(q.pop(val));
+    }
+}
+
+TEST(FixedSizeQueue, bulk)
+{
+    typedef xtomic::queue<int, xtomic::Queue::FixedSize> queue_type;
+
+    const int in[] = { 1, 2, 3, 4 };
+    int out[4] = { 0 };
+
+    queue_type q(3);
+
+    EXPECT_EQ(q.push_bulk(in, in + 4), 3);
+    EXPECT_EQ(q.size(), 3);
+    EXPECT_EQ(q.push_bulk(in, in + 4), 0);
+
+    EXPECT_EQ(q.pop_bulk(out, 2), 2);
+    EXPECT_EQ(q.size(), 1);
+    EXPECT_EQ(q.pop_bulk(out + 2, 2), 1);
+    EXPECT_EQ(q.pop_bulk(out, 2), 0);
+    EXPECT_EQ(q.size(), 0);
+
+    // the same order as push() for each item would give
+    EXPECT_EQ(out[0], 3);
+    EXPECT_EQ(out[1], 2);
+    EXPECT_EQ(out[2], 1);
+}
+
+TEST(FixedSizeQueue, bulk_single_consumer)
+{
+    typedef xtomic::queue<int, xtomic::Queue::FixedSize, xtomic::Queue::ManyProducers, xtomic::Queue::OneConsumer> queue_type;
+
+    const int in[] = { 1, 2, 3, 4 };
+    std::vector<int> out;
+
+    queue_type q(9);
+
+    EXPECT_EQ(q.push_bulk(in, in + 4), 4);
+    EXPECT_TRUE(q.push(5));
+    EXPECT_EQ(q.push_bulk(in, in + 4), 4);
+    EXPECT_EQ(q.push_bulk(in, in + 4), 0);
+    EXPECT_EQ(q.size(), 9);
+
+    EXPECT_EQ(q.pop_bulk(std::back_inserter(out), 3), 3);
+    EXPECT_EQ(q.pop_bulk(std::back_inserter(out), 10), 6);
+    EXPECT_EQ(q.pop_bulk(std::back_inserter(out), 10), 0);
+    EXPECT_EQ(q.size(), 0);
+    EXPECT_EQ(out.size(), 9);
+    EXPECT_EQ(std::count(out.begin(), out.end(), 5), 1);
+    EXPECT_EQ(std::count(out.begin(), out.end(), 4), 2);
+}
+
+TEST(DynamicSizeQueue, bulk)
+{
+    typedef xtomic::queue<int, xtomic::Queue::DynamicSize> queue_type;
+
+    std::vector<int> in;
+    std::vector<int> out;
+    for (int i = 0; i < 100; ++i)
+    {
+        in.push_back(i);
+    }
+
+    queue_type q(10);
+
+    EXPECT_EQ(q.push_bulk(in.begin(), in.end()), 100);
+    EXPECT_EQ(q.size(), 100);
+    EXPECT_EQ(q.pop_bulk(std::back_inserter(out), 200), 100);
+    EXPECT_EQ(q.size(), 0);
+
+    std::sort(out.begin(), out.end());
+    EXPECT_TRUE(out == in);
+}
+
+TEST(WaitFreeQueue, bulk)
+{
+    typedef xtomic::make_wait_free_queue<int>::type queue_type;
+
+    const int in[] = { 1, 2, 3, 4 };
+    int out[4] = { 0 };
+
+    queue_type q(3);
+
+    EXPECT_EQ(q.push_bulk(in, in + 2), 2);
+    EXPECT_EQ(q.pop_bulk(out, 1), 1);
+    EXPECT_EQ(q.push_bulk(in + 2, in + 4), 2);
+    EXPECT_EQ(q.push_bulk(in, in + 4), 0);
+    EXPECT_EQ(q.size(), 3);
+    EXPECT_EQ(q.pop_bulk(out + 1, 4), 3);
+    EXPECT_EQ(q.pop_bulk(out, 4), 0);
+
+    EXPECT_EQ(out[0], 1);
+    EXPECT_EQ(out[1], 2);
+    EXPECT_EQ(out[2], 3);
+    EXPECT_EQ(out[3], 4);
+}
+
+TEST(RingQueue, traits)
+{
+    typedef xtomic::make_fixed_size_queue<int, std::allocator<int>, xtomic::Queue::ArrayBased>::type queue_type;
+
+    EXPECT_TRUE(queue_type::fixed_size);
+    EXPECT_TRUE(queue_type::many_producers);
+    EXPECT_TRUE(queue_type::many_consumers);
+    EXPECT_FALSE(queue_type::wait_free);
+}
+
+TEST(RingQueue, sequence)
+{
+    int val = 0;
+    typedef xtomic::make_fixed_size_queue<int, std::allocator<int>, xtomic::Queue::ArrayBased>::type queue_type;
+
+    queue_type q(3);
+
+    // capacity is rounded up to power of two
+    EXPECT_EQ(q.getCapacity(), 4);
+
+    for (int lap = 0; lap < 3; ++lap)
+    {
+        EXPECT_TRUE(q.push(1));
+        EXPECT_TRUE(q.push(2));
+        EXPECT_TRUE(q.push(3));
+        EXPECT_TRUE(q.push(4));
+        EXPECT_FALSE(q.push(5));
+        EXPECT_EQ(q.size(), 4);
+
+        // the ring keeps FIFO order
+        EXPECT_TRUE(q.pop(val));
+        EXPECT_EQ(val, 1);
+        EXPECT_TRUE(q.pop(val));
+        EXPECT_EQ(val, 2);
+        EXPECT_TRUE(q.pop(val));
+        EXPECT_EQ(val, 3);
+        EXPECT_TRUE(q.pop(val));
+        EXPECT_EQ(val, 4);
+        EXPECT_FALSE(q.pop(val));
+        EXPECT_EQ(q.size(), 0);
+    }
+}
+
+TEST(RingQueue, bulk)
+{
+    typedef xtomic::queue<int, xtomic::Queue::FixedSize, xtomic::Queue::ManyProducers,
+            xtomic::Queue::ManyConsumers, std::allocator<int>, xtomic::Queue::ArrayBased> queue_type;
+
+    const int in[] = { 1, 2, 3, 4, 5, 6 };
+    int out[6] = { 0 };
+
+    queue_type q(4);
+
+    EXPECT_EQ(q.push_bulk(in, in + 3), 3);
+    EXPECT_EQ(q.pop_bulk(out, 2), 2);
+    EXPECT_EQ(q.push_bulk(in + 3, in + 6), 3);
+    EXPECT_EQ(q.push_bulk(in, in + 6), 0);
+    EXPECT_EQ(q.pop_bulk(out + 2, 10), 4);
+    EXPECT_EQ(q.pop_bulk(out, 10), 0);
+
+    for (int i = 0; i < 6; ++i)
+    {
+        EXPECT_EQ(out[i], in[i]);
+    }
+}
+
+TEST(RingQueue, wait_free)
+{
+    typedef xtomic::queue<int, xtomic::Queue::FixedSize, xtomic::Queue::OneProducer,
+            xtomic::Queue::OneConsumer, std::allocator<int>, xtomic::Queue::ArrayBased> queue_type;
+
+    EXPECT_TRUE(queue_type::wait_free);
+
+    int val = 0;
+    queue_type q(3);
+    EXPECT_EQ(q.getCapacity(), 3);
+    EXPECT_TRUE(q.push(1));
+    EXPECT_TRUE(q.pop(val));
+    EXPECT_EQ(val, 1);
+}
+
+namespace
+{
+// the copy throws for negative values
+struct throwing_value
+{
+    int m_value;
+
+    throwing_value(int value = 0) :
+            m_value(value)
+    {
+    }
+    throwing_value(const throwing_value& other) :
+            m_value(other.m_value)
+    {
+        if (m_value < 0)
+        {
+            throw std::runtime_error("throwing_value");
+        }
+    }
+    throwing_value& operator=(const throwing_value& other)
+    {
+        m_value = other.m_value;
+        return *this;
+    }
+};
+}
+
+TEST(RingQueue, throwing_copy)
+{
+    typedef xtomic::make_fixed_size_queue<throwing_value,
+            std::allocator<throwing_value>, xtomic::Queue::ArrayBased>::type queue_type;
+
+    const throwing_value in[] = { 3, -1, 4 };
+    throwing_value out[4];
+    throwing_value val;
+
+    queue_type q(4);
+
+    // the failed items are lost, the ring goes on
+    EXPECT_TRUE(q.push(throwing_value(1)));
+    EXPECT_THROW(q.push(throwing_value(-1)), std::runtime_error);
+    EXPECT_TRUE(q.push(throwing_value(2)));
+    EXPECT_TRUE(q.pop(val));
+    EXPECT_EQ(1, val.m_value);
+    EXPECT_TRUE(q.pop(val));
+    EXPECT_EQ(2, val.m_value);
+    EXPECT_FALSE(q.pop(val));
+
+    EXPECT_THROW(q.push_bulk(in, in + 3), std::runtime_error);
+    EXPECT_EQ(1u, q.pop_bulk(out, 4));
+    EXPECT_EQ(3, out[0].m_value);
+    EXPECT_EQ(0u, q.size());
+
+    for (int lap = 0; lap < 3; ++lap)
+    {
+        EXPECT_EQ(4u, q.push_bulk(in + 2, in + 3) + q.push_bulk(in, in + 1)
+                + q.push_bulk(in + 2, in + 3) + q.push_bulk(in, in + 1));
+        EXPECT_EQ(4u, q.pop_bulk(out, 4));
+        EXPECT_EQ(4, out[0].m_value);
+        EXPECT_EQ(3, out[3].m_value);
+    }
+}
+
+namespace
+{
+// assignment of a negative value throws, live instances are counted
+struct throwing_assignment
+{
+    static int s_live;
+
+    int m_value;
+
+    throwing_assignment(int value = 0) :
+            m_value(value)
+    {
+        ++s_live;
+    }
+    throwing_assignment(const throwing_assignment& other) :
+            m_value(other.m_value)
+    {
+        ++s_live;
+    }
+    ~throwing_assignment()
+    {
+        --s_live;
+    }
+    throwing_assignment& operator=(const throwing_assignment& other)
+    {
+        if (other.m_value < 0)
+        {
+            throw std::runtime_error("throwing_assignment");
+        }
+        m_value = other.m_value;
+        return *this;
+    }
+};
+
+int throwing_assignment::s_live = 0;
+}
+
+TEST(RingQueue, throwing_assignment)
+{
+    typedef xtomic::make_fixed_size_queue<throwing_assignment,
+            std::allocator<throwing_assignment>, xtomic::Queue::ArrayBased>::type queue_type;
+
+    const throwing_assignment in[] = { 3, -1, 4 };
+    throwing_assignment out[4];
+    throwing_assignment val;
+    const int live = throwing_assignment::s_live;
+
+    {
+        queue_type q(4);
+
+        // the failed items are dropped, the ring goes on
+        EXPECT_TRUE(q.push(throwing_assignment(1)));
+        EXPECT_TRUE(q.push(throwing_assignment(-1)));
+        EXPECT_TRUE(q.push(throwing_assignment(2)));
+        EXPECT_TRUE(q.pop(val));
+        EXPECT_EQ(1, val.m_value);
+        EXPECT_THROW(q.pop(val), std::runtime_error);
+        EXPECT_TRUE(q.pop(val));
+        EXPECT_EQ(2, val.m_value);
+        EXPECT_FALSE(q.pop(val));
+        EXPECT_EQ(live, throwing_assignment::s_live);
+
+        // the cells after the failed one are dropped too
+        EXPECT_EQ(3u, q.push_bulk(in, in + 3));
+        EXPECT_THROW(q.pop_bulk(out, 4), std::runtime_error);
+        EXPECT_EQ(3, out[0].m_value);
+        EXPECT_EQ(0u, q.size());
+        EXPECT_EQ(live, throwing_assignment::s_live);
+
+        for (int lap = 0; lap < 3; ++lap)
+        {
+            EXPECT_EQ(4u, q.push_bulk(in + 2, in + 3) + q.push_bulk(in, in + 1)
+                    + q.push_bulk(in + 2, in + 3) + q.push_bulk(in, in + 1));
+            EXPECT_EQ(4u, q.pop_bulk(out, 4));
+            EXPECT_EQ(4, out[0].m_value);
+            EXPECT_EQ(3, out[3].m_value);
+        }
+        EXPECT_TRUE(q.push(throwing_assignment(5)));
+    }
+    EXPECT_EQ(live, throwing_assignment::s_live);
+}
+
+TEST(SegmentedQueue, traits)
+{
+    typedef xtomic::make_dynamic_size_queue<int, std::allocator<int>, xtomic::Queue::ArrayBased>::type queue_type;
+
+    EXPECT_FALSE(queue_type::fixed_size);
+    EXPECT_TRUE(queue_type::many_producers);
+    EXPECT_TRUE(queue_type::many_consumers);
+    EXPECT_FALSE(queue_type::wait_free);
+}
+
+TEST(SegmentedQueue, sequence)
+{
+    typedef xtomic::make_dynamic_size_queue<int, std::allocator<int>, xtomic::Queue::ArrayBased>::type queue_type;
+
+    // a few segments are filled and drained several times
+    const int count = 3000;
+    int val = 0;
+
+    queue_type q(10);
+
+    EXPECT_EQ(q.getCapacity(), 0);
+    for (int lap = 0; lap < 3; ++lap)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            EXPECT_TRUE(q.push(i));
+        }
+        EXPECT_EQ(q.size(), count);
+
+        // segments keep FIFO order
+        for (int i = 0; i < count; ++i)
+        {
+            EXPECT_TRUE(q.pop(val));
+            EXPECT_EQ(val, i);
+        }
+        EXPECT_FALSE(q.pop(val));
+        EXPECT_EQ(q.size(), 0);
+    }
+}
+
+TEST(SegmentedQueue, bulk)
+{
+    typedef xtomic::queue<int, xtomic::Queue::DynamicSize, xtomic::Queue::ManyProducers,
+            xtomic::Queue::ManyConsumers, std::allocator<int>, xtomic::Queue::ArrayBased> queue_type;
+
+    std::vector<int> in(2500);
+    for (std::size_t i = 0; i < in.size(); ++i)
+    {
+        in[i] = static_cast<int>(i);
+    }
+    std::vector<int> out;
+
+    queue_type q(0);
+
+    // the bursts cross segment boundaries
+    EXPECT_EQ(q.push_bulk(in.begin(), in.begin() + 1000), 1000);
+    EXPECT_EQ(q.pop_bulk(std::back_inserter(out), 10), 10);
+    EXPECT_EQ(q.push_bulk(in.begin() + 1000, in.end()), 1500);
+    EXPECT_EQ(q.size(), 2490);
+    EXPECT_EQ(q.pop_bulk(std::back_inserter(out), 5000), 2490);
+    EXPECT_EQ(q.pop_bulk(std::back_inserter(out), 10), 0);
+
+    EXPECT_TRUE(in == out);
+}
+
+TEST(SegmentedQueue, destroy_not_empty)
+{
+    typedef xtomic::make_dynamic_size_queue<std::vector<int>, std::allocator<std::vector<int> >,
+            xtomic::Queue::ArrayBased>::type queue_type;
+
+    queue_type q(0);
+    for (int i = 0; i < 2000; ++i)
+    {
+        EXPECT_TRUE(q.push(std::vector<int>(3, i)));
+    }
+    std::vector<int> val;
+    for (int i = 0; i < 1500; ++i)
+    {
+        EXPECT_TRUE(q.pop(val));
+        EXPECT_EQ(val[0], i);
+    }
+}
+
+TEST(NumaLocalQueue, bulk)
+{
+    typedef xtomic::make_fixed_size_queue<int, std::allocator<int>, xtomic::Queue::NodeBased,
+            xtomic::Buffer::NumaLocal>::type queue_type;
+
+    const int in[] = { 1, 2, 3, 4 };
+    int out[4] = { 0 };
+    int val = 0;
+
+    queue_type q(3);
+
+    EXPECT_EQ(q.getCapacity(), 3);
+    EXPECT_EQ(q.push_bulk(in, in + 4), 3);
+    EXPECT_FALSE(q.push(4));
+    EXPECT_EQ(q.pop_bulk(out, 4), 3);
+    EXPECT_EQ(q.size(), 0);
+
+    // all nodes are back
+    EXPECT_TRUE(q.push(1));
+    EXPECT_TRUE(q.push(2));
+    EXPECT_TRUE(q.push(3));
+    EXPECT_FALSE(q.push(4));
+    EXPECT_TRUE(q.pop(val));
+    EXPECT_EQ(q.size(), 2);
+}
@@ -92,3 +92,67 @@ TEST(MT_LockFreeQueue, dynamicSize_manyProducers_manyConsumers)
     EXPECT_TRUE(test.isDataComplete());
     EXPECT_LE(test.getMaxSequenceDiff(), Size);
 }
+
+TEST(MT_LockFreeQueue, ring_manyProducers_manyConsumers)
+{
+    enum {
+        Size = 1000000,
+        QueueSize = 1024,
+    };
+
+    typedef xtomic::queue<int, xtomic::Queue::FixedSize, xtomic::Queue::ManyProducers, xtomic::Queue::ManyConsumers,
+            std::allocator<int>, xtomic::Queue::ArrayBased> queue_type;
+    typedef xtomic::testing::queue_many2many<queue_type, Size, 2, 2> test_type;
+
+    queue_type q(QueueSize);
+    test_type test(q);
+
+    test.run();
+
+    EXPECT_EQ(0, test.getNumOfIncorrectValues());
+    EXPECT_TRUE(test.isDataComplete());
+    EXPECT_LE(test.getMaxSequenceDiff(), Size);
+}
+
+TEST(MT_LockFreeQueue, segmented_manyProducers_manyConsumers)
+{
+    enum {
+        Size = 1000000,
+        QueueSize = 100,
+    };
+
+    typedef xtomic::queue<int, xtomic::Queue::DynamicSize, xtomic::Queue::ManyProducers, xtomic::Queue::ManyConsumers,
+            std::allocator<int>, xtomic::Queue::ArrayBased> queue_type;
+    typedef xtomic::testing::queue_many2many<queue_type, Size, 2, 2> test_type;
+
+    queue_type q(QueueSize);
+    test_type test(q);
+
+    test.run();
+
+    EXPECT_EQ(0, test.getNumOfFailedPushes());
+    EXPECT_EQ(0, test.getNumOfIncorrectValues());
+    EXPECT_TRUE(test.isDataComplete());
+    EXPECT_LE(test.getMaxSequenceDiff(), Size);
+}
+
+TEST(MT_LockFreeQueue, threadCached_manyProducers_manyConsumers)
+{
+    enum {
+        Size = 100000,
+        QueueSize = 100,
+    };
+
+    typedef xtomic::make_fixed_size_queue<int, std::allocator<int>, xtomic::Queue::NodeBased,
+            xtomic::Buffer::ThreadCached>::type queue_type;
+    typedef xtomic::testing::queue_many2many<queue_type, Size, 2, 2> test_type;
+
+    queue_type q(QueueSize);
+    test_type test(q);
+
+    test.run();
+
+    EXPECT_EQ(0, test.getNumOfIncorrectValues());
+    EXPECT_TRUE(test.isDataComplete());
+    EXPECT_LE(test.getMaxSequenceDiff(), Size);
+}
@@ -130,6 +130,11 @@ private:
             }
             while (!res && !This.m_finish);
 
+            if ( !res )
+            {
+                // the last item might have been pushed right before the producer finished
+                res = This.m_q.pop(val);
+            }
             if ( !res )
             {
                 break;
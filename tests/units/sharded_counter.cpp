@@ -0,0 +1,149 @@
+/*
+ * sharded_counter.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: masha
+ */
+
+#include <gtest/gtest.h>
+
+#include <xtomic/impl/sharded_counter.hpp>
+
+#include <pthread.h>
+
+TEST(ShardedCounter, exactBatch)
+{
+    xtomic::sharded_counter counter;
+
+    EXPECT_EQ(0u, counter.error());
+    ++counter;
+    ++counter;
+    counter.add(5);
+    --counter;
+    EXPECT_EQ(6u, counter.approximate());
+    EXPECT_EQ(6u, counter.exact());
+}
+
+TEST(ShardedCounter, approximate)
+{
+    xtomic::sharded_counter counter(4);
+
+    EXPECT_EQ(counter.getSlots() * 3, counter.error());
+
+    // the changes stay in the slot until they amount to the batch
+    ++counter;
+    ++counter;
+    ++counter;
+    EXPECT_EQ(0u, counter.approximate());
+    EXPECT_EQ(3u, counter.exact());
+
+    ++counter;
+    EXPECT_EQ(4u, counter.approximate());
+    EXPECT_EQ(4u, counter.exact());
+
+    counter.add(10);
+    EXPECT_EQ(14u, counter.approximate());
+    EXPECT_EQ(14u, counter.exact());
+
+    --counter;
+    EXPECT_EQ(14u, counter.approximate());
+    EXPECT_EQ(13u, counter.exact());
+
+    counter.sub(13);
+    EXPECT_EQ(0u, counter.approximate());
+    EXPECT_EQ(0u, counter.exact());
+}
+
+TEST(ShardedCounter, negativeIsZero)
+{
+    xtomic::sharded_counter counter(4);
+
+    // a decrement of other thread may be seen before the increment
+    counter.sub(6);
+    EXPECT_EQ(0u, counter.approximate());
+    EXPECT_EQ(0u, counter.exact());
+    counter.add(8);
+    EXPECT_EQ(2u, counter.exact());
+}
+
+TEST(ShardedCounter, reset)
+{
+    xtomic::sharded_counter counter(4);
+
+    counter.add(7);
+    counter.reset(8);
+    EXPECT_EQ(0u, counter.exact());
+    EXPECT_EQ(8u, counter.getBatch());
+    EXPECT_EQ(counter.getSlots() * 7, counter.error());
+
+    // the slots are not needed with the batch of 1
+    counter.add(3);
+    counter.reset(1);
+    EXPECT_EQ(0u, counter.error());
+    counter.add(5);
+    EXPECT_EQ(5u, counter.approximate());
+    EXPECT_EQ(5u, counter.exact());
+}
+
+TEST(ShardedCounter, slots)
+{
+    const std::size_t maxSlots = xtomic::sharded_counter::SLOTS;
+    xtomic::sharded_counter counter(4);
+
+    // a power of two
+    EXPECT_GE(counter.getSlots(), 1u);
+    EXPECT_LE(counter.getSlots(), maxSlots);
+    EXPECT_EQ(0u, counter.getSlots() & (counter.getSlots() - 1));
+}
+
+namespace
+{
+struct counting_thread
+{
+    static const int COUNT = 100000;
+
+    xtomic::sharded_counter* m_counter;
+    int m_step;
+
+    static void* run(void* param)
+    {
+        counting_thread* self = static_cast<counting_thread*>(param);
+        for (int i = 0; i < COUNT; ++i)
+        {
+            self->m_counter->add(self->m_step);
+            if (i % 3 == 0)
+            {
+                self->m_counter->sub(1);
+            }
+        }
+        return nullptr;
+    }
+};
+}
+
+TEST(MT_ShardedCounter, threads)
+{
+    static const int THREADS = 8;
+
+    xtomic::sharded_counter counter(16);
+    counting_thread params[THREADS];
+    pthread_t threads[THREADS];
+    std::size_t expected = 0;
+
+    for (int i = 0; i < THREADS; ++i)
+    {
+        params[i].m_counter = &counter;
+        params[i].m_step = i + 1;
+        expected += (i + 1) * counting_thread::COUNT
+                - (counting_thread::COUNT + 2) / 3;
+        pthread_create(threads + i, nullptr, &counting_thread::run,
+                params + i);
+    }
+    for (int i = 0; i < THREADS; ++i)
+    {
+        pthread_join(threads[i], nullptr);
+    }
+    EXPECT_EQ(expected, counter.exact());
+    EXPECT_LE(counter.approximate(), expected + counter.error());
+    EXPECT_GE(counter.approximate() + counter.error(), expected);
+}
@@ -0,0 +1,195 @@
+/*
+ * sharded_hash_map.cpp
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: masha
+ */
+
+#include <gtest/gtest.h>
+
+#include <xtomic/sharded_hash_map.hpp>
+#include <utils/my-int-wrapper.hpp>
+#include "map_insert_erase.hpp"
+
+#include <algorithm>
+#include <string>
+
+TEST(ShardedHashMap, insertFindErase)
+{
+    typedef xtomic::sharded_hash_map<int, int, 8> map_type;
+    typedef map_type::size_type size_type;
+
+    map_type hm;
+    int val = 0;
+
+    EXPECT_EQ(static_cast<size_type>(0), hm.size());
+    EXPECT_FALSE(hm.find(1, val));
+    EXPECT_FALSE(hm.erase(1));
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        EXPECT_TRUE(hm.insert(i, -i));
+    }
+    EXPECT_FALSE(hm.insert(1, 1));
+    EXPECT_EQ(static_cast<size_type>(1000), hm.size());
+
+    hm.insertOrUpdate(1, 1);
+    EXPECT_TRUE(hm.find(1, val));
+    EXPECT_EQ(1, val);
+    EXPECT_EQ(-2, hm.find(2));
+
+    for (int i = 0; i < 1000; i += 2)
+    {
+        EXPECT_TRUE(hm.erase(i));
+    }
+    EXPECT_EQ(static_cast<size_type>(500), hm.size());
+    for (int i = 0; i < 1000; ++i)
+    {
+        EXPECT_EQ(i % 2 != 0, hm.find(i, val));
+    }
+}
+
+TEST(ShardedHashMap, singleShard)
+{
+    typedef xtomic::sharded_hash_map<std::string, std::string, 1> map_type;
+
+    map_type hm;
+    std::string val;
+
+    EXPECT_TRUE(hm.insert("1", "one"));
+    EXPECT_TRUE(hm.find("1", val));
+    EXPECT_EQ("one", val);
+    EXPECT_TRUE(hm.erase("1"));
+    EXPECT_FALSE(hm.find("1", val));
+}
+
+TEST(ShardedHashMap, keysAreSpread)
+{
+    // identity hash of sequential keys must not land in a few shards
+    typedef xtomic::sharded_hash_map<int, int, 16, std::hash<int>,
+            std::equal_to<int>, std::allocator<int>,
+            xtomic::memory_model::greedy, xtomic::rehashing::stop_the_world,
+            xtomic::indexing::power_of_two> map_type;
+    typedef map_type::size_type size_type;
+
+    const int shardCapacity = 1024;
+    map_type hm(map_type::SHARDS * shardCapacity);
+
+    const size_type capacity = hm.getCapacity();
+    EXPECT_GE(capacity, static_cast<size_type>(map_type::SHARDS * shardCapacity));
+
+    // a half of the capacity fits into every shard unless the keys cluster
+    for (int i = 0; i < static_cast<int>(map_type::SHARDS * shardCapacity / 2);
+            ++i)
+    {
+        EXPECT_TRUE(hm.insert(i, i));
+    }
+    EXPECT_EQ(capacity, hm.getCapacity());
+}
+
+TEST(ShardedHashMap, shardsGrowIndependently)
+{
+    typedef xtomic::sharded_hash_map<int, int, 4> map_type;
+    typedef map_type::size_type size_type;
+
+    map_type hm;
+    const size_type initial = hm.getCapacity();
+    const int size = static_cast<int>(initial) * 8;
+
+    for (int i = 0; i < size; ++i)
+    {
+        EXPECT_TRUE(hm.insert(i, i + 1));
+    }
+    EXPECT_EQ(static_cast<size_type>(size), hm.size());
+    EXPECT_GE(hm.getCapacity(), static_cast<size_type>(size));
+
+    int val = 0;
+    for (int i = 0; i < size; ++i)
+    {
+        EXPECT_TRUE(hm.find(i, val));
+        EXPECT_EQ(i + 1, val);
+    }
+
+    for (int i = 0; i < size; ++i)
+    {
+        EXPECT_TRUE(hm.erase(i));
+    }
+    hm.shrink_to_fit();
+    EXPECT_EQ(static_cast<size_type>(0), hm.size());
+    EXPECT_EQ(initial, hm.getCapacity());
+}
+
+TEST(ShardedHashMap, updateFetchAdd)
+{
+    typedef xtomic::sharded_hash_map<int, int, 4> map_type;
+
+    map_type hm;
+    int val = 1;
+
+    EXPECT_EQ(0, hm.fetch_add(1, 5));
+    EXPECT_EQ(5, hm.fetch_add(1, 3));
+    EXPECT_TRUE(hm.update(1, [](int& value) { value *= 2; }));
+    EXPECT_FALSE(hm.update(2, [](int& value) { value *= 2; }));
+    EXPECT_EQ(16, hm.find(1));
+
+    EXPECT_TRUE(hm.find_or_insert(2, val));
+    val = 3;
+    EXPECT_FALSE(hm.find_or_insert(2, val));
+    EXPECT_EQ(1, val);
+}
+
+TEST(ShardedHashMap, lowWatermark)
+{
+    xtomic::sharded_hash_map<int, int, 4> hm;
+
+    hm.setLowWatermark(0);
+    EXPECT_EQ(0u, hm.getLowWatermark());
+    hm.setLowWatermark(20);
+    EXPECT_EQ(20u, hm.getLowWatermark());
+}
+
+TEST(ShardedHashMap, snapshot)
+{
+    typedef xtomic::sharded_hash_map<int, int> map_type;
+    typedef map_type::snapshot_type snapshot_type;
+
+    map_type hm;
+    snapshot_type snapshot;
+
+    snapshot.push_back(std::make_pair(1, 1));
+    hm.getSnapshot(snapshot);
+    EXPECT_TRUE(snapshot.empty());
+
+    const int size = 100;
+    for (int i = 0; i < size; ++i)
+    {
+        hm.insert(i, -i);
+    }
+    hm.getSnapshot(snapshot);
+    ASSERT_EQ(static_cast<std::size_t>(size), snapshot.size());
+
+    std::sort(snapshot.begin(), snapshot.end());
+    for (int i = 0; i < size; ++i)
+    {
+        EXPECT_EQ(i, snapshot[i].first);
+        EXPECT_EQ(-i, snapshot[i].second);
+    }
+}
+
+TEST(ShardedHashMap, Multithread)
+{
+    typedef xtomic::my::int_wrapper<int> key_type;
+    typedef xtomic::sharded_hash_map<key_type, key_type, 8,
+            xtomic::my::make_hash<key_type>::type> map_type;
+    typedef xtomic::testing::map_insert_erase<map_type, 100000, 1000000> test_type;
+
+    map_type map;
+    test_type test(map);
+
+    test.run();
+
+    EXPECT_EQ(0u, test.getFailsOnInsert());
+    EXPECT_EQ(0u, test.getFailsOnFind());
+    EXPECT_EQ(0u, test.getFailsOnMissing());
+    EXPECT_EQ(0u, test.getFailsOnErase());
+}
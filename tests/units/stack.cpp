@@ -9,6 +9,97 @@
 
 #include <xtomic/stack.hpp>
 
+#include <pthread.h>
+
+namespace
+{
+
+// each thread pushes its own range of values and pops whatever it finds
+template<typename Stack, int Size, int Threads>
+class stack_many2many
+{
+public:
+    typedef stack_many2many<Stack, Size, Threads> this_type;
+
+    stack_many2many(Stack& s) :
+            m_stack(s),
+            m_sum(0),
+            m_popped(0)
+    {
+    }
+
+    void run()
+    {
+        pthread_t threads[Threads];
+        for (int i = 0; i < Threads; ++i)
+        {
+            m_args[i].m_this = this;
+            m_args[i].m_index = i;
+            pthread_create(&threads[i], 0, &worker, &m_args[i]);
+        }
+        for (int i = 0; i < Threads; ++i)
+        {
+            pthread_join(threads[i], 0);
+        }
+    }
+
+    long long getSum() const
+    {
+        return m_sum.load(xtomic::barriers::relaxed);
+    }
+
+    static long long expectedSum()
+    {
+        const long long n = static_cast<long long>(Size) * Threads;
+        return n * (n - 1) / 2;
+    }
+
+private:
+    struct arg_type
+    {
+        this_type* m_this;
+        int m_index;
+    };
+
+    static void* worker(void* arg)
+    {
+        arg_type* a = reinterpret_cast<arg_type*>(arg);
+        this_type* pThis = a->m_this;
+        long long sum = 0;
+        for (int i = 0; i < Size; ++i)
+        {
+            while (!pThis->m_stack.push(a->m_index * Size + i))
+            {
+                pThis->tryPop(sum);
+            }
+            pThis->tryPop(sum);
+        }
+        while (pThis->m_popped.load(xtomic::barriers::relaxed) < Size * Threads)
+        {
+            pThis->tryPop(sum);
+        }
+        pThis->m_sum.fetch_add(sum, xtomic::barriers::relaxed);
+        return 0;
+    }
+    void tryPop(long long& sum)
+    {
+        int val = 0;
+        if (m_stack.pop(val))
+        {
+            sum += val;
+            ++m_popped;
+        }
+    }
+
+private:
+    Stack& m_stack;
+    xtomic::quantum<long long> m_sum;
+    xtomic::quantum<int> m_popped;
+    arg_type m_args[Threads];
+};
+
+}
+
 TEST(FixedSizeStack, pop)
 {
     int val;
@@ -102,3 +193,174 @@ TEST(DynamicSizeStack, sequence)
     EXPECT_FALSE(s.pop(val));
 }
 
+
+TEST(EliminationStack, sequence)
+{
+    int val = 0;
+    typedef xtomic::stack<int, true, std::allocator<int>, true> stack_type;
+
+    EXPECT_TRUE(stack_type::elimination);
+
+    stack_type s(3);
+
+    EXPECT_TRUE(s.push(1));
+    EXPECT_TRUE(s.push(2));
+    EXPECT_TRUE(s.push(3));
+    EXPECT_FALSE(s.push(4));
+
+    EXPECT_TRUE(s.pop(val));
+    EXPECT_EQ(val, 3);
+    EXPECT_TRUE(s.pop(val));
+    EXPECT_EQ(val, 2);
+    EXPECT_TRUE(s.pop(val));
+    EXPECT_EQ(val, 1);
+
+    EXPECT_FALSE(s.pop(val));
+}
+
+TEST(MT_EliminationStack, fixedSize_manyThreads)
+{
+    enum
+    {
+        Size = 200000,
+        Threads = 4,
+    };
+    typedef xtomic::stack<int, true, std::allocator<int>, true> stack_type;
+    typedef stack_many2many<stack_type, Size, Threads> test_type;
+
+    stack_type s(Threads);
+    test_type test(s);
+
+    test.run();
+
+    EXPECT_EQ(test.getSum(), test_type::expectedSum());
+    EXPECT_EQ(s.size(), 0);
+}
+
+TEST(MT_EliminationStack, dynamicSize_manyThreads)
+{
+    enum
+    {
+        Size = 200000,
+        Threads = 4,
+    };
+    typedef xtomic::stack<int, false, std::allocator<int>, true> stack_type;
+    typedef stack_many2many<stack_type, Size, Threads> test_type;
+
+    stack_type s(0);
+    test_type test(s);
+
+    test.run();
+
+    EXPECT_EQ(test.getSum(), test_type::expectedSum());
+    EXPECT_EQ(s.size(), 0);
+}
+
+TEST(ThreadCachedStack, sequence)
+{
+    int val = 0;
+    typedef xtomic::stack<int, true, std::allocator<int>, false,
+            xtomic::Buffer::ThreadCached> stack_type;
+
+    stack_type s(3);
+
+    EXPECT_TRUE(s.push(1));
+    EXPECT_TRUE(s.push(2));
+    EXPECT_TRUE(s.push(3));
+    EXPECT_FALSE(s.push(4));
+
+    EXPECT_TRUE(s.pop(val));
+    EXPECT_EQ(val, 3);
+    EXPECT_TRUE(s.push(4));
+    EXPECT_TRUE(s.pop(val));
+    EXPECT_EQ(val, 4);
+    EXPECT_TRUE(s.pop(val));
+    EXPECT_EQ(val, 2);
+    EXPECT_TRUE(s.pop(val));
+    EXPECT_EQ(val, 1);
+
+    EXPECT_FALSE(s.pop(val));
+}
+
+TEST(MT_ThreadCachedStack, fixedSize_manyThreads)
+{
+    enum
+    {
+        Size = 200000,
+        Threads = 4,
+    };
+    typedef xtomic::stack<int, true, std::allocator<int>, false,
+            xtomic::Buffer::ThreadCached> stack_type;
+    typedef stack_many2many<stack_type, Size, Threads> test_type;
+
+    stack_type s(Threads);
+    test_type test(s);
+
+    test.run();
+
+    EXPECT_EQ(test.getSum(), test_type::expectedSum());
+    EXPECT_EQ(s.size(), 0);
+}
+
+TEST(MT_ThreadCachedStack, dynamicSize_manyThreads)
+{
+    enum
+    {
+        Size = 200000,
+        Threads = 4,
+    };
+    typedef xtomic::stack<int, false, std::allocator<int>, false,
+            xtomic::Buffer::ThreadCached> stack_type;
+    typedef stack_many2many<stack_type, Size, Threads> test_type;
+
+    stack_type s(0);
+    test_type test(s);
+
+    test.run();
+
+    EXPECT_EQ(test.getSum(), test_type::expectedSum());
+    EXPECT_EQ(s.size(), 0);
+}
+
+TEST(NumaLocalStack, sequence)
+{
+    int val = 0;
+    typedef xtomic::stack<int, true, std::allocator<int>, false,
+            xtomic::Buffer::NumaLocal> stack_type;
+
+    stack_type s(3);
+
+    EXPECT_TRUE(s.push(1));
+    EXPECT_TRUE(s.push(2));
+    EXPECT_TRUE(s.push(3));
+    EXPECT_FALSE(s.push(4));
+
+    EXPECT_TRUE(s.pop(val));
+    EXPECT_EQ(val, 3);
+    EXPECT_TRUE(s.pop(val));
+    EXPECT_EQ(val, 2);
+    EXPECT_TRUE(s.pop(val));
+    EXPECT_EQ(val, 1);
+
+    EXPECT_FALSE(s.pop(val));
+}
+
+TEST(MT_NumaLocalStack, fixedSize_manyThreads)
+{
+    enum
+    {
+        Size = 200000,
+        Threads = 4,
+    };
+    typedef xtomic::stack<int, true, std::allocator<int>, false,
+            xtomic::Buffer::NumaLocal> stack_type;
+    typedef stack_many2many<stack_type, Size, Threads> test_type;
+
+    stack_type s(Threads);
+    test_type test(s);
+
+    test.run();
+
+    EXPECT_EQ(test.getSum(), test_type::expectedSum());
+    EXPECT_EQ(s.size(), 0);
+}
@@ -82,3 +82,56 @@ TEST(stack_base_aba, atomic_push3)
     EXPECT_EQ(stack.atomic_pop(), static_cast<node_type*>(0));
 }
 
+
+TEST(stack_base_aba, atomic_push_chain)
+{
+    typedef xtomic::stack_base_aba<int> stack_type;
+    typedef stack_type::node_type node_type;
+
+    stack_type stack;
+    node_type a[4];
+    stack.atomic_push(&a[0]);
+    a[3].m_next = &a[2];
+    a[2].m_next = &a[1];
+    stack.atomic_push(&a[3], &a[1]);
+
+    std::size_t count = 3;
+    node_type* p = stack.atomic_pop(count);
+    EXPECT_EQ(count, 3);
+    EXPECT_EQ(p, &a[3]);
+    EXPECT_EQ(p->m_next, &a[2]);
+    EXPECT_EQ(p->m_next->m_next, &a[1]);
+    EXPECT_EQ(p->m_next->m_next->m_next, static_cast<node_type*>(0));
+
+    count = 3;
+    p = stack.atomic_pop(count);
+    EXPECT_EQ(count, 1);
+    EXPECT_EQ(p, &a[0]);
+
+    count = 3;
+    EXPECT_EQ(stack.atomic_pop(count), static_cast<node_type*>(0));
+    EXPECT_EQ(count, 0);
+}
+
+TEST(stack_base_aba, try_push_pop)
+{
+    typedef xtomic::stack_base_aba<int> stack_type;
+    typedef stack_type::node_type node_type;
+
+    stack_type stack;
+    node_type a[2];
+    node_type* p = &a[0];
+
+    // empty stack is not a failure
+    EXPECT_TRUE(stack.try_pop(p));
+    EXPECT_EQ(p, static_cast<node_type*>(0));
+
+    EXPECT_TRUE(stack.try_push(&a[0]));
+    EXPECT_TRUE(stack.try_push(&a[1]));
+    EXPECT_TRUE(stack.try_pop(p));
+    EXPECT_EQ(p, &a[1]);
+    EXPECT_TRUE(stack.try_pop(p));
+    EXPECT_EQ(p, &a[0]);
+    EXPECT_TRUE(stack.try_pop(p));
+    EXPECT_EQ(p, static_cast<node_type*>(0));
+}
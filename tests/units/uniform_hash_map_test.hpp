@@ -17,19 +17,28 @@
 
 #include <ctime>
 #include <cstdlib>
+#include <vector>
+#include <pthread.h>
 
 template<typename Key, typename Value, typename Hash,
-        xtomic::memory_model::type model>
-struct make_hash_table;
+        xtomic::memory_model::type model, xtomic::rehashing::type rehashing,
+        xtomic::indexing::type indexing>
+struct make_hash_table
+{
+    typedef xtomic::hash_map<Key, Value, Hash, std::equal_to<Key>,
+            std::allocator<Value>, model, rehashing, indexing> type;
+};
 
 template<typename Key, typename Value, typename Hash>
-struct make_hash_table<Key, Value, Hash, xtomic::memory_model::wise>
+struct make_hash_table<Key, Value, Hash, xtomic::memory_model::wise,
+        xtomic::rehashing::stop_the_world, xtomic::indexing::modulo>
 {
     typedef typename xtomic::make_wise_hash_map<Key, Value, Hash>::type type;
 };
 
 template<typename Key, typename Value, typename Hash>
-struct make_hash_table<Key, Value, Hash, xtomic::memory_model::greedy>
+struct make_hash_table<Key, Value, Hash, xtomic::memory_model::greedy,
+        xtomic::rehashing::stop_the_world, xtomic::indexing::modulo>
 {
     typedef typename xtomic::make_greedy_hash_map<Key, Value, Hash>::type type;
 };
@@ -77,7 +86,9 @@ struct map_traits<map_type::IntegralPair>
 };
 
 template<typename Key, typename Value, xtomic::memory_model::type MemoryModel,
-        map_type::type MapType>
+        map_type::type MapType,
+        xtomic::rehashing::type Rehashing = xtomic::rehashing::stop_the_world,
+        xtomic::indexing::type Indexing = xtomic::indexing::modulo>
 struct unform_hash_map_tester
 {
     static constexpr int MapSize = static_cast<int>(1e5);
@@ -87,7 +98,7 @@ struct unform_hash_map_tester
     typedef Value mapped_type;
     typedef typename xtomic::my::make_hash<Key>::type hash_type;
     typedef typename make_hash_table<key_type, mapped_type, hash_type,
-            MemoryModel>::type map_type;
+            MemoryModel, Rehashing, Indexing>::type map_type;
     typedef typename map_type::size_type size_type;
     typedef typename map_type::snapshot_type snapshot_type;
     typedef xtomic::testing::map_insert_erase<map_type, MapSize, NumRepetitions> mt_test_type;
@@ -99,6 +110,8 @@ struct unform_hash_map_tester
     static constexpr bool INTEGRAL_KEYVALUE = map_type::INTEGRAL_KEYVALUE;
     static constexpr xtomic::memory_model::type MEMORY_MODEL =
             map_type::MEMORY_MODEL;
+    static constexpr xtomic::rehashing::type REHASHING = map_type::REHASHING;
+    static constexpr xtomic::indexing::type INDEXING = map_type::INDEXING;
 
     static void testTypeTraits()
     {
@@ -117,6 +130,10 @@ struct unform_hash_map_tester
 
         const xtomic::memory_model::type memoryModel = MEMORY_MODEL;
         EXPECT_EQ(memoryModel, MemoryModel);
+        const xtomic::rehashing::type rehashing = REHASHING;
+        EXPECT_EQ(rehashing, Rehashing);
+        const xtomic::indexing::type indexing = INDEXING;
+        EXPECT_EQ(indexing, Indexing);
     }
 
     static void testEmpty()
@@ -420,6 +437,150 @@ struct unform_hash_map_tester
         }
     }
 
+    static void testGrowAndErase()
+    {
+        map_type hm;
+
+        const int size = 20000;
+        mapped_type val;
+
+        // the first half of keys is erased while the table grows
+        for (int i = 1; i <= size; ++i)
+        {
+            EXPECT_TRUE(hm.insert(i, i + 100));
+            if (i % 2 == 0)
+            {
+                EXPECT_TRUE(hm.erase(i / 2));
+                EXPECT_FALSE(hm.find(i / 2, val));
+            }
+            EXPECT_TRUE(hm.find(i, val));
+        }
+
+        EXPECT_EQ(static_cast<size_type>(size / 2), hm.size());
+
+        for (int i = 1; i <= size; ++i)
+        {
+            bool result = hm.find(i, val);
+            EXPECT_EQ(i > size / 2, result);
+            if (result)
+            {
+                EXPECT_EQ(static_cast<mapped_type>(i + 100), val);
+            }
+        }
+
+        snapshot_type snapshot;
+        hm.getSnapshot(snapshot);
+        EXPECT_EQ(static_cast<std::size_t>(size / 2), snapshot.size());
+    }
+
+    static void testChurn()
+    {
+        map_type hm;
+
+        const int size = 20000;
+        const int live = 100;
+        mapped_type val;
+
+        // distinct keys are inserted and erased, the number of items is constant
+        for (int i = 1; i <= size; ++i)
+        {
+            EXPECT_TRUE(hm.insert(i, i + 100));
+            if (i > live)
+            {
+                EXPECT_TRUE(hm.erase(i - live));
+            }
+        }
+
+        EXPECT_EQ(static_cast<size_type>(live), hm.size());
+        // tombstones are dropped instead of growing the table
+        EXPECT_GT(static_cast<size_type>(live * 8), hm.getCapacity());
+
+        for (int i = 1; i <= size; ++i)
+        {
+            bool result = hm.find(i, val);
+            EXPECT_EQ(i > size - live, result);
+            if (result)
+            {
+                EXPECT_EQ(static_cast<mapped_type>(i + 100), val);
+            }
+        }
+    }
+
+    static void testShrink()
+    {
+        map_type hm;
+
+        const int size = 20000;
+        const int live = 100;
+        mapped_type val;
+
+        for (int i = 1; i <= size; ++i)
+        {
+            EXPECT_TRUE(hm.insert(i, i + 100));
+        }
+        const size_type capacity = hm.getCapacity();
+
+        // erase operation shrinks the table
+        for (int i = live + 1; i <= size; ++i)
+        {
+            EXPECT_TRUE(hm.erase(i));
+        }
+
+        EXPECT_EQ(static_cast<size_type>(live), hm.size());
+        EXPECT_GT(capacity / 8, hm.getCapacity());
+
+        for (int i = 1; i <= size; ++i)
+        {
+            bool result = hm.find(i, val);
+            EXPECT_EQ(i <= live, result);
+            if (result)
+            {
+                EXPECT_EQ(static_cast<mapped_type>(i + 100), val);
+            }
+        }
+    }
+
+    static void testShrinkToFit()
+    {
+        map_type hm(1000);
+
+        const int size = 20000;
+        const int live = 100;
+        mapped_type val;
+
+        hm.setLowWatermark(0);
+        EXPECT_EQ(0U, hm.getLowWatermark());
+
+        for (int i = 1; i <= size; ++i)
+        {
+            EXPECT_TRUE(hm.insert(i, i + 100));
+        }
+        const size_type capacity = hm.getCapacity();
+
+        for (int i = live + 1; i <= size; ++i)
+        {
+            EXPECT_TRUE(hm.erase(i));
+        }
+        EXPECT_EQ(capacity, hm.getCapacity());
+
+        hm.shrink_to_fit();
+
+        EXPECT_EQ(static_cast<size_type>(live), hm.size());
+        EXPECT_GT(capacity / 8, hm.getCapacity());
+        // the initial capacity is kept
+        EXPECT_LE(static_cast<size_type>(1000), hm.getCapacity());
+
+        for (int i = 1; i <= size; ++i)
+        {
+            bool result = hm.find(i, val);
+            EXPECT_EQ(i <= live, result);
+            if (result)
+            {
+                EXPECT_EQ(static_cast<mapped_type>(i + 100), val);
+            }
+        }
+    }
+
     static void testRandom()
     {
         srand(time(nullptr));
@@ -470,7 +631,7 @@ struct unform_hash_map_tester
 
         typedef xtomic::hash_map<sized_key_type, sized_mapped_type,
                 inner_hash_type, equal_func_type, allocator_type,
-                map_type::MEMORY_MODEL> inner_hash_map_type;
+                map_type::MEMORY_MODEL, map_type::REHASHING> inner_hash_map_type;
         typedef typename inner_hash_map_type::size_type size_type;
 
         static constexpr bool INTEGRAL_KEY = inner_hash_map_type::INTEGRAL_KEY;
@@ -530,6 +691,226 @@ struct unform_hash_map_tester
         compile_tester<int64_t, int32_t>()();
     }
 
+    static void testFindBatch()
+    {
+        map_type hm;
+
+        const int size = static_cast<int>(hm.getCapacity()) * 2 + 1;
+        for (int i = 0; i < size; ++i)
+        {
+            hm.insert(i, -i);
+        }
+
+        // present and missing keys take turns, the batch spans several words of the mask
+        std::vector<key_type> keys;
+        for (int i = 0; i < size * 2; ++i)
+        {
+            keys.push_back(i % 2 ? i / 2 : size + i / 2);
+        }
+        std::vector<mapped_type> values(keys.size(), mapped_type(1));
+        std::vector<xtomic::uint64_t> mask((keys.size() + 63) / 64, ~0ULL);
+
+        const size_type found = hm.find_batch(&keys[0], keys.size(), &values[0],
+                &mask[0]);
+        EXPECT_EQ(static_cast<size_type>(size), found);
+
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            const bool bit = (mask[i / 64] >> (i % 64)) & 1;
+            EXPECT_EQ(i % 2 != 0, bit);
+            EXPECT_EQ(i % 2 ? mapped_type(-static_cast<int>(i / 2)) : mapped_type(1),
+                    values[i]);
+        }
+        if (keys.size() % 64)
+        {
+            EXPECT_EQ(0ULL, mask.back() >> (keys.size() % 64));
+        }
+
+        EXPECT_EQ(static_cast<size_type>(0), hm.find_batch(&keys[0], 0, &values[0],
+                &mask[0]));
+    }
+
+    static void testInsertRange()
+    {
+        map_type hm;
+
+        hm.insert(0, 1);
+
+        // the first of equal keys wins, the keys of the map keep their values
+        std::vector<std::pair<key_type, mapped_type> > items;
+        const int size = static_cast<int>(hm.getCapacity()) * 8;
+        for (int i = 0; i < size; ++i)
+        {
+            items.push_back(std::make_pair(key_type(i), mapped_type(-i)));
+        }
+        items.push_back(std::make_pair(key_type(1), mapped_type(1)));
+
+        EXPECT_EQ(static_cast<size_type>(size - 1),
+                hm.insert_range(items.begin(), items.end()));
+        EXPECT_EQ(static_cast<size_type>(size), hm.size());
+        EXPECT_GE(hm.getCapacity(), static_cast<size_type>(size));
+
+        mapped_type val;
+        EXPECT_TRUE(hm.find(0, val));
+        EXPECT_EQ(mapped_type(1), val);
+        for (int i = 1; i < size; ++i)
+        {
+            EXPECT_TRUE(hm.find(i, val));
+            EXPECT_EQ(mapped_type(-i), val);
+        }
+        EXPECT_FALSE(hm.find(size, val));
+
+        EXPECT_EQ(static_cast<size_type>(0),
+                hm.insert_range(items.begin(), items.begin()));
+    }
+
+    static void testBulkLoad()
+    {
+        std::vector<std::pair<key_type, mapped_type> > items;
+        const int size = 100000;
+        for (int i = 0; i < size; ++i)
+        {
+            items.push_back(std::make_pair(key_type(i), mapped_type(-i)));
+        }
+        items.push_back(std::make_pair(key_type(1), mapped_type(1)));
+
+        map_type hm(items.begin(), items.end(), 4);
+
+        EXPECT_EQ(static_cast<size_type>(size), hm.size());
+        mapped_type val;
+        for (int i = 0; i < size; ++i)
+        {
+            EXPECT_TRUE(hm.find(i, val));
+            EXPECT_EQ(mapped_type(-i), val);
+        }
+        // the map was sized for the items
+        EXPECT_GE(hm.getCapacity(), static_cast<size_type>(size));
+        EXPECT_LT(hm.getCapacity(), static_cast<size_type>(size) * 2);
+    }
+
+    struct value_doubler
+    {
+        void operator()(mapped_type& value) const
+        {
+            value = value + value;
+        }
+    };
+
+    static void testUpdate()
+    {
+        map_type hm;
+        mapped_type val;
+
+        EXPECT_FALSE(hm.update(1, value_doubler()));
+        EXPECT_FALSE(hm.find(1, val));
+
+        // the map grows on the way
+        const int size = static_cast<int>(hm.getCapacity()) * 4;
+        for (int i = 0; i < size; ++i)
+        {
+            hm.insert(i, i);
+        }
+        for (int i = 0; i < size; ++i)
+        {
+            EXPECT_TRUE(hm.update(i, value_doubler()));
+        }
+        EXPECT_TRUE(hm.erase(0));
+        EXPECT_FALSE(hm.update(0, value_doubler()));
+        EXPECT_FALSE(hm.update(size, value_doubler()));
+
+        EXPECT_EQ(static_cast<size_type>(size - 1), hm.size());
+        for (int i = 1; i < size; ++i)
+        {
+            EXPECT_TRUE(hm.find(i, val));
+            EXPECT_EQ(mapped_type(i * 2), val);
+        }
+    }
+
+    static void testFetchAdd()
+    {
+        map_type hm;
+
+        // the missing key is inserted
+        hm.fetch_add(1, 5);
+        EXPECT_EQ(static_cast<size_type>(1), hm.size());
+        EXPECT_EQ(mapped_type(5), hm.find(1));
+
+        EXPECT_EQ(mapped_type(5), hm.fetch_add(1, 3));
+        EXPECT_EQ(mapped_type(8), hm.fetch_add(1, -8));
+        EXPECT_EQ(mapped_type(0), hm.find(1));
+
+        EXPECT_TRUE(hm.erase(1));
+        hm.fetch_add(1, 2);
+        EXPECT_EQ(mapped_type(2), hm.find(1));
+        EXPECT_EQ(static_cast<size_type>(1), hm.size());
+    }
+
+    static void testFindOrInsert()
+    {
+        map_type hm;
+        mapped_type val = mapped_type(1);
+
+        EXPECT_TRUE(hm.find_or_insert(1, val));
+        EXPECT_EQ(mapped_type(1), val);
+
+        // the old value remains and is returned
+        val = mapped_type(2);
+        EXPECT_FALSE(hm.find_or_insert(1, val));
+        EXPECT_EQ(mapped_type(1), val);
+        EXPECT_EQ(mapped_type(1), hm.find(1));
+
+        EXPECT_TRUE(hm.erase(1));
+        val = mapped_type(3);
+        EXPECT_TRUE(hm.find_or_insert(1, val));
+        EXPECT_EQ(mapped_type(3), hm.find(1));
+        EXPECT_EQ(static_cast<size_type>(1), hm.size());
+    }
+
+    struct fetch_add_thread
+    {
+        static const int KEYS = 64;
+        static const int COUNT = KEYS * 300;
+
+        map_type* m_map;
+
+        static void* run(void* param)
+        {
+            fetch_add_thread* self = static_cast<fetch_add_thread*>(param);
+            for (int i = 0; i < COUNT; ++i)
+            {
+                self->m_map->fetch_add(i % KEYS, mapped_type(1));
+            }
+            return nullptr;
+        }
+    };
+
+    static void testFetchAddMultithread()
+    {
+        static const int THREADS = 4;
+
+        map_type hm;
+        fetch_add_thread params[THREADS];
+        pthread_t threads[THREADS];
+
+        // the keys are inserted and updated concurrently, no increment is lost
+        for (int i = 0; i < THREADS; ++i)
+        {
+            params[i].m_map = &hm;
+            pthread_create(threads + i, nullptr, &fetch_add_thread::run,
+                    params + i);
+        }
+        for (int i = 0; i < THREADS; ++i)
+        {
+            pthread_join(threads[i], nullptr);
+        }
+        EXPECT_EQ(static_cast<size_type>(fetch_add_thread::KEYS), hm.size());
+        for (int i = 0; i < fetch_add_thread::KEYS; ++i)
+        {
+            EXPECT_EQ(mapped_type(THREADS * fetch_add_thread::COUNT
+                    / fetch_add_thread::KEYS), hm.find(i));
+        }
+    }
+
     static void testSnapshotEmpty()
     {
         snapshot_type snapshot;
@@ -581,13 +962,41 @@ struct make_map_uniform_tests
             MapType> greedy_test_type;
     typedef unform_hash_map_tester<Key, Value, xtomic::memory_model::wise,
             MapType> wise_test_type;
+    typedef unform_hash_map_tester<Key, Value, xtomic::memory_model::greedy,
+            MapType, xtomic::rehashing::incremental> incremental_greedy_test_type;
+    typedef unform_hash_map_tester<Key, Value, xtomic::memory_model::wise,
+            MapType, xtomic::rehashing::incremental> incremental_wise_test_type;
+    typedef unform_hash_map_tester<Key, Value, xtomic::memory_model::greedy,
+            MapType, xtomic::rehashing::stop_the_world,
+            xtomic::indexing::power_of_two> pow2_greedy_test_type;
+    typedef unform_hash_map_tester<Key, Value, xtomic::memory_model::wise,
+            MapType, xtomic::rehashing::incremental,
+            xtomic::indexing::power_of_two> pow2_incremental_wise_test_type;
+    typedef unform_hash_map_tester<Key, Value, xtomic::memory_model::greedy,
+            MapType, xtomic::rehashing::stop_the_world,
+            xtomic::indexing::control_bytes> ctrl_greedy_test_type;
+    typedef unform_hash_map_tester<Key, Value, xtomic::memory_model::wise,
+            MapType, xtomic::rehashing::incremental,
+            xtomic::indexing::control_bytes> ctrl_incremental_wise_test_type;
 };
 
 #define MAKE_MAP_UNIT_TEST(test_maker, suite, testFunc) \
         TEST(GreedyHashMap_##suite, testFunc) \
         { test_maker::greedy_test_type::test##testFunc(); } \
         TEST(WiseHashMap_##suite, testFunc) \
-        { test_maker::wise_test_type::test##testFunc(); }
+        { test_maker::wise_test_type::test##testFunc(); } \
+        TEST(IncrementalGreedyHashMap_##suite, testFunc) \
+        { test_maker::incremental_greedy_test_type::test##testFunc(); } \
+        TEST(IncrementalWiseHashMap_##suite, testFunc) \
+        { test_maker::incremental_wise_test_type::test##testFunc(); } \
+        TEST(PowerOfTwoGreedyHashMap_##suite, testFunc) \
+        { test_maker::pow2_greedy_test_type::test##testFunc(); } \
+        TEST(PowerOfTwoIncrementalWiseHashMap_##suite, testFunc) \
+        { test_maker::pow2_incremental_wise_test_type::test##testFunc(); } \
+        TEST(ControlBytesGreedyHashMap_##suite, testFunc) \
+        { test_maker::ctrl_greedy_test_type::test##testFunc(); } \
+        TEST(ControlBytesIncrementalWiseHashMap_##suite, testFunc) \
+        { test_maker::ctrl_incremental_wise_test_type::test##testFunc(); }
 
 #define MAKE_ALL_TESTS_FOR_MAP2(test_maker, suite) \
         MAKE_MAP_UNIT_TEST(test_maker, suite, TypeTraits)
@@ -602,10 +1011,21 @@ struct make_map_uniform_tests
         MAKE_MAP_UNIT_TEST(test_maker, suite, Collision) \
         MAKE_MAP_UNIT_TEST(test_maker, suite, ReuseKey) \
         MAKE_MAP_UNIT_TEST(test_maker, suite, Rehash) \
+        MAKE_MAP_UNIT_TEST(test_maker, suite, GrowAndErase) \
+        MAKE_MAP_UNIT_TEST(test_maker, suite, Churn) \
+        MAKE_MAP_UNIT_TEST(test_maker, suite, Shrink) \
+        MAKE_MAP_UNIT_TEST(test_maker, suite, ShrinkToFit) \
         MAKE_MAP_UNIT_TEST(test_maker, suite, Random) \
         MAKE_MAP_UNIT_TEST(test_maker, suite, DataTypes) \
+        MAKE_MAP_UNIT_TEST(test_maker, suite, FindBatch) \
+        MAKE_MAP_UNIT_TEST(test_maker, suite, InsertRange) \
+        MAKE_MAP_UNIT_TEST(test_maker, suite, BulkLoad) \
+        MAKE_MAP_UNIT_TEST(test_maker, suite, Update) \
+        MAKE_MAP_UNIT_TEST(test_maker, suite, FetchAdd) \
+        MAKE_MAP_UNIT_TEST(test_maker, suite, FindOrInsert) \
         MAKE_MAP_UNIT_TEST(test_maker, suite, SnapshotEmpty) \
         MAKE_MAP_UNIT_TEST(test_maker, suite, Snapshot) \
-        MAKE_MAP_UNIT_TEST(test_maker, suite, Multithread)
+        MAKE_MAP_UNIT_TEST(test_maker, suite, Multithread) \
+        MAKE_MAP_UNIT_TEST(test_maker, suite, FetchAddMultithread)
 
 #endif /* TESTS_UNITS_UNIFORM_HASH_MAP_TEST_HPP_ */
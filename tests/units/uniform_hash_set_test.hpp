@@ -17,23 +17,33 @@
 
 #include <ctime>
 #include <cstdlib>
+#include <vector>
 
-template<typename Key, typename Hash, xtomic::memory_model::type model>
-struct make_hash_set_table;
+template<typename Key, typename Hash, xtomic::memory_model::type model,
+        xtomic::rehashing::type rehashing, xtomic::indexing::type indexing>
+struct make_hash_set_table
+{
+    typedef xtomic::hash_set<Key, Hash, std::equal_to<Key>, std::allocator<Key>,
+            model, rehashing, indexing> type;
+};
 
 template<typename Key, typename Hash>
-struct make_hash_set_table<Key, Hash, xtomic::memory_model::wise>
+struct make_hash_set_table<Key, Hash, xtomic::memory_model::wise,
+        xtomic::rehashing::stop_the_world, xtomic::indexing::modulo>
 {
     typedef typename xtomic::make_wise_hash_set<Key, Hash>::type type;
 };
 
 template<typename Key, typename Hash>
-struct make_hash_set_table<Key, Hash, xtomic::memory_model::greedy>
+struct make_hash_set_table<Key, Hash, xtomic::memory_model::greedy,
+        xtomic::rehashing::stop_the_world, xtomic::indexing::modulo>
 {
     typedef typename xtomic::make_greedy_hash_set<Key, Hash>::type type;
 };
 
-template<typename Key, xtomic::memory_model::type model, bool IsIntegral>
+template<typename Key, xtomic::memory_model::type model, bool IsIntegral,
+        xtomic::rehashing::type rehashing = xtomic::rehashing::stop_the_world,
+        xtomic::indexing::type indexing = xtomic::indexing::modulo>
 struct unform_hash_set_tester
 {
     static constexpr int MapSize = static_cast<int>(1e5);
@@ -41,7 +51,8 @@ struct unform_hash_set_tester
 
     typedef Key key_type;
     typedef typename xtomic::my::make_hash<Key>::type hash_type;
-    typedef typename make_hash_set_table<key_type, hash_type, model>::type set_type;
+    typedef typename make_hash_set_table<key_type, hash_type, model,
+            rehashing, indexing>::type set_type;
     typedef typename set_type::size_type size_type;
     typedef typename set_type::snapshot_type snapshot_type;
     typedef xtomic::testing::set_insert_erase<set_type, MapSize, NumRepetitions> mt_test_type;
@@ -65,6 +76,10 @@ struct unform_hash_set_tester
 
         const xtomic::memory_model::type memoryModel = MEMORY_MODEL;
         EXPECT_EQ(model, memoryModel);
+        const xtomic::rehashing::type setRehashing = set_type::REHASHING;
+        EXPECT_EQ(rehashing, setRehashing);
+        const xtomic::indexing::type setIndexing = set_type::INDEXING;
+        EXPECT_EQ(indexing, setIndexing);
     }
 
     static void testEmpty()
@@ -305,6 +320,126 @@ struct unform_hash_set_tester
         }
     }
 
+    static void testGrowAndErase()
+    {
+        set_type hm;
+
+        const int size = 20000;
+
+        // the first half of keys is erased while the table grows
+        for (int i = 1; i <= size; ++i)
+        {
+            EXPECT_TRUE(hm.insert(i));
+            if (i % 2 == 0)
+            {
+                EXPECT_TRUE(hm.erase(i / 2));
+                EXPECT_FALSE(hm.find(i / 2));
+            }
+            EXPECT_TRUE(hm.find(i));
+        }
+
+        EXPECT_EQ(static_cast<size_type>(size / 2), hm.size());
+
+        for (int i = 1; i <= size; ++i)
+        {
+            EXPECT_EQ(i > size / 2, hm.find(i));
+        }
+
+        snapshot_type snapshot;
+        hm.getSnapshot(snapshot);
+        EXPECT_EQ(static_cast<std::size_t>(size / 2), snapshot.size());
+    }
+
+    static void testChurn()
+    {
+        set_type hm;
+
+        const int size = 20000;
+        const int live = 100;
+
+        // distinct keys are inserted and erased, the number of items is constant
+        for (int i = 1; i <= size; ++i)
+        {
+            EXPECT_TRUE(hm.insert(i));
+            if (i > live)
+            {
+                EXPECT_TRUE(hm.erase(i - live));
+            }
+        }
+
+        EXPECT_EQ(static_cast<size_type>(live), hm.size());
+        // tombstones are dropped instead of growing the table
+        EXPECT_GT(static_cast<size_type>(live * 8), hm.getCapacity());
+
+        for (int i = 1; i <= size; ++i)
+        {
+            EXPECT_EQ(i > size - live, hm.find(i));
+        }
+    }
+
+    static void testShrink()
+    {
+        set_type hm;
+
+        const int size = 20000;
+        const int live = 100;
+
+        for (int i = 1; i <= size; ++i)
+        {
+            EXPECT_TRUE(hm.insert(i));
+        }
+        const size_type capacity = hm.getCapacity();
+
+        // erase operation shrinks the table
+        for (int i = live + 1; i <= size; ++i)
+        {
+            EXPECT_TRUE(hm.erase(i));
+        }
+
+        EXPECT_EQ(static_cast<size_type>(live), hm.size());
+        EXPECT_GT(capacity / 8, hm.getCapacity());
+
+        for (int i = 1; i <= size; ++i)
+        {
+            EXPECT_EQ(i <= live, hm.find(i));
+        }
+    }
+
+    static void testShrinkToFit()
+    {
+        set_type hm(1000);
+
+        const int size = 20000;
+        const int live = 100;
+
+        hm.setLowWatermark(0);
+        EXPECT_EQ(0U, hm.getLowWatermark());
+
+        for (int i = 1; i <= size; ++i)
+        {
+            EXPECT_TRUE(hm.insert(i));
+        }
+        const size_type capacity = hm.getCapacity();
+
+        for (int i = live + 1; i <= size; ++i)
+        {
+            EXPECT_TRUE(hm.erase(i));
+        }
+        EXPECT_EQ(capacity, hm.getCapacity());
+
+        hm.shrink_to_fit();
+
+        EXPECT_EQ(static_cast<size_type>(live), hm.size());
+        EXPECT_GT(capacity / 8, hm.getCapacity());
+        // the initial capacity is kept
+        EXPECT_LE(static_cast<size_type>(1000), hm.getCapacity());
+
+        for (int i = 1; i <= size; ++i)
+        {
+            EXPECT_EQ(i <= live, hm.find(i));
+        }
+    }
+
     static void testRandom()
     {
         srand(time(nullptr));
@@ -382,6 +517,38 @@ struct unform_hash_set_tester
         compile_tester<int64_t>()();
     }
 
+    static void testFindBatch()
+    {
+        set_type hm;
+
+        const int size = static_cast<int>(hm.getCapacity()) * 2 + 1;
+        for (int i = 0; i < size; ++i)
+        {
+            hm.insert(i);
+        }
+
+        // present and missing keys take turns, the batch spans several words of the mask
+        std::vector<key_type> keys;
+        for (int i = 0; i < size * 2; ++i)
+        {
+            keys.push_back(i % 2 ? i / 2 : size + i / 2);
+        }
+        std::vector<xtomic::uint64_t> mask((keys.size() + 63) / 64, ~0ULL);
+
+        const size_type found = hm.find_batch(&keys[0], keys.size(), &mask[0]);
+        EXPECT_EQ(static_cast<size_type>(size), found);
+
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            const bool bit = (mask[i / 64] >> (i % 64)) & 1;
+            EXPECT_EQ(i % 2 != 0, bit);
+        }
+        if (keys.size() % 64)
+        {
+            EXPECT_EQ(0ULL, mask.back() >> (keys.size() % 64));
+        }
+    }
+
     static void testSnapshotEmpty()
     {
         snapshot_type snapshot;
@@ -430,13 +597,29 @@ struct make_set_uniform_tests
 {
     typedef unform_hash_set_tester<Key, xtomic::memory_model::wise, integralKey> wise_test_type;
     typedef unform_hash_set_tester<Key, xtomic::memory_model::greedy, integralKey> greedy_test_type;
+    typedef unform_hash_set_tester<Key, xtomic::memory_model::wise, integralKey,
+            xtomic::rehashing::incremental> incremental_wise_test_type;
+    typedef unform_hash_set_tester<Key, xtomic::memory_model::greedy, integralKey,
+            xtomic::rehashing::incremental> incremental_greedy_test_type;
+    typedef unform_hash_set_tester<Key, xtomic::memory_model::greedy, integralKey,
+            xtomic::rehashing::stop_the_world, xtomic::indexing::power_of_two> pow2_greedy_test_type;
+    typedef unform_hash_set_tester<Key, xtomic::memory_model::wise, integralKey,
+            xtomic::rehashing::incremental, xtomic::indexing::power_of_two> pow2_incremental_wise_test_type;
 };
 
 #define MAKE_SET_UNIT_TEST(test_maker, suite, testFunc) \
         TEST(GreedyHashSet_##suite, testFunc) \
         { test_maker::greedy_test_type::test##testFunc(); } \
         TEST(WiseHashSet_##suite, testFunc) \
-        { test_maker::wise_test_type::test##testFunc(); }
+        { test_maker::wise_test_type::test##testFunc(); } \
+        TEST(IncrementalGreedyHashSet_##suite, testFunc) \
+        { test_maker::incremental_greedy_test_type::test##testFunc(); } \
+        TEST(IncrementalWiseHashSet_##suite, testFunc) \
+        { test_maker::incremental_wise_test_type::test##testFunc(); } \
+        TEST(PowerOfTwoGreedyHashSet_##suite, testFunc) \
+        { test_maker::pow2_greedy_test_type::test##testFunc(); } \
+        TEST(PowerOfTwoIncrementalWiseHashSet_##suite, testFunc) \
+        { test_maker::pow2_incremental_wise_test_type::test##testFunc(); }
 
 #define MAKE_ALL_TESTS_FOR_SET(key_type, suite) \
         MAKE_SET_UNIT_TEST(make_set_uniform_tests<key_type>, suite, TypeTraits) \
@@ -447,8 +630,13 @@ struct make_set_uniform_tests
         MAKE_SET_UNIT_TEST(make_set_uniform_tests<key_type>, suite, Collision) \
         MAKE_SET_UNIT_TEST(make_set_uniform_tests<key_type>, suite, ReuseKey) \
         MAKE_SET_UNIT_TEST(make_set_uniform_tests<key_type>, suite, Rehash) \
+        MAKE_SET_UNIT_TEST(make_set_uniform_tests<key_type>, suite, GrowAndErase) \
+        MAKE_SET_UNIT_TEST(make_set_uniform_tests<key_type>, suite, Churn) \
+        MAKE_SET_UNIT_TEST(make_set_uniform_tests<key_type>, suite, Shrink) \
+        MAKE_SET_UNIT_TEST(make_set_uniform_tests<key_type>, suite, ShrinkToFit) \
         MAKE_SET_UNIT_TEST(make_set_uniform_tests<key_type>, suite, Random) \
         MAKE_SET_UNIT_TEST(make_set_uniform_tests<key_type>, suite, DataTypes) \
+        MAKE_SET_UNIT_TEST(make_set_uniform_tests<key_type>, suite, FindBatch) \
         MAKE_SET_UNIT_TEST(make_set_uniform_tests<key_type>, suite, SnapshotEmpty) \
         MAKE_SET_UNIT_TEST(make_set_uniform_tests<key_type>, suite, Snapshot) \
         MAKE_SET_UNIT_TEST(make_set_uniform_tests<key_type>, suite, Multithread)
@@ -0,0 +1,224 @@
+/*
+ * work_stealing_deque.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: masha
+ */
+
+#include "gtest/gtest.h"
+
+#include <xtomic/work_stealing_deque.hpp>
+
+#include <string>
+#include <pthread.h>
+
+namespace
+{
+
+template<typename Deque, int Size, int Thieves>
+class deque_owner2thieves
+{
+public:
+    typedef deque_owner2thieves<Deque, Size, Thieves> this_type;
+
+    deque_owner2thieves(Deque& d) :
+            m_deque(d),
+            m_counts(new xtomic::quantum<int>[Size]),
+            m_finish(false)
+    {
+    }
+    ~deque_owner2thieves()
+    {
+        delete[] m_counts;
+    }
+
+    void run()
+    {
+        pthread_t thieves[Thieves];
+        for (int i = 0; i < Thieves; ++i)
+        {
+            pthread_create(&thieves[i], 0, &thief, this);
+        }
+        owner();
+        m_finish = true;
+        for (int i = 0; i < Thieves; ++i)
+        {
+            pthread_join(thieves[i], 0);
+        }
+    }
+
+    bool isDataComplete() const
+    {
+        for (int i = 0; i < Size; ++i)
+        {
+            if (m_counts[i].load(xtomic::barriers::relaxed) != 1)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    void consume(int val)
+    {
+        m_counts[val].fetch_add(1, xtomic::barriers::relaxed);
+    }
+    void owner()
+    {
+        int val = 0;
+        for (int i = 0; i < Size; ++i)
+        {
+            while (!m_deque.push(i))
+            {
+                if (m_deque.pop(val))
+                {
+                    consume(val);
+                }
+            }
+            // the owner takes every third item back
+            if (i % 3 == 0 && m_deque.pop(val))
+            {
+                consume(val);
+            }
+        }
+        while (m_deque.pop(val))
+        {
+            consume(val);
+        }
+    }
+    static void* thief(void* arg)
+    {
+        this_type* pThis = reinterpret_cast<this_type*>(arg);
+        int val = 0;
+        while (!pThis->m_finish)
+        {
+            if (pThis->m_deque.steal(val))
+            {
+                pThis->consume(val);
+            }
+        }
+        return 0;
+    }
+private:
+    Deque& m_deque;
+    xtomic::quantum<int>* m_counts;
+    volatile bool m_finish;
+};
+
+}
+
+TEST(WorkStealingDeque, owner)
+{
+    int val = 0;
+    xtomic::work_stealing_deque<int> d(3);
+
+    EXPECT_TRUE(d.fixed_size);
+    EXPECT_EQ(d.getCapacity(), 3);
+    EXPECT_FALSE(d.pop(val));
+
+    EXPECT_TRUE(d.push(1));
+    EXPECT_TRUE(d.push(2));
+    EXPECT_TRUE(d.push(3));
+    EXPECT_FALSE(d.push(4));
+    EXPECT_EQ(d.size(), 3);
+
+    // the owner's end is LIFO
+    EXPECT_TRUE(d.pop(val));
+    EXPECT_EQ(val, 3);
+    EXPECT_TRUE(d.pop(val));
+    EXPECT_EQ(val, 2);
+    EXPECT_TRUE(d.pop(val));
+    EXPECT_EQ(val, 1);
+    EXPECT_FALSE(d.pop(val));
+    EXPECT_EQ(d.size(), 0);
+}
+
+TEST(WorkStealingDeque, steal)
+{
+    int val = 0;
+    xtomic::work_stealing_deque<int> d(3);
+
+    EXPECT_FALSE(d.steal(val));
+
+    EXPECT_TRUE(d.push(1));
+    EXPECT_TRUE(d.push(2));
+    EXPECT_TRUE(d.push(3));
+
+    // thieves' end is FIFO
+    EXPECT_TRUE(d.steal(val));
+    EXPECT_EQ(val, 1);
+    EXPECT_TRUE(d.pop(val));
+    EXPECT_EQ(val, 3);
+    EXPECT_TRUE(d.steal(val));
+    EXPECT_EQ(val, 2);
+    EXPECT_FALSE(d.steal(val));
+    EXPECT_FALSE(d.pop(val));
+
+    // stolen nodes are back in the buffer
+    EXPECT_TRUE(d.push(4));
+    EXPECT_TRUE(d.push(5));
+    EXPECT_TRUE(d.push(6));
+    EXPECT_EQ(d.size(), 3);
+}
+
+TEST(WorkStealingDeque, grow)
+{
+    std::string val;
+    xtomic::work_stealing_deque<std::string, false> d(0);
+
+    EXPECT_FALSE(d.fixed_size);
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_TRUE(d.push(std::string(1, static_cast<char>('0' + i % 10))));
+        // let thieves move the top so the array wraps around
+        if (i % 4 == 0)
+        {
+            EXPECT_TRUE(d.steal(val));
+        }
+    }
+    EXPECT_EQ(d.size(), 75);
+    for (int i = 99; d.size() > 1; --i)
+    {
+        EXPECT_TRUE(d.pop(val));
+        EXPECT_EQ(val, std::string(1, static_cast<char>('0' + i % 10)));
+    }
+    EXPECT_TRUE(d.steal(val));
+    EXPECT_FALSE(d.pop(val));
+}
+
+TEST(MT_WorkStealingDeque, fixedSize_owner_manyThieves)
+{
+    enum
+    {
+        Size = 1000000,
+        Capacity = 100,
+    };
+    typedef xtomic::work_stealing_deque<int> deque_type;
+
+    deque_type d(Capacity);
+    deque_owner2thieves<deque_type, Size, 3> test(d);
+
+    test.run();
+
+    EXPECT_TRUE(test.isDataComplete());
+    EXPECT_EQ(d.size(), 0);
+}
+
+TEST(MT_WorkStealingDeque, dynamicSize_owner_manyThieves)
+{
+    enum
+    {
+        Size = 1000000,
+        Capacity = 16,
+    };
+    typedef xtomic::work_stealing_deque<int, false> deque_type;
+
+    deque_type d(Capacity);
+    deque_owner2thieves<deque_type, Size, 3> test(d);
+
+    test.run();
+
+    EXPECT_TRUE(test.isDataComplete());
+    EXPECT_EQ(d.size(), 0);
+}